@@ -33,9 +33,13 @@ public:
 struct GeneratorAttributes {
     msdfgen::MSDFGeneratorConfig config;
     bool scanlinePass = false;
+    /// Skips generation of the one pixel wide border of each glyph box, only valid if it lies outside of the glyph's distance range
+    bool skipBoxBorder = false;
+    /// Generates the glyphs into a mipmap level of the atlas (0 = full resolution), whose dimensions and glyph scale are halved with each level
+    int mipLevel = 0;
 };
 
-/// A function that generates the bitmap for a single glyph
+/// A function that generates the bitmap for a single glyph (its box, without the border if skipBoxBorder is set)
 template <typename T, int N>
 using GeneratorFunction = void (*)(const msdfgen::BitmapRef<T, N> &, const GlyphGeometry &, const GeneratorAttributes &);
 
@@ -1,17 +1,19 @@
 
 #pragma once
 
+#include "types.h"
 #include "AtlasStorage.h"
 
 namespace msdf_atlas {
 
-/// An implementation of AtlasStorage represented by a bitmap in memory (msdfgen::Bitmap)
+/// An implementation of AtlasStorage represented by a bitmap in memory (msdfgen::Bitmap), whose rows may be stored bottom-up (default) or top-down
 template <typename T, int N>
 class BitmapAtlasStorage {
 
 public:
     BitmapAtlasStorage();
     BitmapAtlasStorage(int width, int height);
+    BitmapAtlasStorage(int width, int height, YDirection yDirection);
     explicit BitmapAtlasStorage(const msdfgen::BitmapConstRef<T, N> &bitmap);
     explicit BitmapAtlasStorage(msdfgen::Bitmap<T, N> &&bitmap);
     BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height);
@@ -22,9 +24,12 @@ public:
     template <typename S>
     void put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap);
     void get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const;
+    /// Returns the order in which the rows of the bitmap are stored in memory
+    YDirection getYDirection() const;
 
 private:
     msdfgen::Bitmap<T, N> bitmap;
+    YDirection yDirection;
 
 };
 
@@ -8,31 +8,43 @@
 namespace msdf_atlas {
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage() { }
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage() : yDirection(YDirection::BOTTOM_UP) { }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height) : bitmap(width, height) {
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height) : bitmap(width, height), yDirection(YDirection::BOTTOM_UP) {
     memset((T *) bitmap, 0, sizeof(T)*N*width*height);
 }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const msdfgen::BitmapConstRef<T, N> &bitmap) : bitmap(bitmap) { }
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(int width, int height, YDirection yDirection) : bitmap(width, height), yDirection(yDirection) {
+    memset((T *) bitmap, 0, sizeof(T)*N*width*height);
+}
+
+template <typename T, int N>
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const msdfgen::BitmapConstRef<T, N> &bitmap) : bitmap(bitmap), yDirection(YDirection::BOTTOM_UP) { }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(msdfgen::Bitmap<T, N> &&bitmap) : bitmap((msdfgen::Bitmap<T, N> &&) bitmap) { }
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(msdfgen::Bitmap<T, N> &&bitmap) : bitmap((msdfgen::Bitmap<T, N> &&) bitmap), yDirection(YDirection::BOTTOM_UP) { }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height) : bitmap(width, height) {
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height) : bitmap(width, height), yDirection(orig.yDirection) {
     memset((T *) bitmap, 0, sizeof(T)*N*width*height);
-    blit(bitmap, orig.bitmap, 0, 0, 0, 0, std::min(width, orig.bitmap.width()), std::min(height, orig.bitmap.height()));
+    int w = std::min(width, orig.bitmap.width()), h = std::min(height, orig.bitmap.height());
+    if (yDirection == YDirection::TOP_DOWN)
+        blit(bitmap, orig.bitmap, 0, height-h, 0, orig.bitmap.height()-h, w, h);
+    else
+        blit(bitmap, orig.bitmap, 0, 0, 0, 0, w, h);
 }
 
 template <typename T, int N>
-BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count) : bitmap(width, height) {
+BitmapAtlasStorage<T, N>::BitmapAtlasStorage(const BitmapAtlasStorage<T, N> &orig, int width, int height, const Remap *remapping, int count) : bitmap(width, height), yDirection(orig.yDirection) {
     memset((T *) bitmap, 0, sizeof(T)*N*width*height);
     for (int i = 0; i < count; ++i) {
         const Remap &remap = remapping[i];
-        blit(bitmap, orig.bitmap, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
+        if (yDirection == YDirection::TOP_DOWN)
+            blit(bitmap, orig.bitmap, remap.target.x, height-remap.target.y-remap.height, remap.source.x, orig.bitmap.height()-remap.source.y-remap.height, remap.width, remap.height);
+        else
+            blit(bitmap, orig.bitmap, remap.target.x, remap.target.y, remap.source.x, remap.source.y, remap.width, remap.height);
     }
 }
 
@@ -54,12 +66,23 @@ BitmapAtlasStorage<T, N>::operator msdfgen::Bitmap<T, N>() && {
 template <typename T, int N>
 template <typename S>
 void BitmapAtlasStorage<T, N>::put(int x, int y, const msdfgen::BitmapConstRef<S, N> &subBitmap) {
-    blit(bitmap, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
+    if (yDirection == YDirection::TOP_DOWN)
+        blitFlippedY(bitmap, subBitmap, x, bitmap.height()-y-subBitmap.height, 0, 0, subBitmap.width, subBitmap.height);
+    else
+        blit(bitmap, subBitmap, x, y, 0, 0, subBitmap.width, subBitmap.height);
 }
 
 template <typename T, int N>
 void BitmapAtlasStorage<T, N>::get(int x, int y, const msdfgen::BitmapRef<T, N> &subBitmap) const {
-    blit(subBitmap, bitmap, 0, 0, x, y, subBitmap.width, subBitmap.height);
+    if (yDirection == YDirection::TOP_DOWN)
+        blitFlippedY(subBitmap, bitmap, 0, 0, x, bitmap.height()-y-subBitmap.height, subBitmap.width, subBitmap.height);
+    else
+        blit(subBitmap, bitmap, 0, 0, x, y, subBitmap.width, subBitmap.height);
+}
+
+template <typename T, int N>
+YDirection BitmapAtlasStorage<T, N>::getYDirection() const {
+    return yDirection;
 }
 
 }
@@ -0,0 +1,133 @@
+
+#include "BufferedFileWriter.h"
+
+#include <cstdint>
+#include <cstring>
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
+namespace msdf_atlas {
+
+BufferedFileWriter::BufferedFileWriter(size_t bufferSize) : file(nullptr), buffer(bufferSize > 0 ? bufferSize : 1), position(0), failed(false) { }
+
+BufferedFileWriter::~BufferedFileWriter() {
+    close();
+}
+
+bool BufferedFileWriter::open(const char *filename, bool text) {
+    close();
+    file = fopen(filename, text ? "w" : "wb");
+    position = 0;
+    failed = false;
+    return file != nullptr;
+}
+
+bool BufferedFileWriter::close() {
+    if (!file)
+        return false;
+    flush();
+    failed |= fclose(file) != 0;
+    file = nullptr;
+    return !failed;
+}
+
+bool BufferedFileWriter::flush() {
+    if (position) {
+        failed |= !file || fwrite(buffer.data(), 1, position, file) != position;
+        position = 0;
+    }
+    return !failed;
+}
+
+void BufferedFileWriter::write(const void *data, size_t size) {
+    if (position+size > buffer.size()) {
+        flush();
+        // Large blocks bypass the buffer
+        if (size >= buffer.size()) {
+            failed |= !file || fwrite(data, 1, size, file) != size;
+            return;
+        }
+    }
+    memcpy(buffer.data()+position, data, size);
+    position += size;
+}
+
+void BufferedFileWriter::write(const char *str) {
+    write(str, strlen(str));
+}
+
+static void byteSwap16(char *dst, const char *src, size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i+8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src+2*i));
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst+2*i), v);
+    }
+#endif
+    for (; i < count; ++i) {
+        dst[2*i] = src[2*i+1];
+        dst[2*i+1] = src[2*i];
+    }
+}
+
+static void byteSwap32(char *dst, const char *src, size_t count) {
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i+4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src+4*i));
+        // Swap bytes within 16-bit lanes, then swap the 16-bit halves of each 32-bit word
+        v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xb1), 0xb1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst+4*i), v);
+    }
+#endif
+    for (; i < count; ++i) {
+        uint32_t word;
+        memcpy(&word, src+4*i, 4);
+        word = word>>24|(word>>8&0xff00u)|(word<<8&0xff0000u)|word<<24;
+        memcpy(dst+4*i, &word, 4);
+    }
+}
+
+void BufferedFileWriter::writeByteSwapped16(const void *data, size_t count) {
+    const char *src = reinterpret_cast<const char *>(data);
+    size_t chunkLength = buffer.size()/2;
+    while (count) {
+        size_t length = count < chunkLength ? count : chunkLength;
+        char *dst = reserve(2*length);
+        byteSwap16(dst, src, length);
+        commit(dst+2*length);
+        src += 2*length;
+        count -= length;
+    }
+}
+
+void BufferedFileWriter::writeByteSwapped32(const void *data, size_t count) {
+    const char *src = reinterpret_cast<const char *>(data);
+    size_t chunkLength = buffer.size()/4;
+    while (count) {
+        size_t length = count < chunkLength ? count : chunkLength;
+        char *dst = reserve(4*length);
+        byteSwap32(dst, src, length);
+        commit(dst+4*length);
+        src += 4*length;
+        count -= length;
+    }
+}
+
+char *BufferedFileWriter::reserve(size_t maxSize) {
+    if (position+maxSize > buffer.size()) {
+        flush();
+        if (maxSize > buffer.size())
+            buffer.resize(maxSize);
+    }
+    return buffer.data()+position;
+}
+
+void BufferedFileWriter::commit(const char *end) {
+    position = end-buffer.data();
+}
+
+}
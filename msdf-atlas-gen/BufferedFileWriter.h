@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+namespace msdf_atlas {
+
+/// Writes a file through a large memory buffer, so that output consisting of many small pieces translates into few large writes
+class BufferedFileWriter {
+
+public:
+    /// Default size of the buffer in bytes
+    static const size_t DEFAULT_BUFFER_SIZE = 0x100000;
+
+    explicit BufferedFileWriter(size_t bufferSize = DEFAULT_BUFFER_SIZE);
+    ~BufferedFileWriter();
+    /// Opens (creates or truncates) the file for binary output, or text output with the platform's line endings, returns false on failure
+    bool open(const char *filename, bool text = false);
+    /// Flushes the buffer and closes the file, returns false if any write since opening failed
+    bool close();
+    /// Writes the contents of the buffer to the file
+    bool flush();
+    /// Appends a sequence of bytes
+    void write(const void *data, size_t size);
+    /// Appends a null-terminated string
+    void write(const char *str);
+    /// Appends a sequence of 16-bit words with reversed byte order
+    void writeByteSwapped16(const void *data, size_t count);
+    /// Appends a sequence of 32-bit words (e.g. floats) with reversed byte order
+    void writeByteSwapped32(const void *data, size_t count);
+    /// Returns a pointer to at least maxSize bytes of contiguous buffer space, which must be followed by a call to commit
+    char *reserve(size_t maxSize);
+    /// Finishes a write into the reserved space, end points past the last written byte
+    void commit(const char *end);
+
+private:
+    FILE *file;
+    std::vector<char> buffer;
+    size_t position;
+    bool failed;
+
+    BufferedFileWriter(const BufferedFileWriter &);
+    BufferedFileWriter &operator=(const BufferedFileWriter &);
+
+};
+
+}
@@ -1,39 +1,143 @@
 
 #include "Charset.h"
 
+#include <algorithm>
+
 namespace msdf_atlas {
 
 static Charset createAsciiCharset() {
     Charset ascii;
-    for (unicode_t cp = 0x20; cp < 0x7f; ++cp)
-        ascii.add(cp);
+    ascii.add(0x20, 0x7e);
     return ascii;
 }
 
 const Charset Charset::ASCII = createAsciiCharset();
 
 void Charset::add(unicode_t cp) {
-    codepoints.insert(cp);
+    add(cp, cp);
+}
+
+void Charset::add(unicode_t first, unicode_t last) {
+    if (first > last)
+        return;
+    // Fast path for ascending insertion
+    if (ranges.empty() || first > ranges.back().second) {
+        if (!ranges.empty() && first == ranges.back().second+1)
+            ranges.back().second = last;
+        else
+            ranges.push_back(Range(first, last));
+        return;
+    }
+    // Ranges overlapping or adjacent to [first, last] are merged into the first of them
+    std::vector<Range>::iterator lo = std::lower_bound(ranges.begin(), ranges.end(), first, [](const Range &range, unicode_t first) {
+        return range.second < first && range.second+1 < first;
+    });
+    std::vector<Range>::iterator hi = std::upper_bound(lo, ranges.end(), last, [](unicode_t last, const Range &range) {
+        return last < range.first && last+1 < range.first;
+    });
+    if (lo == hi) {
+        ranges.insert(lo, Range(first, last));
+        return;
+    }
+    lo->first = std::min(lo->first, first);
+    lo->second = std::max((hi-1)->second, last);
+    ranges.erase(lo+1, hi);
+}
+
+void Charset::add(const Charset &charset) {
+    if (charset.ranges.empty())
+        return;
+    std::vector<Range> merged;
+    merged.reserve(ranges.size()+charset.ranges.size());
+    std::vector<Range>::const_iterator a = ranges.begin(), aEnd = ranges.end();
+    std::vector<Range>::const_iterator b = charset.ranges.begin(), bEnd = charset.ranges.end();
+    while (a != aEnd || b != bEnd) {
+        const Range &next = b == bEnd || (a != aEnd && a->first < b->first) ? *a++ : *b++;
+        if (!merged.empty() && (next.first <= merged.back().second || next.first-1 == merged.back().second))
+            merged.back().second = std::max(merged.back().second, next.second);
+        else
+            merged.push_back(next);
+    }
+    ranges.swap(merged);
 }
 
 void Charset::remove(unicode_t cp) {
-    codepoints.erase(cp);
+    remove(cp, cp);
+}
+
+void Charset::remove(unicode_t first, unicode_t last) {
+    if (first > last)
+        return;
+    std::vector<Range>::iterator lo = std::lower_bound(ranges.begin(), ranges.end(), first, [](const Range &range, unicode_t first) {
+        return range.second < first;
+    });
+    std::vector<Range>::iterator hi = std::upper_bound(lo, ranges.end(), last, [](unicode_t last, const Range &range) {
+        return last < range.first;
+    });
+    if (lo == hi)
+        return;
+    // Parts of the boundary ranges that stick out of [first, last] are kept
+    Range remainder[2];
+    int remainderCount = 0;
+    if (lo->first < first)
+        remainder[remainderCount++] = Range(lo->first, first-1);
+    if ((hi-1)->second > last)
+        remainder[remainderCount++] = Range(last+1, (hi-1)->second);
+    lo = ranges.erase(lo, hi);
+    ranges.insert(lo, remainder, remainder+remainderCount);
+}
+
+void Charset::remove(const Charset &charset) {
+    if (ranges.empty() || charset.ranges.empty())
+        return;
+    std::vector<Range> difference;
+    difference.reserve(ranges.size()+charset.ranges.size());
+    std::vector<Range>::const_iterator b = charset.ranges.begin(), bEnd = charset.ranges.end();
+    for (Range range : ranges) {
+        while (b != bEnd && b->second < range.first)
+            ++b;
+        std::vector<Range>::const_iterator cut = b;
+        for (; cut != bEnd && cut->first <= range.second; ++cut) {
+            if (cut->first > range.first)
+                difference.push_back(Range(range.first, cut->first-1));
+            if (cut->second >= range.second)
+                break;
+            range.first = cut->second+1;
+        }
+        if (cut == bEnd || cut->first > range.second)
+            difference.push_back(range);
+    }
+    ranges.swap(difference);
+}
+
+bool Charset::contains(unicode_t cp) const {
+    std::vector<Range>::const_iterator it = std::lower_bound(ranges.begin(), ranges.end(), cp, [](const Range &range, unicode_t cp) {
+        return range.second < cp;
+    });
+    return it != ranges.end() && it->first <= cp;
 }
 
 size_t Charset::size() const {
-    return codepoints.size();
+    size_t count = 0;
+    for (const Range &range : ranges)
+        count += size_t(range.second-range.first)+1;
+    return count;
 }
 
 bool Charset::empty() const {
-    return codepoints.empty();
+    return ranges.empty();
+}
+
+Charset::const_iterator Charset::begin() const {
+    return const_iterator(ranges.data(), ranges.data()+ranges.size());
 }
 
-std::set<unicode_t>::const_iterator Charset::begin() const {
-    return codepoints.begin();
+Charset::const_iterator Charset::end() const {
+    return const_iterator(ranges.data()+ranges.size(), ranges.data()+ranges.size());
 }
 
-std::set<unicode_t>::const_iterator Charset::end() const {
-    return codepoints.end();
+const std::vector<Charset::Range> &Charset::getRanges() const {
+    return ranges;
 }
 
 }
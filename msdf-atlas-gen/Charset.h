@@ -2,7 +2,9 @@
 #pragma once
 
 #include <cstdlib>
-#include <set>
+#include <iterator>
+#include <vector>
+#include <utility>
 #include "types.h"
 
 #ifndef MSDF_ATLAS_PUBLIC
@@ -11,30 +13,81 @@
 
 namespace msdf_atlas {
 
-/// Represents a set of Unicode codepoints (characters)
+/// Represents a set of Unicode codepoints (characters), stored as a sorted list of disjoint ranges
 class Charset {
 
 public:
+    /// Inclusive range of codepoints
+    typedef std::pair<unicode_t, unicode_t> Range;
+
+    /// Iterates over individual codepoints in ascending order
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef unicode_t value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const unicode_t *pointer;
+        typedef const unicode_t &reference;
+
+        inline const_iterator() : range(), rangesEnd(), cp() { }
+        inline const_iterator(const Range *range, const Range *rangesEnd) : range(range), rangesEnd(rangesEnd), cp(range < rangesEnd ? range->first : 0) { }
+        inline const unicode_t &operator*() const { return cp; }
+        inline const_iterator &operator++() {
+            if (cp == range->second)
+                cp = ++range < rangesEnd ? range->first : 0;
+            else
+                ++cp;
+            return *this;
+        }
+        inline const_iterator operator++(int) {
+            const_iterator prev(*this);
+            ++*this;
+            return prev;
+        }
+        inline bool operator==(const const_iterator &other) const { return range == other.range && cp == other.cp; }
+        inline bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+    private:
+        const Range *range, *rangesEnd;
+        unicode_t cp;
+    };
+
     /// The set of the 95 printable ASCII characters
     static MSDF_ATLAS_PUBLIC const Charset ASCII;
 
     /// Adds a codepoint
     void add(unicode_t cp);
+    /// Adds all codepoints in the inclusive range [first, last]
+    void add(unicode_t first, unicode_t last);
+    /// Adds all codepoints of another charset
+    void add(const Charset &charset);
     /// Removes a codepoint
     void remove(unicode_t cp);
+    /// Removes all codepoints in the inclusive range [first, last]
+    void remove(unicode_t first, unicode_t last);
+    /// Removes all codepoints of another charset
+    void remove(const Charset &charset);
+    /// Checks whether the codepoint is in the set
+    bool contains(unicode_t cp) const;
 
     size_t size() const;
     bool empty() const;
-    std::set<unicode_t>::const_iterator begin() const;
-    std::set<unicode_t>::const_iterator end() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    /// Returns the sorted list of disjoint, non-adjacent codepoint ranges
+    const std::vector<Range> &getRanges() const;
 
     /// Load character set from a text file with compliant syntax
     bool load(const char *filename, bool disableCharLiterals = false);
     /// Parse character set from a string with compliant syntax
     bool parse(const char *str, size_t strLength, bool disableCharLiterals = false);
+    /// Adds every character except control characters that occurs in a UTF-8 encoded text, which is split into chunks decoded in parallel
+    void addText(const char *utf8, size_t length, int threadCount = 1);
+    /// Adds every character except control characters that occurs in a UTF-8 encoded text file (e.g. a text corpus)
+    bool loadText(const char *filename, int threadCount = 1);
 
 private:
-    std::set<unicode_t> codepoints;
+    std::vector<Range> ranges;
 
 };
 
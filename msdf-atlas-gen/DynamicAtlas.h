@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "RectanglePacker.h"
+#include "ShelfPacker.h"
 #include "AtlasGenerator.h"
 
 namespace msdf_atlas {
@@ -11,8 +12,9 @@ namespace msdf_atlas {
  * This class can be used to produce a dynamic atlas to which more glyphs are added over time.
  * It takes care of laying out and enlarging the atlas as necessary and delegates the actual work
  * to the specified AtlasGenerator, which may e.g. do the work asynchronously.
+ * The Packer (RectanglePacker or ShelfPacker) determines how the glyph boxes are laid out.
  */
-template <class AtlasGenerator>
+template <class AtlasGenerator, class Packer = RectanglePacker>
 class DynamicAtlas {
 
 public:
@@ -40,7 +42,7 @@ private:
     int spacing;
     int glyphCount;
     int totalArea;
-    RectanglePacker packer;
+    Packer packer;
     AtlasGenerator generator;
     std::vector<Rectangle> rectangles;
     std::vector<Remap> remapBuffer;
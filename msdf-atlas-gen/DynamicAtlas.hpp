@@ -5,18 +5,18 @@
 
 namespace msdf_atlas {
 
-template <class AtlasGenerator>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas() : side(0), spacing(0), glyphCount(0), totalArea(0) { }
+template <class AtlasGenerator, class Packer>
+DynamicAtlas<AtlasGenerator, Packer>::DynamicAtlas() : side(0), spacing(0), glyphCount(0), totalArea(0) { }
 
-template <class AtlasGenerator>
+template <class AtlasGenerator, class Packer>
 template <typename... ARGS>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas(int minSide, ARGS... args) : side(minSide > 0 ? ceilToPOT(minSide) : 0), spacing(0), glyphCount(0), totalArea(0), packer(side+spacing, side+spacing), generator(side, side, args...) { }
+DynamicAtlas<AtlasGenerator, Packer>::DynamicAtlas(int minSide, ARGS... args) : side(minSide > 0 ? ceilToPOT(minSide) : 0), spacing(0), glyphCount(0), totalArea(0), packer(side+spacing, side+spacing), generator(side, side, args...) { }
 
-template <class AtlasGenerator>
-DynamicAtlas<AtlasGenerator>::DynamicAtlas(AtlasGenerator &&generator) : side(0), spacing(0), glyphCount(0), totalArea(0), generator((AtlasGenerator &&) generator) { }
+template <class AtlasGenerator, class Packer>
+DynamicAtlas<AtlasGenerator, Packer>::DynamicAtlas(AtlasGenerator &&generator) : side(0), spacing(0), glyphCount(0), totalArea(0), generator((AtlasGenerator &&) generator) { }
 
-template <class AtlasGenerator>
-typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>::add(GlyphGeometry *glyphs, int count, bool allowRearrange) {
+template <class AtlasGenerator, class Packer>
+typename DynamicAtlas<AtlasGenerator, Packer>::ChangeFlags DynamicAtlas<AtlasGenerator, Packer>::add(GlyphGeometry *glyphs, int count, bool allowRearrange) {
     ChangeFlags changeFlags = 0;
     int start = rectangles.size();
     for (int i = 0; i < count; ++i) {
@@ -41,7 +41,7 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>:
             while (side*side < totalArea)
                 side <<= 1;
             if (allowRearrange) {
-                packer = RectanglePacker(side+spacing, side+spacing);
+                packer = Packer(side+spacing, side+spacing);
                 packerStart = 0;
             } else {
                 packer.expand(side+spacing, side+spacing);
@@ -71,13 +71,13 @@ typename DynamicAtlas<AtlasGenerator>::ChangeFlags DynamicAtlas<AtlasGenerator>:
     return changeFlags;
 }
 
-template <class AtlasGenerator>
-AtlasGenerator &DynamicAtlas<AtlasGenerator>::atlasGenerator() {
+template <class AtlasGenerator, class Packer>
+AtlasGenerator &DynamicAtlas<AtlasGenerator, Packer>::atlasGenerator() {
     return generator;
 }
 
-template <class AtlasGenerator>
-const AtlasGenerator &DynamicAtlas<AtlasGenerator>::atlasGenerator() const {
+template <class AtlasGenerator, class Packer>
+const AtlasGenerator &DynamicAtlas<AtlasGenerator, Packer>::atlasGenerator() const {
     return generator;
 }
 
@@ -1,7 +1,13 @@
 
 #include "FontGeometry.h"
 
+#include <algorithm>
+#include "Workload.h"
+#include "font-kerning.h"
+
 #define DEFAULT_FONT_UNITS_PER_EM 2048.0
+#define CODEPOINT_PAGE_BITS 8
+#define CODEPOINT_PAGE_SIZE (1<<CODEPOINT_PAGE_BITS)
 
 namespace msdf_atlas {
 
@@ -33,7 +39,7 @@ FontGeometry::FontGeometry(std::vector<GlyphGeometry> *glyphStorage) : geometryS
     rangeEnd = glyphs->size();
 }
 
-FontGeometry::FontGeometry(FontGeometry &&orig) : geometryScale(orig.geometryScale), metrics(orig.metrics), preferredIdentifierType(orig.preferredIdentifierType), glyphs(orig.glyphs), rangeStart(orig.rangeStart), rangeEnd(orig.rangeEnd), glyphsByIndex((std::map<int, size_t> &&) orig.glyphsByIndex), glyphsByCodepoint((std::map<unicode_t, size_t> &&) orig.glyphsByCodepoint), kerning((std::map<std::pair<int, int>, double> &&) orig.kerning), ownGlyphs((std::vector<GlyphGeometry> &&) orig.ownGlyphs), name((std::string &&) orig.name) {
+FontGeometry::FontGeometry(FontGeometry &&orig) : geometryScale(orig.geometryScale), metrics(orig.metrics), preferredIdentifierType(orig.preferredIdentifierType), glyphs(orig.glyphs), rangeStart(orig.rangeStart), rangeEnd(orig.rangeEnd), glyphsByIndex((std::vector<int> &&) orig.glyphsByIndex), codepointPages((std::vector<int> &&) orig.codepointPages), glyphsByCodepoint((std::vector<int> &&) orig.glyphsByCodepoint), kerning((std::vector<std::pair<std::pair<int, int>, double> > &&) orig.kerning), ownGlyphs((std::vector<GlyphGeometry> &&) orig.ownGlyphs), name((std::string &&) orig.name) {
     if (glyphs == &orig.ownGlyphs)
         glyphs = &ownGlyphs;
 }
@@ -45,66 +51,89 @@ FontGeometry &FontGeometry::operator=(FontGeometry &&orig) {
         glyphs = orig.glyphs == &orig.ownGlyphs ? &ownGlyphs : orig.glyphs;
         rangeStart = orig.rangeStart;
         rangeEnd = orig.rangeEnd;
-        glyphsByIndex = (std::map<int, size_t> &&) orig.glyphsByIndex;
-        glyphsByCodepoint = (std::map<unicode_t, size_t> &&) orig.glyphsByCodepoint;
-        kerning = (std::map<std::pair<int, int>, double> &&) orig.kerning;
+        glyphsByIndex = (std::vector<int> &&) orig.glyphsByIndex;
+        codepointPages = (std::vector<int> &&) orig.codepointPages;
+        glyphsByCodepoint = (std::vector<int> &&) orig.glyphsByCodepoint;
+        kerning = (std::vector<std::pair<std::pair<int, int>, double> > &&) orig.kerning;
         ownGlyphs = (std::vector<GlyphGeometry> &&) orig.ownGlyphs;
         name = (std::string &&) orig.name;
     }
     return *this;
 }
 
-int FontGeometry::loadGlyphRange(msdfgen::FontHandle *font, double fontScale, unsigned rangeStart, unsigned rangeEnd, bool preprocessGeometry, bool enableKerning) {
-    if (!(glyphs->size() == this->rangeEnd && loadMetrics(font, fontScale)))
+int FontGeometry::loadGlyphRange(msdfgen::FontHandle *font, double fontScale, unsigned rangeStart, unsigned rangeEnd, bool preprocessGeometry, bool enableKerning, GeometryLoadMode loadMode) {
+    return loadGlyphRange(&font, 1, fontScale, rangeStart, rangeEnd, preprocessGeometry, enableKerning, loadMode);
+}
+
+int FontGeometry::loadGlyphRange(msdfgen::FontHandle *const *fonts, int fontCount, double fontScale, unsigned rangeStart, unsigned rangeEnd, bool preprocessGeometry, bool enableKerning, GeometryLoadMode loadMode) {
+    if (!(fontCount > 0 && glyphs->size() == this->rangeEnd && loadMetrics(fonts[0], fontScale)))
         return -1;
-    glyphs->reserve(glyphs->size()+(rangeEnd-rangeStart));
-    int loaded = 0;
-    for (unsigned index = rangeStart; index < rangeEnd; ++index) {
-        GlyphGeometry glyph;
-        if (glyph.load(font, geometryScale, msdfgen::GlyphIndex(index), preprocessGeometry)) {
-            addGlyph((GlyphGeometry &&) glyph);
-            ++loaded;
-        }
-    }
+    std::vector<unicode_t> indices;
+    indices.reserve(rangeEnd > rangeStart ? rangeEnd-rangeStart : 0);
+    for (unsigned index = rangeStart; index < rangeEnd; ++index)
+        indices.push_back(index);
+    int loaded = loadGlyphs(fonts, fontCount, indices, GlyphIdentifierType::GLYPH_INDEX, preprocessGeometry, loadMode);
     if (enableKerning)
-        loadKerning(font);
+        loadKerning(fonts[0]);
     preferredIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
     return loaded;
 }
 
-int FontGeometry::loadGlyphset(msdfgen::FontHandle *font, double fontScale, const Charset &glyphset, bool preprocessGeometry, bool enableKerning) {
-    if (!(glyphs->size() == rangeEnd && loadMetrics(font, fontScale)))
+int FontGeometry::loadGlyphset(msdfgen::FontHandle *font, double fontScale, const Charset &glyphset, bool preprocessGeometry, bool enableKerning, GeometryLoadMode loadMode) {
+    return loadGlyphset(&font, 1, fontScale, glyphset, preprocessGeometry, enableKerning, loadMode);
+}
+
+int FontGeometry::loadGlyphset(msdfgen::FontHandle *const *fonts, int fontCount, double fontScale, const Charset &glyphset, bool preprocessGeometry, bool enableKerning, GeometryLoadMode loadMode) {
+    if (!(fontCount > 0 && glyphs->size() == rangeEnd && loadMetrics(fonts[0], fontScale)))
         return -1;
-    glyphs->reserve(glyphs->size()+glyphset.size());
-    int loaded = 0;
-    for (unicode_t index : glyphset) {
-        GlyphGeometry glyph;
-        if (glyph.load(font, geometryScale, msdfgen::GlyphIndex(index), preprocessGeometry)) {
-            addGlyph((GlyphGeometry &&) glyph);
-            ++loaded;
-        }
-    }
+    std::vector<unicode_t> indices(glyphset.begin(), glyphset.end());
+    int loaded = loadGlyphs(fonts, fontCount, indices, GlyphIdentifierType::GLYPH_INDEX, preprocessGeometry, loadMode);
     if (enableKerning)
-        loadKerning(font);
+        loadKerning(fonts[0]);
     preferredIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
     return loaded;
 }
 
-int FontGeometry::loadCharset(msdfgen::FontHandle *font, double fontScale, const Charset &charset, bool preprocessGeometry, bool enableKerning) {
-    if (!(glyphs->size() == rangeEnd && loadMetrics(font, fontScale)))
+int FontGeometry::loadCharset(msdfgen::FontHandle *font, double fontScale, const Charset &charset, bool preprocessGeometry, bool enableKerning, GeometryLoadMode loadMode) {
+    return loadCharset(&font, 1, fontScale, charset, preprocessGeometry, enableKerning, loadMode);
+}
+
+int FontGeometry::loadCharset(msdfgen::FontHandle *const *fonts, int fontCount, double fontScale, const Charset &charset, bool preprocessGeometry, bool enableKerning, GeometryLoadMode loadMode) {
+    if (!(fontCount > 0 && glyphs->size() == rangeEnd && loadMetrics(fonts[0], fontScale)))
         return -1;
-    glyphs->reserve(glyphs->size()+charset.size());
+    std::vector<unicode_t> codepoints(charset.begin(), charset.end());
+    int loaded = loadGlyphs(fonts, fontCount, codepoints, GlyphIdentifierType::UNICODE_CODEPOINT, preprocessGeometry, loadMode);
+    if (enableKerning)
+        loadKerning(fonts[0]);
+    preferredIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
+    return loaded;
+}
+
+int FontGeometry::loadGlyphs(msdfgen::FontHandle *const *fonts, int fontCount, const std::vector<unicode_t> &identifiers, GlyphIdentifierType identifierType, bool preprocessGeometry, GeometryLoadMode loadMode) {
+    // Each thread loads glyphs from its own font handle, then the glyphs are added in the original order
+    std::vector<GlyphGeometry> loadedGlyphs(identifiers.size());
+    std::vector<char> success(identifiers.size());
+    Workload([&](int i, int threadNo) -> bool {
+        msdfgen::FontHandle *font = fonts[threadNo];
+        GlyphGeometry &glyph = loadedGlyphs[i];
+        switch (identifierType) {
+            case GlyphIdentifierType::GLYPH_INDEX:
+                success[i] = loadMode == GeometryLoadMode::SHAPE ? glyph.load(font, geometryScale, msdfgen::GlyphIndex(identifiers[i]), preprocessGeometry) : glyph.loadBounds(font, geometryScale, msdfgen::GlyphIndex(identifiers[i]), preprocessGeometry, loadMode == GeometryLoadMode::CORNERS);
+                break;
+            case GlyphIdentifierType::UNICODE_CODEPOINT:
+                success[i] = loadMode == GeometryLoadMode::SHAPE ? glyph.load(font, geometryScale, identifiers[i], preprocessGeometry) : glyph.loadBounds(font, geometryScale, identifiers[i], preprocessGeometry, loadMode == GeometryLoadMode::CORNERS);
+                break;
+        }
+        return true;
+    }, (int) identifiers.size()).finish(fontCount);
+    glyphs->reserve(glyphs->size()+identifiers.size());
     int loaded = 0;
-    for (unicode_t cp : charset) {
-        GlyphGeometry glyph;
-        if (glyph.load(font, geometryScale, cp, preprocessGeometry)) {
-            addGlyph((GlyphGeometry &&) glyph);
+    for (size_t i = 0; i < identifiers.size(); ++i) {
+        if (success[i]) {
+            addGlyph((GlyphGeometry &&) loadedGlyphs[i]);
             ++loaded;
         }
     }
-    if (enableKerning)
-        loadKerning(font);
-    preferredIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
     return loaded;
 }
 
@@ -123,12 +152,33 @@ bool FontGeometry::loadMetrics(msdfgen::FontHandle *font, double fontScale) {
     return true;
 }
 
+void FontGeometry::indexGlyph(const GlyphGeometry &glyph) {
+    // If multiple glyphs share an identifier, the first one added is found
+    int index = glyph.getIndex();
+    if (index >= 0) {
+        if (index >= (int) glyphsByIndex.size())
+            glyphsByIndex.resize(index+1, -1);
+        if (glyphsByIndex[index] < 0)
+            glyphsByIndex[index] = (int) rangeEnd;
+    }
+    if (unicode_t codepoint = glyph.getCodepoint()) {
+        size_t page = codepoint>>CODEPOINT_PAGE_BITS;
+        if (page >= codepointPages.size())
+            codepointPages.resize(page+1, -1);
+        if (codepointPages[page] < 0) {
+            codepointPages[page] = (int) glyphsByCodepoint.size();
+            glyphsByCodepoint.resize(glyphsByCodepoint.size()+CODEPOINT_PAGE_SIZE, -1);
+        }
+        int &slot = glyphsByCodepoint[codepointPages[page]+(codepoint&(CODEPOINT_PAGE_SIZE-1))];
+        if (slot < 0)
+            slot = (int) rangeEnd;
+    }
+}
+
 bool FontGeometry::addGlyph(const GlyphGeometry &glyph) {
     if (glyphs->size() != rangeEnd)
         return false;
-    glyphsByIndex.insert(std::make_pair(glyph.getIndex(), rangeEnd));
-    if (glyph.getCodepoint())
-        glyphsByCodepoint.insert(std::make_pair(glyph.getCodepoint(), rangeEnd));
+    indexGlyph(glyph);
     glyphs->push_back(glyph);
     ++rangeEnd;
     return true;
@@ -137,9 +187,7 @@ bool FontGeometry::addGlyph(const GlyphGeometry &glyph) {
 bool FontGeometry::addGlyph(GlyphGeometry &&glyph) {
     if (glyphs->size() != rangeEnd)
         return false;
-    glyphsByIndex.insert(std::make_pair(glyph.getIndex(), rangeEnd));
-    if (glyph.getCodepoint())
-        glyphsByCodepoint.insert(std::make_pair(glyph.getCodepoint(), rangeEnd));
+    indexGlyph(glyph);
     glyphs->push_back((GlyphGeometry &&) glyph);
     ++rangeEnd;
     return true;
@@ -151,13 +199,58 @@ int FontGeometry::loadKerning(msdfgen::FontHandle *font) {
         for (size_t j = rangeStart; j < rangeEnd; ++j) {
             double advance;
             if (msdfgen::getKerning(advance, font, (*glyphs)[i].getGlyphIndex(), (*glyphs)[j].getGlyphIndex(), msdfgen::FONT_SCALING_NONE) && advance) {
-                kerning[std::make_pair<int, int>((*glyphs)[i].getIndex(), (*glyphs)[j].getIndex())] = geometryScale*advance;
+                kerning.push_back(std::make_pair(std::make_pair((*glyphs)[i].getIndex(), (*glyphs)[j].getIndex()), geometryScale*advance));
                 ++loaded;
             }
         }
+    sortKerning();
+    return loaded;
+}
+
+int FontGeometry::loadKerning(const byte *fontData, size_t length) {
+    std::vector<bool> glyphFilter(glyphsByIndex.size());
+    for (size_t i = 0; i < glyphsByIndex.size(); ++i)
+        glyphFilter[i] = glyphsByIndex[i] >= 0;
+    std::map<std::pair<int, int>, int> fontKerning;
+    if (!readFontKerning(fontKerning, fontData, length, glyphFilter))
+        return -1;
+    int loaded = 0;
+    kerning.reserve(kerning.size()+fontKerning.size());
+    for (const std::pair<const std::pair<int, int>, int> &elem : fontKerning) {
+        if (elem.second) {
+            kerning.push_back(std::make_pair(elem.first, geometryScale*elem.second));
+            ++loaded;
+        }
+    }
+    sortKerning();
     return loaded;
 }
 
+void FontGeometry::sortKerning() {
+    typedef std::pair<std::pair<int, int>, double> KerningPair;
+    std::stable_sort(kerning.begin(), kerning.end(), [](const KerningPair &a, const KerningPair &b) {
+        return a.first < b.first;
+    });
+    // Of duplicate pairs, the one loaded last takes precedence
+    std::vector<KerningPair>::iterator dst = kerning.begin();
+    for (std::vector<KerningPair>::iterator src = kerning.begin(); src != kerning.end(); ++src) {
+        if (src+1 == kerning.end() || (src+1)->first != src->first)
+            *dst++ = *src;
+    }
+    kerning.erase(dst, kerning.end());
+}
+
+const double *FontGeometry::findKerning(int index1, int index2) const {
+    typedef std::pair<std::pair<int, int>, double> KerningPair;
+    std::pair<int, int> key(index1, index2);
+    std::vector<KerningPair>::const_iterator it = std::lower_bound(kerning.begin(), kerning.end(), key, [](const KerningPair &a, const std::pair<int, int> &b) {
+        return a.first < b;
+    });
+    if (it != kerning.end() && it->first == key)
+        return &it->second;
+    return nullptr;
+}
+
 void FontGeometry::setName(const char *name) {
     if (name)
         this->name = name;
@@ -182,16 +275,19 @@ FontGeometry::GlyphRange FontGeometry::getGlyphs() const {
 }
 
 const GlyphGeometry *FontGeometry::getGlyph(msdfgen::GlyphIndex index) const {
-    std::map<int, size_t>::const_iterator it = glyphsByIndex.find(index.getIndex());
-    if (it != glyphsByIndex.end())
-        return &(*glyphs)[it->second];
+    unsigned i = index.getIndex();
+    if (i < glyphsByIndex.size() && glyphsByIndex[i] >= 0)
+        return &(*glyphs)[glyphsByIndex[i]];
     return nullptr;
 }
 
 const GlyphGeometry *FontGeometry::getGlyph(unicode_t codepoint) const {
-    std::map<unicode_t, size_t>::const_iterator it = glyphsByCodepoint.find(codepoint);
-    if (it != glyphsByCodepoint.end())
-        return &(*glyphs)[it->second];
+    size_t page = codepoint>>CODEPOINT_PAGE_BITS;
+    if (page < codepointPages.size() && codepointPages[page] >= 0) {
+        int slot = glyphsByCodepoint[codepointPages[page]+(codepoint&(CODEPOINT_PAGE_SIZE-1))];
+        if (slot >= 0)
+            return &(*glyphs)[slot];
+    }
     return nullptr;
 }
 
@@ -200,9 +296,8 @@ bool FontGeometry::getAdvance(double &advance, msdfgen::GlyphIndex index1, msdfg
     if (!glyph1)
         return false;
     advance = glyph1->getAdvance();
-    std::map<std::pair<int, int>, double>::const_iterator it = kerning.find(std::make_pair<int, int>(index1.getIndex(), index2.getIndex()));
-    if (it != kerning.end())
-        advance += it->second;
+    if (const double *kern = findKerning(index1.getIndex(), index2.getIndex()))
+        advance += *kern;
     return true;
 }
 
@@ -211,13 +306,16 @@ bool FontGeometry::getAdvance(double &advance, unicode_t codepoint1, unicode_t c
     if (!((glyph1 = getGlyph(codepoint1)) && (glyph2 = getGlyph(codepoint2))))
         return false;
     advance = glyph1->getAdvance();
-    std::map<std::pair<int, int>, double>::const_iterator it = kerning.find(std::make_pair<int, int>(glyph1->getIndex(), glyph2->getIndex()));
-    if (it != kerning.end())
-        advance += it->second;
+    if (const double *kern = findKerning(glyph1->getIndex(), glyph2->getIndex()))
+        advance += *kern;
     return true;
 }
 
-const std::map<std::pair<int, int>, double> &FontGeometry::getKerning() const {
+std::map<std::pair<int, int>, double> FontGeometry::getKerning() const {
+    return std::map<std::pair<int, int>, double>(kerning.begin(), kerning.end());
+}
+
+const std::vector<std::pair<std::pair<int, int>, double> > &FontGeometry::getKerningTable() const {
     return kerning;
 }
 
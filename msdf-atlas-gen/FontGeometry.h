@@ -3,8 +3,8 @@
 
 #include <utility>
 #include <vector>
-#include <string>
 #include <map>
+#include <string>
 #include <msdfgen.h>
 #include <msdfgen-ext.h>
 #include "types.h"
@@ -35,12 +35,17 @@ public:
     FontGeometry(FontGeometry &&orig);
     FontGeometry &operator=(FontGeometry &&orig);
 
-    /// Loads the consecutive range of glyphs between rangeStart (inclusive) and rangeEnd (exclusive), returns the number of successfully loaded glyphs
-    int loadGlyphRange(msdfgen::FontHandle *font, double fontScale, unsigned rangeStart, unsigned rangeEnd, bool preprocessGeometry = true, bool enableKerning = true);
-    /// Loads all glyphs in a glyphset (Charset elements are glyph indices), returns the number of successfully loaded glyphs
-    int loadGlyphset(msdfgen::FontHandle *font, double fontScale, const Charset &glyphset, bool preprocessGeometry = true, bool enableKerning = true);
-    /// Loads all glyphs in a charset (Charset elements are Unicode codepoints), returns the number of successfully loaded glyphs
-    int loadCharset(msdfgen::FontHandle *font, double fontScale, const Charset &charset, bool preprocessGeometry = true, bool enableKerning = true);
+    // The load functions below return the number of successfully loaded glyphs. The loadMode determines how much of the glyphs' geometry is retained.
+    // If multiple handles of the same font are provided, glyphs are loaded in parallel with one thread per handle.
+    /// Loads the consecutive range of glyphs between rangeStart (inclusive) and rangeEnd (exclusive)
+    int loadGlyphRange(msdfgen::FontHandle *font, double fontScale, unsigned rangeStart, unsigned rangeEnd, bool preprocessGeometry = true, bool enableKerning = true, GeometryLoadMode loadMode = GeometryLoadMode::SHAPE);
+    int loadGlyphRange(msdfgen::FontHandle *const *fonts, int fontCount, double fontScale, unsigned rangeStart, unsigned rangeEnd, bool preprocessGeometry = true, bool enableKerning = true, GeometryLoadMode loadMode = GeometryLoadMode::SHAPE);
+    /// Loads all glyphs in a glyphset (Charset elements are glyph indices)
+    int loadGlyphset(msdfgen::FontHandle *font, double fontScale, const Charset &glyphset, bool preprocessGeometry = true, bool enableKerning = true, GeometryLoadMode loadMode = GeometryLoadMode::SHAPE);
+    int loadGlyphset(msdfgen::FontHandle *const *fonts, int fontCount, double fontScale, const Charset &glyphset, bool preprocessGeometry = true, bool enableKerning = true, GeometryLoadMode loadMode = GeometryLoadMode::SHAPE);
+    /// Loads all glyphs in a charset (Charset elements are Unicode codepoints)
+    int loadCharset(msdfgen::FontHandle *font, double fontScale, const Charset &charset, bool preprocessGeometry = true, bool enableKerning = true, GeometryLoadMode loadMode = GeometryLoadMode::SHAPE);
+    int loadCharset(msdfgen::FontHandle *const *fonts, int fontCount, double fontScale, const Charset &charset, bool preprocessGeometry = true, bool enableKerning = true, GeometryLoadMode loadMode = GeometryLoadMode::SHAPE);
 
     /// Only loads font metrics and geometry scale from font
     bool loadMetrics(msdfgen::FontHandle *font, double fontScale);
@@ -49,6 +54,8 @@ public:
     bool addGlyph(GlyphGeometry &&glyph);
     /// Loads kerning pairs for all glyphs that are currently present, returns the number of loaded kerning pairs
     int loadKerning(msdfgen::FontHandle *font);
+    /// Loads kerning pairs for all glyphs that are currently present directly from the font file's data, returns the number of loaded kerning pairs or -1 if the data format is not supported
+    int loadKerning(const byte *fontData, size_t length);
     /// Sets a name to be associated with the font
     void setName(const char *name);
 
@@ -66,8 +73,10 @@ public:
     /// Outputs the advance between two glyphs with kerning taken into consideration, returns false on failure
     bool getAdvance(double &advance, msdfgen::GlyphIndex index1, msdfgen::GlyphIndex index2) const;
     bool getAdvance(double &advance, unicode_t codepoint1, unicode_t codepoint2) const;
-    /// Returns the complete mapping of kerning pairs (by glyph indices) and their respective advance values
-    const std::map<std::pair<int, int>, double> &getKerning() const;
+    /// Returns the complete mapping of kerning pairs (by glyph indices) and their respective advance values, constructed from the kerning table on each call
+    std::map<std::pair<int, int>, double> getKerning() const;
+    /// Returns the complete list of kerning pairs (by glyph indices) and their respective advance values, sorted by the glyph indices
+    const std::vector<std::pair<std::pair<int, int>, double> > &getKerningTable() const;
     /// Returns the name associated with the font or null if not set
     const char *getName() const;
 
@@ -77,12 +86,20 @@ private:
     GlyphIdentifierType preferredIdentifierType;
     std::vector<GlyphGeometry> *glyphs;
     size_t rangeStart, rangeEnd;
-    std::map<int, size_t> glyphsByIndex;
-    std::map<unicode_t, size_t> glyphsByCodepoint;
-    std::map<std::pair<int, int>, double> kerning;
+    /// Glyph storage positions by glyph index, -1 where not loaded
+    std::vector<int> glyphsByIndex;
+    /// Two-level table of glyph storage positions by codepoint - start of each 256-codepoint page in glyphsByCodepoint, -1 for empty pages
+    std::vector<int> codepointPages;
+    std::vector<int> glyphsByCodepoint;
+    std::vector<std::pair<std::pair<int, int>, double> > kerning;
     std::vector<GlyphGeometry> ownGlyphs;
     std::string name;
 
+    int loadGlyphs(msdfgen::FontHandle *const *fonts, int fontCount, const std::vector<unicode_t> &identifiers, GlyphIdentifierType identifierType, bool preprocessGeometry, GeometryLoadMode loadMode);
+    void indexGlyph(const GlyphGeometry &glyph);
+    void sortKerning();
+    const double *findKerning(int index1, int index2) const;
+
     FontGeometry(const FontGeometry &);
     FontGeometry &operator=(const FontGeometry &);
 
@@ -2,11 +2,55 @@
 #include "GlyphGeometry.h"
 
 #include <cmath>
+#include <algorithm>
 #include <core/ShapeDistanceFinder.h>
 
 namespace msdf_atlas {
 
-GlyphGeometry::GlyphGeometry() : index(), codepoint(), geometryScale(), bounds(), advance(), box() { }
+GlyphGeometry::GlyphGeometry() : index(), codepoint(), geometryScale(), bounds(), whitespace(true), advance(), box() { }
+
+/// Applies geometry preprocessing, normalizes the shape and corrects its orientation, outputs its bounds
+static void prepareShape(msdfgen::Shape &shape, msdfgen::Shape::Bounds &bounds, bool preprocessGeometry) {
+    #ifdef MSDFGEN_USE_SKIA
+        if (preprocessGeometry)
+            msdfgen::resolveShapeGeometry(shape);
+    #endif
+    shape.normalize();
+    bounds = shape.getBounds();
+    #ifdef MSDFGEN_USE_SKIA
+        if (!preprocessGeometry)
+    #endif
+    {
+        // Determine if shape is winded incorrectly and reverse it in that case
+        msdfgen::Point2 outerPoint(bounds.l-(bounds.r-bounds.l)-1, bounds.b-(bounds.t-bounds.b)-1);
+        if (msdfgen::SimpleTrueShapeDistanceFinder::oneShotDistance(shape, outerPoint) > 0) {
+            for (msdfgen::Contour &contour : shape.contours)
+                contour.reverse();
+        }
+    }
+}
+
+/// Outputs the corners extended by msdfgen::Shape::boundMiters with polarity = 1
+static void collectCorners(std::vector<GlyphGeometry::Corner> &corners, const msdfgen::Shape &shape) {
+    for (const msdfgen::Contour &contour : shape.contours) {
+        if (contour.edges.empty())
+            continue;
+        msdfgen::Vector2 prevDir = contour.edges.back()->direction(1).normalize(true);
+        for (const msdfgen::EdgeHolder &edge : contour.edges) {
+            msdfgen::Vector2 dir = -edge->direction(0).normalize(true);
+            if (msdfgen::crossProduct(prevDir, dir) >= 0) {
+                GlyphGeometry::Corner corner;
+                corner.point = edge->point(0);
+                corner.direction = (prevDir+dir).normalize(true);
+                // Without a finite length (q = 0), the miter is always limited
+                double q = .5*(1-msdfgen::dotProduct(prevDir, dir));
+                corner.miterLength = q > 0 ? 1/sqrt(q) : HUGE_VAL;
+                corners.push_back(corner);
+            }
+            prevDir = edge->direction(1).normalize(true);
+        }
+    }
+}
 
 bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry) {
     if (font && msdfgen::loadGlyph(shape, font, index, msdfgen::FONT_SCALING_NONE, &advance) && shape.validate()) {
@@ -14,23 +58,9 @@ bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, msdfge
         this->geometryScale = geometryScale;
         codepoint = 0;
         advance *= geometryScale;
-        #ifdef MSDFGEN_USE_SKIA
-            if (preprocessGeometry)
-                msdfgen::resolveShapeGeometry(shape);
-        #endif
-        shape.normalize();
-        bounds = shape.getBounds();
-        #ifdef MSDFGEN_USE_SKIA
-            if (!preprocessGeometry)
-        #endif
-        {
-            // Determine if shape is winded incorrectly and reverse it in that case
-            msdfgen::Point2 outerPoint(bounds.l-(bounds.r-bounds.l)-1, bounds.b-(bounds.t-bounds.b)-1);
-            if (msdfgen::SimpleTrueShapeDistanceFinder::oneShotDistance(shape, outerPoint) > 0) {
-                for (msdfgen::Contour &contour : shape.contours)
-                    contour.reverse();
-            }
-        }
+        corners.clear();
+        prepareShape(shape, bounds, preprocessGeometry);
+        whitespace = shape.contours.empty();
         return true;
     }
     return false;
@@ -47,6 +77,36 @@ bool GlyphGeometry::load(msdfgen::FontHandle *font, double geometryScale, unicod
     return false;
 }
 
+bool GlyphGeometry::loadBounds(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry, bool loadCorners) {
+    msdfgen::Shape outline;
+    if (font && msdfgen::loadGlyph(outline, font, index, msdfgen::FONT_SCALING_NONE, &advance) && outline.validate()) {
+        this->index = index.getIndex();
+        this->geometryScale = geometryScale;
+        codepoint = 0;
+        advance *= geometryScale;
+        shape = msdfgen::Shape();
+        corners.clear();
+        // The outline is prepared as in load, since preprocessing may alter its bounds and corners
+        prepareShape(outline, bounds, preprocessGeometry);
+        if (loadCorners)
+            collectCorners(corners, outline);
+        whitespace = outline.contours.empty();
+        return true;
+    }
+    return false;
+}
+
+bool GlyphGeometry::loadBounds(msdfgen::FontHandle *font, double geometryScale, unicode_t codepoint, bool preprocessGeometry, bool loadCorners) {
+    msdfgen::GlyphIndex index;
+    if (msdfgen::getGlyphIndex(index, font, codepoint)) {
+        if (loadBounds(font, geometryScale, index, preprocessGeometry, loadCorners)) {
+            this->codepoint = codepoint;
+            return true;
+        }
+    }
+    return false;
+}
+
 void GlyphGeometry::edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed) {
     fn(shape, angleThreshold, seed);
 }
@@ -62,7 +122,7 @@ void GlyphGeometry::wrapBox(const GlyphAttributes &glyphAttributes) {
         l += range.lower, b += range.lower;
         r -= range.lower, t -= range.lower;
         if (glyphAttributes.miterLimit > 0)
-            shape.boundMiters(l, b, r, t, -range.lower, glyphAttributes.miterLimit, 1);
+            boundMiters(l, b, r, t, -range.lower, glyphAttributes.miterLimit);
         l -= fullPadding.l, b -= fullPadding.b;
         r += fullPadding.r, t += fullPadding.t;
         if (glyphAttributes.pxAlignOriginX) {
@@ -128,7 +188,7 @@ void GlyphGeometry::frameBox(const GlyphAttributes &glyphAttributes, int width,
         l += range.lower, b += range.lower;
         r -= range.lower, t -= range.lower;
         if (glyphAttributes.miterLimit > 0)
-            shape.boundMiters(l, b, r, t, -range.lower, glyphAttributes.miterLimit, 1);
+            boundMiters(l, b, r, t, -range.lower, glyphAttributes.miterLimit);
         l -= fullPadding.l, b -= fullPadding.b;
         r += fullPadding.r, t += fullPadding.t;
         if (fixedX)
@@ -183,6 +243,14 @@ void GlyphGeometry::setBoxRect(const Rectangle &rect) {
     box.rect = rect;
 }
 
+void GlyphGeometry::setBoxPage(int page) {
+    box.page = page;
+}
+
+void GlyphGeometry::setBoxChannel(int channel) {
+    box.channel = channel;
+}
+
 int GlyphGeometry::getIndex() const {
     return index;
 }
@@ -213,6 +281,13 @@ const msdfgen::Shape &GlyphGeometry::getShape() const {
     return shape;
 }
 
+void GlyphGeometry::getCorners(std::vector<Corner> &corners) const {
+    if (shape.contours.empty())
+        corners.insert(corners.end(), this->corners.begin(), this->corners.end());
+    else
+        collectCorners(corners, shape);
+}
+
 const msdfgen::Shape::Bounds &GlyphGeometry::getShapeBounds() const {
     return bounds;
 }
@@ -234,6 +309,14 @@ void GlyphGeometry::getBoxSize(int &w, int &h) const {
     w = box.rect.w, h = box.rect.h;
 }
 
+int GlyphGeometry::getBoxPage() const {
+    return box.page;
+}
+
+int GlyphGeometry::getBoxChannel() const {
+    return box.channel;
+}
+
 msdfgen::Range GlyphGeometry::getBoxRange() const {
     return box.range;
 }
@@ -250,6 +333,18 @@ msdfgen::Vector2 GlyphGeometry::getBoxTranslate() const {
     return box.translate;
 }
 
+void GlyphGeometry::getMipBoxRect(int level, int &x, int &y, int &w, int &h) const {
+    x = box.rect.x>>level, y = box.rect.y>>level;
+    w = box.rect.w > 0 ? ((box.rect.x+box.rect.w+(1<<level)-1)>>level)-x : 0;
+    h = box.rect.h > 0 ? ((box.rect.y+box.rect.h+(1<<level)-1)>>level)-y : 0;
+}
+
+msdfgen::Vector2 GlyphGeometry::getMipBoxTranslate(int level) const {
+    // The box is extended to the nearest pixel boundary of the level below its original position
+    int dx = box.rect.x&((1<<level)-1), dy = box.rect.y&((1<<level)-1);
+    return box.translate+1/box.scale*msdfgen::Vector2(dx, dy);
+}
+
 void GlyphGeometry::getQuadPlaneBounds(double &l, double &b, double &r, double &t) const {
     if (box.rect.w > 0 && box.rect.h > 0) {
         double invBoxScale = 1/box.scale;
@@ -272,7 +367,7 @@ void GlyphGeometry::getQuadAtlasBounds(double &l, double &b, double &r, double &
 }
 
 bool GlyphGeometry::isWhitespace() const {
-    return shape.contours.empty();
+    return whitespace;
 }
 
 GlyphGeometry::operator GlyphBox() const {
@@ -284,6 +379,20 @@ GlyphGeometry::operator GlyphBox() const {
     return box;
 }
 
+void GlyphGeometry::boundMiters(double &l, double &b, double &r, double &t, double border, double miterLimit) const {
+    if (!shape.contours.empty()) {
+        shape.boundMiters(l, b, r, t, border, miterLimit, 1);
+        return;
+    }
+    // Same arithmetic as msdfgen::Shape::boundMiters on the retained corners
+    for (const Corner &corner : corners) {
+        double miterLength = std::min(corner.miterLength, miterLimit);
+        msdfgen::Point2 miter = corner.point+border*miterLength*corner.direction;
+        l = std::min(l, miter.x), b = std::min(b, miter.y);
+        r = std::max(r, miter.x), t = std::max(t, miter.y);
+    }
+}
+
 msdfgen::Range operator+(msdfgen::Range a, msdfgen::Range b) {
     return msdfgen::Range(a.lower+b.lower, a.upper+b.upper);
 }
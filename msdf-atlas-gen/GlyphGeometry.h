@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <vector>
 #include <msdfgen.h>
 #include <msdfgen-ext.h>
 #include "types.h"
@@ -21,11 +22,22 @@ public:
         double miterLimit;
         bool pxAlignOriginX, pxAlignOriginY;
     };
+    /// A convex corner of the shape, which is extended by a miter in a perpendicular distance field
+    struct Corner {
+        msdfgen::Point2 point;
+        /// Unit direction of the miter
+        msdfgen::Vector2 direction;
+        /// Length of the miter per unit of border width before the miter limit is applied
+        double miterLength;
+    };
 
     GlyphGeometry();
     /// Loads glyph geometry from font
     bool load(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry = true);
     bool load(msdfgen::FontHandle *font, double geometryScale, unicode_t codepoint, bool preprocessGeometry = true);
+    /// Loads only the glyph's bounds and advance from font, prepared identically to load but without retaining the shape, which suffices for layout without miters, or with miters if loadCorners is set
+    bool loadBounds(msdfgen::FontHandle *font, double geometryScale, msdfgen::GlyphIndex index, bool preprocessGeometry = true, bool loadCorners = false);
+    bool loadBounds(msdfgen::FontHandle *font, double geometryScale, unicode_t codepoint, bool preprocessGeometry = true, bool loadCorners = false);
     /// Applies edge coloring to glyph shape
     void edgeColoring(void (*fn)(msdfgen::Shape &, double, unsigned long long), double angleThreshold, unsigned long long seed);
     /// Computes the dimensions of the glyph's box as well as the transformation for the generator function
@@ -40,6 +52,10 @@ public:
     void placeBox(int x, int y);
     /// Sets the glyph's box's rectangle in the atlas
     void setBoxRect(const Rectangle &rect);
+    /// Sets the index of the atlas page containing the glyph's box
+    void setBoxPage(int page);
+    /// Sets the index of the image channel containing the glyph's box in a channel-packed atlas
+    void setBoxChannel(int channel);
     /// Returns the glyph's index within the font
     int getIndex() const;
     /// Returns the glyph's index as a msdfgen::GlyphIndex
@@ -54,6 +70,8 @@ public:
     const msdfgen::Shape &getShape() const;
     /// Returns the glyph's shape's raw bounds
     const msdfgen::Shape::Bounds &getShapeBounds() const;
+    /// Outputs the convex corners of the glyph's shape, or of its discarded shape if loaded by loadBounds with corners
+    void getCorners(std::vector<Corner> &corners) const;
     /// Returns the glyph's advance
     double getAdvance() const;
     /// Returns the glyph's box in the atlas
@@ -62,6 +80,10 @@ public:
     void getBoxRect(int &x, int &y, int &w, int &h) const;
     /// Outputs the dimensions of the glyph's box in the atlas
     void getBoxSize(int &w, int &h) const;
+    /// Returns the index of the atlas page containing the glyph's box
+    int getBoxPage() const;
+    /// Returns the index of the image channel containing the glyph's box in a channel-packed atlas
+    int getBoxChannel() const;
     /// Returns the range needed to generate the glyph's SDF
     msdfgen::Range getBoxRange() const;
     /// Returns the projection needed to generate the glyph's bitmap
@@ -70,6 +92,10 @@ public:
     double getBoxScale() const;
     /// Returns the translation vector needed to generate the glyph's bitmap
     msdfgen::Vector2 getBoxTranslate() const;
+    /// Outputs the glyph's box in a mipmap level of the atlas, whose dimensions are halved with each level, expanded to whole pixels
+    void getMipBoxRect(int level, int &x, int &y, int &w, int &h) const;
+    /// Returns the translation vector needed to generate the glyph's bitmap in a mipmap level of the atlas (the scale is halved with each level)
+    msdfgen::Vector2 getMipBoxTranslate(int level) const;
     /// Outputs the bounding box of the glyph as it should be placed on the baseline
     void getQuadPlaneBounds(double &l, double &b, double &r, double &t) const;
     /// Outputs the bounding box of the glyph in the atlas
@@ -84,16 +110,24 @@ private:
     unicode_t codepoint;
     double geometryScale;
     msdfgen::Shape shape;
+    /// Corners retained by loadBounds in place of the shape
+    std::vector<Corner> corners;
     msdfgen::Shape::Bounds bounds;
+    bool whitespace;
     double advance;
     struct {
         Rectangle rect;
+        int page;
+        int channel;
         msdfgen::Range range;
         double scale;
         msdfgen::Vector2 translate;
         Padding outerPadding;
     } box;
 
+    /// Extends the bounds by the miters of the shape's corners
+    void boundMiters(double &l, double &b, double &r, double &t, double border, double miterLimit) const;
+
 };
 
 msdfgen::Range operator+(msdfgen::Range a, msdfgen::Range b);
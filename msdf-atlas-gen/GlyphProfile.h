@@ -0,0 +1,21 @@
+
+#pragma once
+
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// The cost of generating a single glyph's bitmap, recorded by ImmediateAtlasGenerator if profiling is enabled
+struct GlyphProfile {
+    int index;
+    unicode_t codepoint;
+    /// Wall-clock time spent in the generator function in seconds
+    double time;
+    int contourCount, edgeCount;
+    /// Area of the generated part of the glyph box in pixels
+    int boxArea;
+    /// Whether the scanline sign correction and MSDF error correction passes were enabled for the glyph
+    bool scanlinePass, errorCorrection;
+};
+
+}
@@ -1,11 +1,98 @@
 
 #include "GridAtlasPacker.h"
 
+#include <cmath>
 #include <algorithm>
 #include "utils.hpp"
+#include "Workload.h"
 
 namespace msdf_atlas {
 
+/**
+ * Holds the bounds of a glyph's shape (extended by outer range and miters) as functions of the outer range.
+ * Each miter point moves linearly with the range, so each side of the bounds is the upper envelope of a set of lines.
+ * This allows the bounds to be evaluated for any scale without repeatedly traversing the shape.
+ */
+class GridAtlasPacker::GlyphExtents {
+
+public:
+    GlyphExtents() : geometryScale(1) { }
+
+    GlyphExtents(const GlyphGeometry &glyph, double miterLimit) : geometryScale(glyph.getGeometryScale()) {
+        const msdfgen::Shape::Bounds &bounds = glyph.getShapeBounds();
+        // Left and bottom sides are stored negated so that all sides are maxima
+        sides[0].push_back(Line { -bounds.l, 1 });
+        sides[1].push_back(Line { -bounds.b, 1 });
+        sides[2].push_back(Line { bounds.r, 1 });
+        sides[3].push_back(Line { bounds.t, 1 });
+        if (miterLimit > 0) {
+            // Same miter points as msdfgen::Shape::boundMiters with polarity = 1, but as a function of border width
+            std::vector<GlyphGeometry::Corner> corners;
+            glyph.getCorners(corners);
+            for (const GlyphGeometry::Corner &corner : corners) {
+                msdfgen::Vector2 miter = std::min(corner.miterLength, miterLimit)*corner.direction;
+                sides[0].push_back(Line { -corner.point.x, -miter.x });
+                sides[1].push_back(Line { -corner.point.y, -miter.y });
+                sides[2].push_back(Line { corner.point.x, miter.x });
+                sides[3].push_back(Line { corner.point.y, miter.y });
+            }
+            for (std::vector<Line> &side : sides)
+                reduceToEnvelope(side);
+        }
+    }
+
+    double getGeometryScale() const {
+        return geometryScale;
+    }
+
+    /// Outputs the bounds for the given outer range (in shape units)
+    void getBounds(double &l, double &b, double &r, double &t, double outerRange) const {
+        l = -evaluate(sides[0], outerRange);
+        b = -evaluate(sides[1], outerRange);
+        r = evaluate(sides[2], outerRange);
+        t = evaluate(sides[3], outerRange);
+    }
+
+private:
+    struct Line {
+        double offset, slope;
+    };
+
+    double geometryScale;
+    std::vector<Line> sides[4];
+
+    /// Removes lines that never reach the upper envelope
+    static void reduceToEnvelope(std::vector<Line> &lines) {
+        std::sort(lines.begin(), lines.end(), [](const Line &a, const Line &b) {
+            return a.slope < b.slope || (a.slope == b.slope && a.offset < b.offset);
+        });
+        size_t n = 0;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            const Line &line = lines[i];
+            if (n > 0 && lines[n-1].slope == line.slope)
+                --n;
+            while (n > 1) {
+                const Line &a = lines[n-2], &b = lines[n-1];
+                // Is b's intersection with a at or beyond line's intersection with a?
+                if ((a.offset-line.offset)*(b.slope-a.slope) <= (a.offset-b.offset)*(line.slope-a.slope))
+                    --n;
+                else
+                    break;
+            }
+            lines[n++] = line;
+        }
+        lines.resize(n);
+    }
+
+    static double evaluate(const std::vector<Line> &envelope, double x) {
+        double y = envelope[0].offset+envelope[0].slope*x;
+        for (size_t i = 1; i < envelope.size(); ++i)
+            y = std::max(y, envelope[i].offset+envelope[i].slope*x);
+        return y;
+    }
+
+};
+
 static bool squareConstraint(DimensionsConstraint constraint) {
     switch (constraint) {
         case DimensionsConstraint::SQUARE:
@@ -91,32 +178,27 @@ GridAtlasPacker::GridAtlasPacker() :
     pxAlignOriginX(false), pxAlignOriginY(false),
     scaleMaximizationTolerance(.001),
     alignedColumnsBias(.125),
-    cutoff(false)
+    cutoff(false),
+    threadCount(1)
 { }
 
-msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &maxHeight, GlyphGeometry *glyphs, int count, double scale, double outerRange) const {
+msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &maxHeight, const std::vector<GlyphExtents> &glyphExtents, double scale, double outerRange) const {
     static const double LARGE_VALUE = 1e240;
     msdfgen::Shape::Bounds maxBounds = { +LARGE_VALUE, +LARGE_VALUE, -LARGE_VALUE, -LARGE_VALUE };
-    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
-        if (!glyph->isWhitespace()) {
-            double geometryScale = glyph->getGeometryScale();
-            double shapeOuterRange = outerRange/geometryScale;
-            geometryScale *= scale;
-            const msdfgen::Shape::Bounds &shapeBounds = glyph->getShapeBounds();
-            double l = shapeBounds.l, b = shapeBounds.b, r = shapeBounds.r, t = shapeBounds.t;
-            l -= shapeOuterRange, b -= shapeOuterRange;
-            r += shapeOuterRange, t += shapeOuterRange;
-            if (miterLimit > 0)
-                glyph->getShape().boundMiters(l, b, r, t, shapeOuterRange, miterLimit, 1);
-            l *= geometryScale, b *= geometryScale;
-            r *= geometryScale, t *= geometryScale;
-            maxBounds.l = std::min(maxBounds.l, l);
-            maxBounds.b = std::min(maxBounds.b, b);
-            maxBounds.r = std::max(maxBounds.r, r);
-            maxBounds.t = std::max(maxBounds.t, t);
-            maxWidth = std::max(maxWidth, r-l);
-            maxHeight = std::max(maxHeight, t-b);
-        }
+    for (const GlyphExtents &extents : glyphExtents) {
+        double geometryScale = extents.getGeometryScale();
+        double shapeOuterRange = outerRange/geometryScale;
+        geometryScale *= scale;
+        double l, b, r, t;
+        extents.getBounds(l, b, r, t, shapeOuterRange);
+        l *= geometryScale, b *= geometryScale;
+        r *= geometryScale, t *= geometryScale;
+        maxBounds.l = std::min(maxBounds.l, l);
+        maxBounds.b = std::min(maxBounds.b, b);
+        maxBounds.r = std::max(maxBounds.r, r);
+        maxBounds.t = std::max(maxBounds.t, t);
+        maxWidth = std::max(maxWidth, r-l);
+        maxHeight = std::max(maxHeight, t-b);
     }
     if (maxBounds.l >= maxBounds.r || maxBounds.b >= maxBounds.t)
         maxBounds = msdfgen::Shape::Bounds();
@@ -136,7 +218,7 @@ msdfgen::Shape::Bounds GridAtlasPacker::getMaxBounds(double &maxWidth, double &m
     return maxBounds;
 }
 
-double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const {
+double GridAtlasPacker::scaleToFit(const std::vector<GlyphExtents> &glyphExtents, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const {
     static const int BIG_VALUE = 1<<28;
     if (cellWidth <= 0)
         cellWidth = BIG_VALUE;
@@ -145,7 +227,7 @@ double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWid
     --cellWidth, --cellHeight; // Implicit half-pixel padding from each side to make sure that no representable values are beyond outermost pixel centers
     cellWidth -= spacing, cellHeight -= spacing;
     bool lastResult = false;
-    #define TRY_FIT(scale) (maxWidth = 0, maxHeight = 0, maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, (scale), -(unitRange.lower+pxRange.lower/(scale))), lastResult = maxWidth <= cellWidth && maxHeight <= cellHeight)
+    #define TRY_FIT(scale) (maxWidth = 0, maxHeight = 0, maxBounds = getMaxBounds(maxWidth, maxHeight, glyphExtents, (scale), -(unitRange.lower+pxRange.lower/(scale))), lastResult = maxWidth <= cellWidth && maxHeight <= cellHeight)
     double minScale = 1, maxScale = 1;
     if (TRY_FIT(1)) {
         while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_FIT(maxScale)))
@@ -168,9 +250,25 @@ double GridAtlasPacker::scaleToFit(GlyphGeometry *glyphs, int count, int cellWid
     return minScale;
 }
 
+int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+    // Precompute the bounds of each glyph as a function of range once, since they are needed for many different scales
+    std::vector<const GlyphGeometry *> nonWhitespaceGlyphs;
+    nonWhitespaceGlyphs.reserve(count);
+    for (const GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        if (!glyph->isWhitespace())
+            nonWhitespaceGlyphs.push_back(glyph);
+    }
+    std::vector<GlyphExtents> glyphExtents(nonWhitespaceGlyphs.size());
+    Workload([this, &glyphExtents, &nonWhitespaceGlyphs](int i, int) -> bool {
+        glyphExtents[i] = GlyphExtents(*nonWhitespaceGlyphs[i], miterLimit);
+        return true;
+    }, glyphExtents.size()).finish(threadCount);
+    return pack(glyphs, count, glyphExtents);
+}
+
 // Can this spaghetti code be simplified?
 // Idea: Maybe it could be rewritten into a while (not all properties deduced) cycle, and compute one value in each iteration
-int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count, const std::vector<GlyphExtents> &glyphExtents) {
     if (!count)
         return 0;
     GridAtlasPacker initial(*this);
@@ -223,49 +321,54 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
         if (pxRange.lower != pxRange.upper && miterLimit > 0) {
 
             if (cellWidth > 0 || cellHeight > 0) {
-                scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+                scale = scaleToFit(glyphExtents, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
                 if (scale < minScale) {
                     scale = minScale;
                     cutoff = true;
-                    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale, -(unitRange.lower+pxRange.lower/scale));
+                    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphExtents, scale, -(unitRange.lower+pxRange.lower/scale));
                 }
             }
 
             else if (width > 0 && height > 0) {
-                double bestAlignedScale = 0;
-                int bestCols = 0, bestAlignedCols = 0;
+                struct Candidate {
+                    int cols;
+                    int cellWidth, cellHeight;
+                    double scale;
+                };
+                std::vector<Candidate> candidates;
                 for (int q = (int) sqrt(cellCount)+1; q > 0; --q) {
                     int cols = q;
                     int rows = (cellCount+cols-1)/cols;
                     int tWidth = (width+spacing)/cols;
                     int tHeight = (height+spacing)/rows;
                     lowerToConstraint(tWidth, tHeight, cellDimensionsConstraint);
-                    if (tWidth > 0 && tHeight > 0) {
-                        double curScale = scaleToFit(glyphs, count, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
-                        if (curScale > scale) {
-                            scale = curScale;
-                            bestCols = cols;
-                        }
-                        if (cols*tWidth == width && curScale > bestAlignedScale) {
-                            bestAlignedScale = curScale;
-                            bestAlignedCols = cols;
-                        }
-                    }
+                    if (tWidth > 0 && tHeight > 0)
+                        candidates.push_back(Candidate { cols, tWidth, tHeight, 0 });
                     cols = (cellCount+q-1)/q;
                     rows = (cellCount+cols-1)/cols;
                     tWidth = (width+spacing)/cols;
                     tHeight = (height+spacing)/rows;
                     lowerToConstraint(tWidth, tHeight, cellDimensionsConstraint);
-                    if (tWidth > 0 && tHeight > 0) {
-                        double curScale = scaleToFit(glyphs, count, tWidth, tHeight, maxBounds, maxWidth, maxHeight);
-                        if (curScale > scale) {
-                            scale = curScale;
-                            bestCols = cols;
-                        }
-                        if (cols*tWidth == width && curScale > bestAlignedScale) {
-                            bestAlignedScale = curScale;
-                            bestAlignedCols = cols;
-                        }
+                    if (tWidth > 0 && tHeight > 0)
+                        candidates.push_back(Candidate { cols, tWidth, tHeight, 0 });
+                }
+                // Candidates are independent and each requires a full scale search, evaluate them in parallel
+                Workload([this, &candidates, &glyphExtents](int i, int) -> bool {
+                    msdfgen::Shape::Bounds candidateMaxBounds;
+                    double candidateMaxWidth, candidateMaxHeight;
+                    candidates[i].scale = scaleToFit(glyphExtents, candidates[i].cellWidth, candidates[i].cellHeight, candidateMaxBounds, candidateMaxWidth, candidateMaxHeight);
+                    return true;
+                }, candidates.size()).finish(threadCount);
+                double bestAlignedScale = 0;
+                int bestCols = 0, bestAlignedCols = 0;
+                for (const Candidate &candidate : candidates) {
+                    if (candidate.scale > scale) {
+                        scale = candidate.scale;
+                        bestCols = candidate.cols;
+                    }
+                    if (candidate.cols*candidate.cellWidth == width && candidate.scale > bestAlignedScale) {
+                        bestAlignedScale = candidate.scale;
+                        bestAlignedCols = candidate.cols;
                     }
                 }
                 if (!bestCols)
@@ -281,19 +384,19 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
                 cellWidth = (width+spacing)/columns;
                 cellHeight = (height+spacing)/rows;
                 lowerToConstraint(cellWidth, cellHeight, cellDimensionsConstraint);
-                scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+                scale = scaleToFit(glyphExtents, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
                 if (scale < minScale)
                     scale = -1;
             }
 
             if (scale <= 0) {
-                maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, minScale, -(unitRange.lower+pxRange.lower/minScale));
+                maxBounds = getMaxBounds(maxWidth, maxHeight, glyphExtents, minScale, -(unitRange.lower+pxRange.lower/minScale));
                 cellWidth = (int) ceil(maxWidth)+spacing+1;
                 cellHeight = (int) ceil(maxHeight)+spacing+1;
                 raiseToConstraint(cellWidth, cellHeight, cellDimensionsConstraint);
-                scale = scaleToFit(glyphs, count, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
+                scale = scaleToFit(glyphExtents, cellWidth, cellHeight, maxBounds, maxWidth, maxHeight);
                 if (scale < minScale)
-                    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale = minScale, -(unitRange.lower+pxRange.lower/minScale));
+                    maxBounds = getMaxBounds(maxWidth, maxHeight, glyphExtents, scale = minScale, -(unitRange.lower+pxRange.lower/minScale));
             }
 
             if (initial.rows < 0 && initial.cellHeight < 0) {
@@ -308,7 +411,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
         } else {
 
             Padding pxPadding = innerPxPadding+outerPxPadding;
-            maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, 1, -unitRange.lower);
+            maxBounds = getMaxBounds(maxWidth, maxHeight, glyphExtents, 1, -unitRange.lower);
             // Undo pxPadding added by getMaxBounds before pixel scale is known
             pad(maxBounds, -pxPadding);
             maxWidth -= pxPadding.l+pxPadding.r;
@@ -409,7 +512,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
         }
 
     } else {
-        maxBounds = getMaxBounds(maxWidth, maxHeight, glyphs, count, scale, -(unitRange.lower+pxRange.lower/scale));
+        maxBounds = getMaxBounds(maxWidth, maxHeight, glyphExtents, scale, -(unitRange.lower+pxRange.lower/scale));
         int optimalCellWidth = (int) ceil(maxWidth)+spacing+1;
         int optimalCellHeight = (int) ceil(maxHeight)+spacing+1;
         if (cellWidth < 0 || cellHeight < 0) {
@@ -472,7 +575,7 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
             columns = initial.columns;
             rows = initial.rows;
             scale = initial.scale;
-            return pack(glyphs, count);
+            return pack(glyphs, count, glyphExtents);
         }
     }
 
@@ -491,14 +594,21 @@ int GridAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
     attribs.miterLimit = miterLimit;
     attribs.pxAlignOriginX = pxAlignOriginX;
     attribs.pxAlignOriginY = pxAlignOriginY;
+    // Cells are assigned in order of descending glyph priority
+    std::vector<std::pair<double, int> > order(count);
+    for (int i = 0; i < count; ++i)
+        order[i] = std::make_pair(i < (int) glyphPriorities.size() ? -glyphPriorities[i] : 0., i);
+    if (!glyphPriorities.empty())
+        std::sort(order.begin(), order.end());
     int col = 0, row = 0;
-    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+    for (int i = 0; i < count; ++i) {
+        GlyphGeometry *glyph = glyphs+order[i].second;
         if (!glyph->isWhitespace()) {
             glyph->frameBox(attribs, cellWidth-spacing, cellHeight-spacing, hFixed ? &fixedX : nullptr, vFixed ? &fixedY : nullptr);
             glyph->placeBox(col*cellWidth, height-(row+1)*cellHeight);
             if (++col >= columns) {
                 if (++row >= rows) {
-                    return end-glyph-1;
+                    return count-i-1;
                 }
                 col = 0;
             }
@@ -600,6 +710,14 @@ void GridAtlasPacker::setOuterPixelPadding(const Padding &padding) {
     outerPxPadding = padding;
 }
 
+void GridAtlasPacker::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
+void GridAtlasPacker::setGlyphPriorities(const std::vector<double> &priorities) {
+    glyphPriorities = priorities;
+}
+
 void GridAtlasPacker::getDimensions(int &width, int &height) const {
     width = this->width, height = this->height;
 }
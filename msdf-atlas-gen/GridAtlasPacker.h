@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <vector>
 #include "Padding.h"
 #include "GlyphGeometry.h"
 
@@ -57,6 +58,10 @@ public:
     void setInnerPixelPadding(const Padding &padding);
     /// Sets the pixel component of width of additional padding around each glyph quad
     void setOuterPixelPadding(const Padding &padding);
+    /// Sets the number of threads to be used when evaluating candidate grid layouts
+    void setThreadCount(int threadCount);
+    /// Sets the packing priority of each glyph of the array passed to pack (e.g. its usage frequency), higher priority glyphs occupy the first grid cells
+    void setGlyphPriorities(const std::vector<double> &priorities);
 
     /// Outputs the atlas's final dimensions
     void getDimensions(int &width, int &height) const;
@@ -95,13 +100,18 @@ private:
     double scaleMaximizationTolerance;
     double alignedColumnsBias;
     bool cutoff;
+    int threadCount;
+    std::vector<double> glyphPriorities;
+
+    class GlyphExtents;
 
     static void lowerToConstraint(int &width, int &height, DimensionsConstraint constraint);
     static void raiseToConstraint(int &width, int &height, DimensionsConstraint constraint);
 
     double dimensionsRating(int width, int height, bool aligned) const;
-    msdfgen::Shape::Bounds getMaxBounds(double &maxWidth, double &maxHeight, GlyphGeometry *glyphs, int count, double scale, double outerRange) const;
-    double scaleToFit(GlyphGeometry *glyphs, int count, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const;
+    msdfgen::Shape::Bounds getMaxBounds(double &maxWidth, double &maxHeight, const std::vector<GlyphExtents> &glyphExtents, double scale, double outerRange) const;
+    double scaleToFit(const std::vector<GlyphExtents> &glyphExtents, int cellWidth, int cellHeight, msdfgen::Shape::Bounds &maxBounds, double &maxWidth, double &maxHeight) const;
+    int pack(GlyphGeometry *glyphs, int count, const std::vector<GlyphExtents> &glyphExtents);
 
 };
 
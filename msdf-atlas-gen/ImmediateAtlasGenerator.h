@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "GlyphBox.h"
+#include "GlyphProfile.h"
 #include "Workload.h"
 #include "AtlasGenerator.h"
 
@@ -29,18 +30,30 @@ public:
     void setAttributes(const GeneratorAttributes &attributes);
     /// Sets the number of threads to be run by generate
     void setThreadCount(int threadCount);
+    /// Sets the height of a single page of a multi-page atlas, whose pages are stacked vertically in the storage
+    void setPageHeight(int pageHeight);
+    /// Sets the number of channels of a channel-packed atlas, whose channels are generated as separate pages (layers) in the storage
+    void setPackedChannelCount(int channelCount);
+    /// Enables recording of the generation cost of each glyph by generate
+    void setProfiling(bool enabled);
     /// Allows access to the underlying AtlasStorage
     const AtlasStorage &atlasStorage() const;
     /// Returns the layout of the contained glyphs as a list of GlyphBoxes
     const std::vector<GlyphBox> &getLayout() const;
+    /// Returns the generation cost of each non-empty glyph generated by the last call to generate (if profiling is enabled)
+    const std::vector<GlyphProfile> &getGlyphProfile() const;
 
 private:
     AtlasStorage storage;
     std::vector<GlyphBox> layout;
+    std::vector<GlyphProfile> glyphProfile;
     std::vector<T> glyphBuffer;
     std::vector<byte> errorCorrectionBuffer;
     GeneratorAttributes attributes;
     int threadCount;
+    int pageHeight;
+    int packedChannelCount;
+    bool profiling;
 
 };
 
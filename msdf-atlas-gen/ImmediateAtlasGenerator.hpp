@@ -2,25 +2,28 @@
 #include "ImmediateAtlasGenerator.h"
 
 #include <algorithm>
+#include <chrono>
 
 namespace msdf_atlas {
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator() : threadCount(1), pageHeight(0), packedChannelCount(1), profiling(false) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height) : storage(width, height), threadCount(1), pageHeight(0), packedChannelCount(1), profiling(false) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 template <typename... ARGS>
-ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1) { }
+ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::ImmediateAtlasGenerator(int width, int height, ARGS... storageArgs) : storage(width, height, storageArgs...), threadCount(1), pageHeight(0), packedChannelCount(1), profiling(false) { }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGeometry *glyphs, int count) {
     int maxBoxArea = 0;
     for (int i = 0; i < count; ++i) {
         GlyphBox box = glyphs[i];
-        maxBoxArea = std::max(maxBoxArea, box.rect.w*box.rect.h);
+        int x, y, w, h;
+        glyphs[i].getMipBoxRect(attributes.mipLevel, x, y, w, h);
+        maxBoxArea = std::max(maxBoxArea, w*h);
         layout.push_back((GlyphBox &&) box);
     }
     int threadBufferSize = N*maxBoxArea;
@@ -33,18 +36,52 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::generate(const GlyphGe
         threadAttributes[i] = attributes;
         threadAttributes[i].config.errorCorrection.buffer = errorCorrectionBuffer.data()+i*maxBoxArea;
     }
+    glyphProfile.clear();
+    if (profiling)
+        glyphProfile.resize(count);
 
     Workload([this, glyphs, &threadAttributes, threadBufferSize](int i, int threadNo) -> bool {
         const GlyphGeometry &glyph = glyphs[i];
         if (!glyph.isWhitespace()) {
             int l, b, w, h;
-            glyph.getBoxRect(l, b, w, h);
+            glyph.getMipBoxRect(attributes.mipLevel, l, b, w, h);
+            // Boxes expanded in a reduced mipmap level must not overflow into the next page
+            if (pageHeight > 0)
+                h = std::min(h, pageHeight-b);
+            if (!(w > 0 && h > 0))
+                return true;
+            b += pageHeight*(packedChannelCount*glyph.getBoxPage()+glyph.getBoxChannel());
+            if (attributes.skipBoxBorder) {
+                // Border pixels are left blank, which is also what they would be generated as
+                ++l, ++b;
+                w -= 2, h -= 2;
+                if (!(w > 0 && h > 0))
+                    return true;
+            }
             msdfgen::BitmapRef<T, N> glyphBitmap(glyphBuffer.data()+threadNo*threadBufferSize, w, h);
-            GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
+            if (profiling) {
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
+                GlyphProfile &profile = glyphProfile[i];
+                profile.time = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+                profile.index = glyph.getIndex();
+                profile.codepoint = glyph.getCodepoint();
+                profile.contourCount = (int) glyph.getShape().contours.size();
+                profile.edgeCount = glyph.getShape().edgeCount();
+                profile.boxArea = w*h;
+                profile.scanlinePass = attributes.scanlinePass;
+                // Only multi-channel generators perform error correction
+                profile.errorCorrection = N >= 3 && attributes.config.errorCorrection.mode != msdfgen::ErrorCorrectionConfig::DISABLED;
+            } else
+                GEN_FN(glyphBitmap, glyph, threadAttributes[threadNo]);
             storage.put(l, b, msdfgen::BitmapConstRef<T, N>(glyphBitmap));
         }
         return true;
     }, count).finish(threadCount);
+    // Whitespace and empty glyphs have no profile
+    glyphProfile.erase(std::remove_if(glyphProfile.begin(), glyphProfile.end(), [](const GlyphProfile &profile) -> bool {
+        return !profile.boxArea;
+    }), glyphProfile.end());
 }
 
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
@@ -73,6 +110,21 @@ void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setThreadCount(int thr
     this->threadCount = threadCount;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setPageHeight(int pageHeight) {
+    this->pageHeight = pageHeight;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setPackedChannelCount(int channelCount) {
+    packedChannelCount = channelCount;
+}
+
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+void ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::setProfiling(bool enabled) {
+    profiling = enabled;
+}
+
 template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
 const AtlasStorage &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::atlasStorage() const {
     return storage;
@@ -83,4 +135,9 @@ const std::vector<GlyphBox> &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>
     return layout;
 }
 
+template <typename T, int N, GeneratorFunction<T, N> GEN_FN, class AtlasStorage>
+const std::vector<GlyphProfile> &ImmediateAtlasGenerator<T, N, GEN_FN, AtlasStorage>::getGlyphProfile() const {
+    return glyphProfile;
+}
+
 }
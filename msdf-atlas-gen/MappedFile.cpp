@@ -0,0 +1,133 @@
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace msdf_atlas {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : mapping(nullptr), length(0), fileHandle(nullptr), mappingHandle(nullptr) { }
+
+MappedFile::MappedFile(MappedFile &&orig) : mapping(orig.mapping), length(orig.length), fileHandle(orig.fileHandle), mappingHandle(orig.mappingHandle) {
+    orig.mapping = nullptr, orig.length = 0;
+    orig.fileHandle = nullptr, orig.mappingHandle = nullptr;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&orig) {
+    if (this != &orig) {
+        close();
+        mapping = orig.mapping, length = orig.length;
+        fileHandle = orig.fileHandle, mappingHandle = orig.mappingHandle;
+        orig.mapping = nullptr, orig.length = 0;
+        orig.fileHandle = nullptr, orig.mappingHandle = nullptr;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const char *filename) {
+    close();
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0 && (unsigned long long) fileSize.QuadPart <= (size_t) -1) {
+        if (HANDLE fileMapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL)) {
+            if (const void *view = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0)) {
+                mapping = reinterpret_cast<const byte *>(view);
+                length = (size_t) fileSize.QuadPart;
+                fileHandle = file;
+                mappingHandle = fileMapping;
+                return true;
+            }
+            CloseHandle(fileMapping);
+        }
+    }
+    CloseHandle(file);
+    return false;
+}
+
+void MappedFile::close() {
+    if (mapping)
+        UnmapViewOfFile(mapping);
+    if (mappingHandle)
+        CloseHandle(mappingHandle);
+    if (fileHandle)
+        CloseHandle(fileHandle);
+    mapping = nullptr, length = 0;
+    fileHandle = nullptr, mappingHandle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile() : mapping(nullptr), length(0) { }
+
+MappedFile::MappedFile(MappedFile &&orig) : mapping(orig.mapping), length(orig.length) {
+    orig.mapping = nullptr, orig.length = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&orig) {
+    if (this != &orig) {
+        close();
+        mapping = orig.mapping, length = orig.length;
+        orig.mapping = nullptr, orig.length = 0;
+    }
+    return *this;
+}
+
+bool MappedFile::open(const char *filename) {
+    close();
+    int fd = ::open(filename, O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStat;
+    if (!fstat(fd, &fileStat) && fileStat.st_size > 0) {
+        void *view = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (view != MAP_FAILED) {
+            mapping = reinterpret_cast<const byte *>(view);
+            length = (size_t) fileStat.st_size;
+        }
+    }
+    // The mapping remains valid after the file descriptor is closed
+    ::close(fd);
+    return mapping != nullptr;
+}
+
+void MappedFile::close() {
+    if (mapping)
+        munmap(const_cast<byte *>(mapping), length);
+    mapping = nullptr, length = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::isOpen() const {
+    return mapping != nullptr;
+}
+
+const byte *MappedFile::data() const {
+    return mapping;
+}
+
+size_t MappedFile::size() const {
+    return length;
+}
+
+}
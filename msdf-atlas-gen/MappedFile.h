@@ -0,0 +1,41 @@
+
+#pragma once
+
+#include <cstddef>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// Read-only memory mapping of a file's contents, which may be shared by multiple consumers (e.g. font faces on different threads)
+class MappedFile {
+
+public:
+    MappedFile();
+    MappedFile(MappedFile &&orig);
+    ~MappedFile();
+    MappedFile &operator=(MappedFile &&orig);
+    /// Maps the file into memory, returns false on failure
+    bool open(const char *filename);
+    /// Unmaps the file
+    void close();
+    /// Returns true if a file is currently mapped
+    bool isOpen() const;
+    /// Returns the mapped contents of the file
+    const byte *data() const;
+    /// Returns the size of the file in bytes
+    size_t size() const;
+
+private:
+    const byte *mapping;
+    size_t length;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+
+    MappedFile(const MappedFile &);
+    MappedFile &operator=(const MappedFile &);
+
+};
+
+}
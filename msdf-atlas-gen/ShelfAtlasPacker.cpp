@@ -0,0 +1,278 @@
+
+#include "ShelfAtlasPacker.h"
+
+#include <cmath>
+#include <algorithm>
+#include "ShelfPacker.h"
+#include "size-selectors.h"
+
+namespace msdf_atlas {
+
+template <class SizeSelector>
+static bool packShelves(std::vector<Rectangle> &rectangles, int totalArea, int spacing, int &width, int &height, int &shelfCount) {
+    std::vector<Rectangle> rectanglesCopy(rectangles);
+    bool success = false;
+    SizeSelector sizeSelector(totalArea);
+    int w, h;
+    while (sizeSelector(w, h)) {
+        ShelfPacker packer(w+spacing, h+spacing);
+        if (!packer.pack(rectanglesCopy.data(), rectanglesCopy.size())) {
+            width = w, height = h;
+            shelfCount = packer.getShelfCount();
+            rectangles = rectanglesCopy;
+            success = true;
+            --sizeSelector;
+        } else
+            ++sizeSelector;
+    }
+    return success;
+}
+
+ShelfAtlasPacker::ShelfAtlasPacker() :
+    width(-1), height(-1),
+    spacing(0),
+    dimensionsConstraint(DimensionsConstraint::POWER_OF_TWO_SQUARE),
+    scale(-1),
+    minScale(1),
+    unitRange(0),
+    pxRange(0),
+    miterLimit(0),
+    pxAlignOriginX(false), pxAlignOriginY(false),
+    scaleMaximizationTolerance(.001),
+    shelfHeight(0),
+    shelfCount(0),
+    fixedY(0),
+    packAttempts(0)
+{ }
+
+int ShelfAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) {
+    ++packAttempts;
+    GlyphGeometry::GlyphAttributes attribs = { };
+    attribs.scale = scale;
+    attribs.range = unitRange+pxRange/scale;
+    attribs.innerPadding = innerUnitPadding+innerPxPadding/scale;
+    attribs.outerPadding = outerUnitPadding+outerPxPadding/scale;
+    attribs.miterLimit = miterLimit;
+    attribs.pxAlignOriginX = pxAlignOriginX;
+    attribs.pxAlignOriginY = pxAlignOriginY;
+    // Wrap glyphs into boxes and find the vertical extent of all boxes relative to the baseline
+    std::vector<Rectangle> rectangles;
+    std::vector<GlyphGeometry *> rectangleGlyphs;
+    rectangles.reserve(count);
+    rectangleGlyphs.reserve(count);
+    double minBottom = 0, maxTop = 0;
+    for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        glyph->setBoxPage(0);
+        glyph->setBoxChannel(0);
+        if (!glyph->isWhitespace()) {
+            Rectangle rect = { };
+            glyph->wrapBox(attribs);
+            glyph->getBoxSize(rect.w, rect.h);
+            if (rect.w > 0 && rect.h > 0) {
+                double bottom = -glyph->getBoxScale()*glyph->getBoxTranslate().y;
+                if (rectangles.empty())
+                    minBottom = bottom, maxTop = bottom+rect.h;
+                else {
+                    minBottom = std::min(minBottom, bottom);
+                    maxTop = std::max(maxTop, bottom+rect.h);
+                }
+                rectangles.push_back(rect);
+                rectangleGlyphs.push_back(glyph);
+            }
+        }
+    }
+    // No non-zero size boxes?
+    if (rectangles.empty()) {
+        if (width < 0 || height < 0)
+            width = 0, height = 0;
+        shelfHeight = 0, shelfCount = 0, fixedY = 0;
+        return 0;
+    }
+    // Common shelf height and baseline position
+    int boxHeight;
+    double originY;
+    if (pxAlignOriginY) {
+        boxHeight = (int) round(maxTop-minBottom);
+        originY = round(-minBottom);
+    } else {
+        boxHeight = (int) ceil(maxTop-minBottom);
+        originY = -minBottom+.5*(boxHeight-(maxTop-minBottom));
+    }
+    int totalArea = 0;
+    for (Rectangle &rect : rectangles) {
+        totalArea += rect.w*boxHeight;
+        rect.w += spacing;
+        rect.h = boxHeight+spacing;
+    }
+    // Shelf packing
+    int packedShelfCount = 0;
+    if (width < 0 || height < 0) {
+        bool success = false;
+        switch (dimensionsConstraint) {
+            case DimensionsConstraint::POWER_OF_TWO_SQUARE:
+                success = packShelves<SquarePowerOfTwoSizeSelector>(rectangles, totalArea, spacing, width, height, packedShelfCount);
+                break;
+            case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+                success = packShelves<PowerOfTwoSizeSelector>(rectangles, totalArea, spacing, width, height, packedShelfCount);
+                break;
+            case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
+                success = packShelves<SquareSizeSelector<4> >(rectangles, totalArea, spacing, width, height, packedShelfCount);
+                break;
+            case DimensionsConstraint::EVEN_SQUARE:
+                success = packShelves<SquareSizeSelector<2> >(rectangles, totalArea, spacing, width, height, packedShelfCount);
+                break;
+            case DimensionsConstraint::SQUARE:
+            default:
+                success = packShelves<SquareSizeSelector<> >(rectangles, totalArea, spacing, width, height, packedShelfCount);
+                break;
+        }
+        if (!success)
+            return -1;
+    } else {
+        ShelfPacker packer(width+spacing, height+spacing);
+        if (int result = packer.pack(rectangles.data(), rectangles.size()))
+            return result;
+        packedShelfCount = packer.getShelfCount();
+    }
+    // Set glyph box placement
+    double shelfFixedY = originY/scale;
+    for (size_t i = 0; i < rectangles.size(); ++i) {
+        rectangleGlyphs[i]->frameBox(attribs, rectangles[i].w-spacing, boxHeight, nullptr, &shelfFixedY);
+        rectangleGlyphs[i]->placeBox(rectangles[i].x, height-(rectangles[i].y+boxHeight));
+    }
+    shelfHeight = boxHeight;
+    shelfCount = packedShelfCount;
+    fixedY = shelfFixedY;
+    return 0;
+}
+
+double ShelfAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) {
+    bool lastResult = false;
+    int w = width, h = height;
+    #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), w, h, (scale)))
+    double minScale = 1, maxScale = 1;
+    if (TRY_PACK(1)) {
+        while (maxScale < 1e+32 && ((maxScale = 2*minScale), TRY_PACK(maxScale)))
+            minScale = maxScale;
+    } else {
+        while (minScale > 1e-32 && ((minScale = .5*maxScale), !TRY_PACK(minScale)))
+            maxScale = minScale;
+    }
+    if (minScale == maxScale)
+        return 0;
+    while (minScale/maxScale < 1-scaleMaximizationTolerance) {
+        double midScale = .5*(minScale+maxScale);
+        if (TRY_PACK(midScale))
+            minScale = midScale;
+        else
+            maxScale = midScale;
+    }
+    if (!lastResult)
+        TRY_PACK(minScale);
+    return minScale;
+}
+
+int ShelfAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+    packAttempts = 0;
+    double initialScale = scale > 0 ? scale : minScale;
+    if (initialScale > 0) {
+        if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, initialScale))
+            return remaining;
+    } else if (width < 0 || height < 0)
+        return -1;
+    if (scale <= 0)
+        scale = packAndScale(glyphs, count);
+    if (scale <= 0)
+        return -1;
+    return 0;
+}
+
+void ShelfAtlasPacker::setDimensions(int width, int height) {
+    this->width = width, this->height = height;
+}
+
+void ShelfAtlasPacker::unsetDimensions() {
+    width = -1, height = -1;
+}
+
+void ShelfAtlasPacker::setDimensionsConstraint(DimensionsConstraint dimensionsConstraint) {
+    this->dimensionsConstraint = dimensionsConstraint;
+}
+
+void ShelfAtlasPacker::setSpacing(int spacing) {
+    this->spacing = spacing;
+}
+
+void ShelfAtlasPacker::setScale(double scale) {
+    this->scale = scale;
+}
+
+void ShelfAtlasPacker::setMinimumScale(double minScale) {
+    this->minScale = minScale;
+}
+
+void ShelfAtlasPacker::setUnitRange(msdfgen::Range unitRange) {
+    this->unitRange = unitRange;
+}
+
+void ShelfAtlasPacker::setPixelRange(msdfgen::Range pxRange) {
+    this->pxRange = pxRange;
+}
+
+void ShelfAtlasPacker::setMiterLimit(double miterLimit) {
+    this->miterLimit = miterLimit;
+}
+
+void ShelfAtlasPacker::setOriginPixelAlignment(bool align) {
+    pxAlignOriginX = align, pxAlignOriginY = align;
+}
+
+void ShelfAtlasPacker::setOriginPixelAlignment(bool alignX, bool alignY) {
+    pxAlignOriginX = alignX, pxAlignOriginY = alignY;
+}
+
+void ShelfAtlasPacker::setInnerUnitPadding(const Padding &padding) {
+    innerUnitPadding = padding;
+}
+
+void ShelfAtlasPacker::setOuterUnitPadding(const Padding &padding) {
+    outerUnitPadding = padding;
+}
+
+void ShelfAtlasPacker::setInnerPixelPadding(const Padding &padding) {
+    innerPxPadding = padding;
+}
+
+void ShelfAtlasPacker::setOuterPixelPadding(const Padding &padding) {
+    outerPxPadding = padding;
+}
+
+void ShelfAtlasPacker::getDimensions(int &width, int &height) const {
+    width = this->width, height = this->height;
+}
+
+int ShelfAtlasPacker::getShelfHeight() const {
+    return shelfHeight;
+}
+
+int ShelfAtlasPacker::getShelfCount() const {
+    return shelfCount;
+}
+
+double ShelfAtlasPacker::getScale() const {
+    return scale;
+}
+
+msdfgen::Range ShelfAtlasPacker::getPixelRange() const {
+    return pxRange+scale*unitRange;
+}
+
+double ShelfAtlasPacker::getOriginY() const {
+    return fixedY-.5/scale;
+}
+
+int ShelfAtlasPacker::getPackAttempts() const {
+    return packAttempts;
+}
+
+}
@@ -0,0 +1,91 @@
+
+#include "ShelfPacker.h"
+
+#include <algorithm>
+
+namespace msdf_atlas {
+
+ShelfPacker::ShelfPacker() : width(0), height(0), usedHeight(0) { }
+
+ShelfPacker::ShelfPacker(int width, int height) : width(width), height(height), usedHeight(0) { }
+
+void ShelfPacker::expand(int width, int height) {
+    if (width > this->width) {
+        // Widening the bin adds the same free width to every shelf
+        openShelves.clear();
+        for (int i = 0; i < (int) shelves.size(); ++i)
+            openShelves[shelves[i].h].insert(std::make_pair(width-shelves[i].usedWidth, i));
+        this->width = width;
+    }
+    if (height > this->height)
+        this->height = height;
+}
+
+int ShelfPacker::findShelf(int w, int h, int maxShelfHeight) const {
+    for (std::map<int, std::set<std::pair<int, int> > >::const_iterator it = openShelves.lower_bound(h); it != openShelves.end() && it->first <= maxShelfHeight; ++it) {
+        // Best fit - the shelf with the least free width that can still hold the rectangle
+        std::set<std::pair<int, int> >::const_iterator fit = it->second.lower_bound(std::make_pair(w, -1));
+        if (fit != it->second.end())
+            return fit->second;
+    }
+    return -1;
+}
+
+int ShelfPacker::openShelf(int h) {
+    if (usedHeight+h > height)
+        return -1;
+    Shelf shelf = { usedHeight, h, 0 };
+    usedHeight += h;
+    shelves.push_back(shelf);
+    openShelves[h].insert(std::make_pair(width, (int) shelves.size()-1));
+    return (int) shelves.size()-1;
+}
+
+void ShelfPacker::insert(Rectangle &rect, int shelfIndex) {
+    Shelf &shelf = shelves[shelfIndex];
+    std::set<std::pair<int, int> > &heightClass = openShelves[shelf.h];
+    heightClass.erase(std::make_pair(width-shelf.usedWidth, shelfIndex));
+    rect.x = shelf.usedWidth;
+    rect.y = shelf.y;
+    shelf.usedWidth += rect.w;
+    if (shelf.usedWidth < width)
+        heightClass.insert(std::make_pair(width-shelf.usedWidth, shelfIndex));
+    else if (heightClass.empty())
+        openShelves.erase(shelf.h);
+}
+
+int ShelfPacker::pack(Rectangle *rectangles, int count) {
+    // Tallest first, then widest first, so that each shelf's height is set by its tallest member
+    std::vector<int> order(count);
+    for (int i = 0; i < count; ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [rectangles](int a, int b) {
+        return rectangles[a].h > rectangles[b].h || (rectangles[a].h == rectangles[b].h && rectangles[a].w > rectangles[b].w);
+    });
+    int remaining = 0;
+    for (int i : order) {
+        Rectangle &rect = rectangles[i];
+        if (rect.w > width) {
+            ++remaining;
+            continue;
+        }
+        // Prefer shelves not much taller than the rectangle, then a new shelf, then any taller shelf
+        int shelfIndex = findShelf(rect.w, rect.h, rect.h+(rect.h>>2));
+        if (shelfIndex < 0)
+            shelfIndex = openShelf(rect.h);
+        if (shelfIndex < 0)
+            shelfIndex = findShelf(rect.w, rect.h, height);
+        if (shelfIndex < 0) {
+            ++remaining;
+            continue;
+        }
+        insert(rect, shelfIndex);
+    }
+    return remaining;
+}
+
+int ShelfPacker::getShelfCount() const {
+    return (int) shelves.size();
+}
+
+}
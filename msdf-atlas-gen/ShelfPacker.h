@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <vector>
+#include <map>
+#include <set>
+#include "Rectangle.h"
+
+namespace msdf_atlas {
+
+/// Shelf 2D single bin packer - rectangles are placed left to right into rows, each as tall as the first rectangle placed into it
+class ShelfPacker {
+
+public:
+    ShelfPacker();
+    ShelfPacker(int width, int height);
+    /// Expands the packing area - both width and height must be greater or equal to the previous value
+    void expand(int width, int height);
+    /// Packs the rectangle array, returns how many didn't fit (0 on success)
+    int pack(Rectangle *rectangles, int count);
+    /// Returns the number of shelves opened so far
+    int getShelfCount() const;
+
+private:
+    struct Shelf {
+        int y, h;
+        int usedWidth;
+    };
+
+    int width, height;
+    int usedHeight;
+    std::vector<Shelf> shelves;
+    /// Shelves with remaining space, grouped by height and keyed by (free width, shelf index)
+    std::map<int, std::set<std::pair<int, int> > > openShelves;
+
+    int findShelf(int w, int h, int maxShelfHeight) const;
+    int openShelf(int h);
+    void insert(Rectangle &rect, int shelfIndex);
+
+};
+
+}
@@ -0,0 +1,179 @@
+
+#include "Statistics.h"
+
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+    #include <sys/stat.h>
+#endif
+
+#define MAX_HISTOGRAM_BUCKETS 48
+
+namespace msdf_atlas {
+
+/// Returns the processor time consumed by all threads of the process in seconds
+static double processCpuTime() {
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+        return 0;
+    unsigned long long kernel = (unsigned long long) kernelTime.dwHighDateTime<<32|kernelTime.dwLowDateTime;
+    unsigned long long user = (unsigned long long) userTime.dwHighDateTime<<32|userTime.dwLowDateTime;
+    return 1e-7*double(kernel+user);
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+    return double(usage.ru_utime.tv_sec+usage.ru_stime.tv_sec)+1e-6*double(usage.ru_utime.tv_usec+usage.ru_stime.tv_usec);
+#endif
+}
+
+/// Returns the peak resident set size of the process in bytes, or 0 if unavailable
+static unsigned long long peakResidentSetSize() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+    #ifdef __APPLE__
+        return (unsigned long long) usage.ru_maxrss;
+    #else
+        return 1024ull*usage.ru_maxrss;
+    #endif
+#endif
+}
+
+static unsigned long long fileSize(const char *filename) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(filename, GetFileExInfoStandard, &attributes))
+        return 0;
+    return (unsigned long long) attributes.nFileSizeHigh<<32|attributes.nFileSizeLow;
+#else
+    struct stat fileStat;
+    if (stat(filename, &fileStat))
+        return 0;
+    return (unsigned long long) fileStat.st_size;
+#endif
+}
+
+static double secondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double>(end-start).count();
+}
+
+Statistics::Statistics() : stageRunning(false), startWallTime(std::chrono::steady_clock::now()), stageWallTime(startWallTime), startCpuTime(processCpuTime()), stageCpuTime(startCpuTime), bytesWritten(0), packAttempts(0), atlasMetrics(), threadCount(0), glyphsProfiled(false), profiledGlyphCount(0), glyphGenerationTime(0) { }
+
+void Statistics::beginStage(const char *name) {
+    endStage();
+    Stage stage = { name, 0, 0, 0 };
+    stages.push_back(stage);
+    stageRunning = true;
+    stageWallTime = std::chrono::steady_clock::now();
+    stageCpuTime = processCpuTime();
+}
+
+void Statistics::endStage() {
+    if (stageRunning) {
+        Stage &stage = stages.back();
+        stage.wallTime = secondsBetween(stageWallTime, std::chrono::steady_clock::now());
+        stage.cpuTime = processCpuTime()-stageCpuTime;
+        stageRunning = false;
+    }
+}
+
+void Statistics::addOutputFile(const char *filename) {
+    unsigned long long size = fileSize(filename);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (stageRunning)
+        stages.back().bytesWritten += size;
+    bytesWritten += size;
+}
+
+void Statistics::setPackAttempts(int attempts) {
+    packAttempts = attempts;
+}
+
+void Statistics::setAtlasMetrics(const AtlasMetrics &metrics) {
+    atlasMetrics = metrics;
+}
+
+void Statistics::setThreadCount(int threadCount) {
+    this->threadCount = threadCount;
+}
+
+void Statistics::setGlyphProfile(const GlyphProfile *profiles, int count, int topCount) {
+    glyphsProfiled = true;
+    profiledGlyphCount = count;
+    glyphGenerationTime = 0;
+    glyphTimeHistogram.clear();
+    for (int i = 0; i < count; ++i) {
+        glyphGenerationTime += profiles[i].time;
+        // Bucket k holds times from 2^(k-1) up to 2^k microseconds, bucket 0 everything below 1 microsecond
+        int bucket = 0;
+        double microseconds = 1e6*profiles[i].time;
+        if (microseconds >= 1)
+            frexp(microseconds, &bucket);
+        bucket = std::min(bucket, MAX_HISTOGRAM_BUCKETS-1);
+        if (bucket >= (int) glyphTimeHistogram.size())
+            glyphTimeHistogram.resize(bucket+1);
+        ++glyphTimeHistogram[bucket];
+    }
+    topCount = std::max(std::min(topCount, count), 0);
+    slowestGlyphs.assign(profiles, profiles+count);
+    std::partial_sort(slowestGlyphs.begin(), slowestGlyphs.begin()+topCount, slowestGlyphs.end(), [](const GlyphProfile &a, const GlyphProfile &b) -> bool {
+        return a.time > b.time;
+    });
+    slowestGlyphs.resize(topCount);
+}
+
+bool Statistics::exportJSON(const char *filename) const {
+    double totalWallTime = secondsBetween(startWallTime, std::chrono::steady_clock::now());
+    double totalCpuTime = processCpuTime()-startCpuTime;
+    FILE *f = fopen(filename, "w");
+    if (!f)
+        return false;
+    fprintf(f, "{\"threads\":%d,\"wallTime\":%.6f,\"cpuTime\":%.6f,\"peakRss\":%llu,\"bytesWritten\":%llu,", threadCount, totalWallTime, totalCpuTime, peakResidentSetSize(), bytesWritten);
+    fputs("\"stages\":[", f);
+    for (size_t i = 0; i < stages.size(); ++i) {
+        const Stage &stage = stages[i];
+        fprintf(f, "%s{\"name\":\"%s\",\"wallTime\":%.6f,\"cpuTime\":%.6f,\"bytesWritten\":%llu}", i ? "," : "", stage.name.c_str(), stage.wallTime, stage.cpuTime, stage.bytesWritten);
+    }
+    fputs("],", f);
+    // Not all packing styles count their attempts
+    if (packAttempts > 0)
+        fprintf(f, "\"packAttempts\":%d,", packAttempts);
+    else
+        fputs("\"packAttempts\":null,", f);
+    long long atlasArea = (long long) atlasMetrics.width*atlasMetrics.height*atlasMetrics.pages*atlasMetrics.packedChannels;
+    fprintf(f, "\"atlas\":{\"width\":%d,\"height\":%d,\"pages\":%d,\"packedChannels\":%d,\"glyphArea\":%lld,\"occupancy\":%.6f}", atlasMetrics.width, atlasMetrics.height, atlasMetrics.pages, atlasMetrics.packedChannels, atlasMetrics.glyphArea, atlasArea > 0 ? double(atlasMetrics.glyphArea)/double(atlasArea) : 0.);
+    if (glyphsProfiled) {
+        fprintf(f, ",\"glyphs\":{\"count\":%d,\"generationTime\":%.6f,\"slowest\":[", profiledGlyphCount, glyphGenerationTime);
+        for (size_t i = 0; i < slowestGlyphs.size(); ++i) {
+            const GlyphProfile &glyph = slowestGlyphs[i];
+            fprintf(f, "%s{\"index\":%d,\"unicode\":%u,\"time\":%.6f,\"contours\":%d,\"edges\":%d,\"boxArea\":%d,\"scanlinePass\":%s,\"errorCorrection\":%s}", i ? "," : "", glyph.index, glyph.codepoint, glyph.time, glyph.contourCount, glyph.edgeCount, glyph.boxArea, glyph.scanlinePass ? "true" : "false", glyph.errorCorrection ? "true" : "false");
+        }
+        fputs("],\"timeHistogram\":[", f);
+        for (size_t i = 0; i < glyphTimeHistogram.size(); ++i)
+            fprintf(f, "%s{\"upTo\":%.6g,\"glyphs\":%d}", i ? "," : "", 1e-6*ldexp(1, (int) i), glyphTimeHistogram[i]);
+        fputs("]}", f);
+    }
+    fputs("}\n", f);
+    return !fclose(f);
+}
+
+}
@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include "GlyphProfile.h"
+
+namespace msdf_atlas {
+
+/// Records the wall-clock and processor time of successive stages of atlas generation, the sizes of output files and peak memory usage
+class Statistics {
+
+public:
+    /// Atlas layout figures included in the report
+    struct AtlasMetrics {
+        int width, height;
+        int pages;
+        int packedChannels;
+        /// Total area of all glyph boxes in pixels
+        long long glyphArea;
+    };
+
+    Statistics();
+    /// Ends the current stage (if any) and starts measuring a new one
+    void beginStage(const char *name);
+    /// Ends the current stage
+    void endStage();
+    /// Adds the size of an output file to the bytes written within the current stage, may be called from multiple threads
+    void addOutputFile(const char *filename);
+    /// Sets the number of layouts tried by the packer
+    void setPackAttempts(int attempts);
+    void setAtlasMetrics(const AtlasMetrics &metrics);
+    void setThreadCount(int threadCount);
+    /// Summarizes per-glyph generation costs into a histogram of generation times and a list of the topCount slowest glyphs
+    void setGlyphProfile(const GlyphProfile *profiles, int count, int topCount);
+    /// Writes the report into a JSON file
+    bool exportJSON(const char *filename) const;
+
+private:
+    struct Stage {
+        std::string name;
+        double wallTime, cpuTime;
+        unsigned long long bytesWritten;
+    };
+
+    std::vector<Stage> stages;
+    bool stageRunning;
+    std::chrono::steady_clock::time_point startWallTime, stageWallTime;
+    double startCpuTime, stageCpuTime;
+    unsigned long long bytesWritten;
+    int packAttempts;
+    AtlasMetrics atlasMetrics;
+    int threadCount;
+    bool glyphsProfiled;
+    int profiledGlyphCount;
+    double glyphGenerationTime;
+    std::vector<GlyphProfile> slowestGlyphs;
+    /// Number of glyphs whose generation time falls into each power-of-two range of microseconds
+    std::vector<int> glyphTimeHistogram;
+    std::mutex mutex;
+
+    Statistics(const Statistics &);
+    Statistics &operator=(const Statistics &);
+
+};
+
+}
@@ -1,8 +1,7 @@
 
 #include "TightAtlasPacker.h"
 
-#include <vector>
-#include "Rectangle.h"
+#include <algorithm>
 #include "rectangle-packing.h"
 #include "size-selectors.h"
 
@@ -18,13 +17,14 @@ TightAtlasPacker::TightAtlasPacker() :
     pxRange(0),
     miterLimit(0),
     pxAlignOriginX(false), pxAlignOriginY(false),
-    scaleMaximizationTolerance(.001)
+    scaleMaximizationTolerance(.001),
+    multiPage(false),
+    packedChannelCount(1),
+    pageCount(1),
+    packAttempts(0)
 { }
 
-int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const {
-    // Wrap glyphs into boxes
-    std::vector<Rectangle> rectangles;
-    std::vector<GlyphGeometry *> rectangleGlyphs;
+void TightAtlasPacker::wrapBoxes(std::vector<Rectangle> &rectangles, std::vector<GlyphGeometry *> &rectangleGlyphs, GlyphGeometry *glyphs, int count, double scale) const {
     rectangles.reserve(count);
     rectangleGlyphs.reserve(count);
     GlyphGeometry::GlyphAttributes attribs = { };
@@ -36,6 +36,8 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
     attribs.pxAlignOriginX = pxAlignOriginX;
     attribs.pxAlignOriginY = pxAlignOriginY;
     for (GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph) {
+        glyph->setBoxPage(0);
+        glyph->setBoxChannel(0);
         if (!glyph->isWhitespace()) {
             Rectangle rect = { };
             glyph->wrapBox(attribs);
@@ -46,38 +48,66 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
             }
         }
     }
+    // Sort boxes by descending glyph priority
+    if (!glyphPriorities.empty()) {
+        std::vector<std::pair<double, size_t> > order(rectangles.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            size_t glyphIndex = rectangleGlyphs[i]-glyphs;
+            order[i] = std::make_pair(glyphIndex < glyphPriorities.size() ? -glyphPriorities[glyphIndex] : 0., i);
+        }
+        std::sort(order.begin(), order.end());
+        std::vector<Rectangle> sortedRectangles(rectangles.size());
+        std::vector<GlyphGeometry *> sortedRectangleGlyphs(rectangleGlyphs.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            sortedRectangles[i] = rectangles[order[i].second];
+            sortedRectangleGlyphs[i] = rectangleGlyphs[order[i].second];
+        }
+        rectangles.swap(sortedRectangles);
+        rectangleGlyphs.swap(sortedRectangleGlyphs);
+    }
+}
+
+int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) {
+    ++packAttempts;
+    // Wrap glyphs into boxes
+    std::vector<Rectangle> rectangles;
+    std::vector<GlyphGeometry *> rectangleGlyphs;
+    wrapBoxes(rectangles, rectangleGlyphs, glyphs, count, scale);
     // No non-zero size boxes?
     if (rectangles.empty()) {
         if (width < 0 || height < 0)
             width = 0, height = 0;
         return 0;
     }
+    if (multiPage || packedChannelCount > 1)
+        return tryPackLayered(rectangles, rectangleGlyphs, dimensionsConstraint, width, height);
+    bool ordered = !glyphPriorities.empty();
     // Box rectangle packing
     if (width < 0 || height < 0) {
         std::pair<int, int> dimensions = std::make_pair(width, height);
         switch (dimensionsConstraint) {
             case DimensionsConstraint::POWER_OF_TWO_SQUARE:
-                dimensions = packRectangles<SquarePowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
+                dimensions = packRectangles<SquarePowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing, ordered);
                 break;
             case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
-                dimensions = packRectangles<PowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing);
+                dimensions = packRectangles<PowerOfTwoSizeSelector>(rectangles.data(), rectangles.size(), spacing, ordered);
                 break;
             case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
-                dimensions = packRectangles<SquareSizeSelector<4> >(rectangles.data(), rectangles.size(), spacing);
+                dimensions = packRectangles<SquareSizeSelector<4> >(rectangles.data(), rectangles.size(), spacing, ordered);
                 break;
             case DimensionsConstraint::EVEN_SQUARE:
-                dimensions = packRectangles<SquareSizeSelector<2> >(rectangles.data(), rectangles.size(), spacing);
+                dimensions = packRectangles<SquareSizeSelector<2> >(rectangles.data(), rectangles.size(), spacing, ordered);
                 break;
             case DimensionsConstraint::SQUARE:
             default:
-                dimensions = packRectangles<SquareSizeSelector<> >(rectangles.data(), rectangles.size(), spacing);
+                dimensions = packRectangles<SquareSizeSelector<> >(rectangles.data(), rectangles.size(), spacing, ordered);
                 break;
         }
         if (!(dimensions.first > 0 && dimensions.second > 0))
             return -1;
         width = dimensions.first, height = dimensions.second;
     } else {
-        if (int result = packRectangles(rectangles.data(), rectangles.size(), width, height, spacing))
+        if (int result = packRectangles(rectangles.data(), rectangles.size(), width, height, spacing, ordered))
             return result;
     }
     // Set glyph box placement
@@ -86,7 +116,50 @@ int TightAtlasPacker::tryPack(GlyphGeometry *glyphs, int count, DimensionsConstr
     return 0;
 }
 
-double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) const {
+int TightAtlasPacker::tryPackLayered(std::vector<Rectangle> &rectangles, const std::vector<GlyphGeometry *> &rectangleGlyphs, DimensionsConstraint dimensionsConstraint, int &width, int &height) const {
+    // Each layer is a separate layout - a channel of a page, pages are unlimited in multi-page mode
+    int layerLimit = multiPage ? 0 : packedChannelCount;
+    bool ordered = !glyphPriorities.empty();
+    std::vector<int> layers(rectangles.size());
+    if (width < 0 || height < 0) {
+        if (!layerLimit)
+            return -1;
+        std::pair<int, int> dimensions = std::make_pair(width, height);
+        switch (dimensionsConstraint) {
+            case DimensionsConstraint::POWER_OF_TWO_SQUARE:
+                dimensions = packRectanglesLayered<SquarePowerOfTwoSizeSelector>(rectangles.data(), layers.data(), rectangles.size(), layerLimit, spacing, ordered);
+                break;
+            case DimensionsConstraint::POWER_OF_TWO_RECTANGLE:
+                dimensions = packRectanglesLayered<PowerOfTwoSizeSelector>(rectangles.data(), layers.data(), rectangles.size(), layerLimit, spacing, ordered);
+                break;
+            case DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE:
+                dimensions = packRectanglesLayered<SquareSizeSelector<4> >(rectangles.data(), layers.data(), rectangles.size(), layerLimit, spacing, ordered);
+                break;
+            case DimensionsConstraint::EVEN_SQUARE:
+                dimensions = packRectanglesLayered<SquareSizeSelector<2> >(rectangles.data(), layers.data(), rectangles.size(), layerLimit, spacing, ordered);
+                break;
+            case DimensionsConstraint::SQUARE:
+            default:
+                dimensions = packRectanglesLayered<SquareSizeSelector<> >(rectangles.data(), layers.data(), rectangles.size(), layerLimit, spacing, ordered);
+                break;
+        }
+        if (!(dimensions.first > 0 && dimensions.second > 0))
+            return -1;
+        width = dimensions.first, height = dimensions.second;
+    } else {
+        if (int result = packRectanglesLayered(rectangles.data(), layers.data(), rectangles.size(), width, height, spacing, layerLimit, ordered))
+            return result;
+    }
+    // Set glyph box placement
+    for (size_t i = 0; i < rectangles.size(); ++i) {
+        rectangleGlyphs[i]->placeBox(rectangles[i].x, height-(rectangles[i].y+rectangles[i].h));
+        rectangleGlyphs[i]->setBoxPage(layers[i]/packedChannelCount);
+        rectangleGlyphs[i]->setBoxChannel(layers[i]%packedChannelCount);
+    }
+    return 0;
+}
+
+double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) {
     bool lastResult = false;
     int w = width, h = height;
     #define TRY_PACK(scale) (lastResult = !tryPack(glyphs, count, DimensionsConstraint(), w, h, (scale)))
@@ -113,16 +186,29 @@ double TightAtlasPacker::packAndScale(GlyphGeometry *glyphs, int count) const {
 }
 
 int TightAtlasPacker::pack(GlyphGeometry *glyphs, int count) {
+    packAttempts = 0;
     double initialScale = scale > 0 ? scale : minScale;
-    if (initialScale > 0) {
+    if (multiPage) {
+        // Scale cannot be maximized since any scale fits with enough pages
+        if (width < 0 || height < 0 || !(initialScale > 0))
+            return -1;
         if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, initialScale))
             return remaining;
-    } else if (width < 0 || height < 0)
-        return -1;
-    if (scale <= 0)
-        scale = packAndScale(glyphs, count);
-    if (scale <= 0)
-        return -1;
+        scale = initialScale;
+    } else {
+        if (initialScale > 0) {
+            if (int remaining = tryPack(glyphs, count, dimensionsConstraint, width, height, initialScale))
+                return remaining;
+        } else if (width < 0 || height < 0)
+            return -1;
+        if (scale <= 0)
+            scale = packAndScale(glyphs, count);
+        if (scale <= 0)
+            return -1;
+    }
+    pageCount = 1;
+    for (const GlyphGeometry *glyph = glyphs, *end = glyphs+count; glyph < end; ++glyph)
+        pageCount = std::max(pageCount, glyph->getBoxPage()+1);
     return 0;
 }
 
@@ -134,6 +220,14 @@ void TightAtlasPacker::unsetDimensions() {
     width = -1, height = -1;
 }
 
+void TightAtlasPacker::setMultiPage(bool multiPage) {
+    this->multiPage = multiPage;
+}
+
+void TightAtlasPacker::setPackedChannelCount(int channelCount) {
+    packedChannelCount = std::max(channelCount, 1);
+}
+
 void TightAtlasPacker::setDimensionsConstraint(DimensionsConstraint dimensionsConstraint) {
     this->dimensionsConstraint = dimensionsConstraint;
 }
@@ -186,10 +280,18 @@ void TightAtlasPacker::setOuterPixelPadding(const Padding &padding) {
     outerPxPadding = padding;
 }
 
+void TightAtlasPacker::setGlyphPriorities(const std::vector<double> &priorities) {
+    glyphPriorities = priorities;
+}
+
 void TightAtlasPacker::getDimensions(int &width, int &height) const {
     width = this->width, height = this->height;
 }
 
+int TightAtlasPacker::getPageCount() const {
+    return pageCount;
+}
+
 double TightAtlasPacker::getScale() const {
     return scale;
 }
@@ -198,4 +300,8 @@ msdfgen::Range TightAtlasPacker::getPixelRange() const {
     return pxRange+scale*unitRange;
 }
 
+int TightAtlasPacker::getPackAttempts() const {
+    return packAttempts;
+}
+
 }
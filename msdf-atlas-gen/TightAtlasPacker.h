@@ -1,7 +1,9 @@
 
 #pragma once
 
+#include <vector>
 #include "types.h"
+#include "Rectangle.h"
 #include "Padding.h"
 #include "GlyphGeometry.h"
 
@@ -9,7 +11,8 @@ namespace msdf_atlas {
 
 /**
  * This class computes the layout of a static tightly packed atlas and may optionally
- * also find the minimum required dimensions and/or the maximum glyph scale
+ * also find the minimum required dimensions and/or the maximum glyph scale,
+ * or spread the glyphs over multiple pages and/or image channels
  */
 class TightAtlasPacker {
 
@@ -23,6 +26,10 @@ public:
     void setDimensions(int width, int height);
     /// Sets the atlas's dimensions to be determined during pack
     void unsetDimensions();
+    /// Sets whether glyphs that do not fit into the fixed dimensions should overflow into additional pages
+    void setMultiPage(bool multiPage);
+    /// Sets the number of image channels that single-channel glyphs are distributed into, each channel having its own layout
+    void setPackedChannelCount(int channelCount);
     /// Sets the constraint to be used when determining dimensions
     void setDimensionsConstraint(DimensionsConstraint dimensionsConstraint);
     /// Sets the spacing between glyph boxes
@@ -48,13 +55,19 @@ public:
     void setInnerPixelPadding(const Padding &padding);
     /// Sets the pixel component of width of additional padding around each glyph quad
     void setOuterPixelPadding(const Padding &padding);
+    /// Sets the packing priority of each glyph of the array passed to pack (e.g. its usage frequency), higher priority glyphs are placed first, closer to the origin and in the first pages
+    void setGlyphPriorities(const std::vector<double> &priorities);
 
     /// Outputs the atlas's final dimensions
     void getDimensions(int &width, int &height) const;
+    /// Returns the final number of atlas pages
+    int getPageCount() const;
     /// Returns the final glyph scale
     double getScale() const;
     /// Returns the final combined pixel range (including converted unit range)
     msdfgen::Range getPixelRange() const;
+    /// Returns the number of layouts tried by the last call to pack
+    int getPackAttempts() const;
 
 private:
     int width, height;
@@ -69,9 +82,16 @@ private:
     Padding innerUnitPadding, outerUnitPadding;
     Padding innerPxPadding, outerPxPadding;
     double scaleMaximizationTolerance;
+    bool multiPage;
+    int packedChannelCount;
+    int pageCount;
+    int packAttempts;
+    std::vector<double> glyphPriorities;
 
-    int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale) const;
-    double packAndScale(GlyphGeometry *glyphs, int count) const;
+    void wrapBoxes(std::vector<Rectangle> &rectangles, std::vector<GlyphGeometry *> &rectangleGlyphs, GlyphGeometry *glyphs, int count, double scale) const;
+    int tryPack(GlyphGeometry *glyphs, int count, DimensionsConstraint dimensionsConstraint, int &width, int &height, double scale);
+    int tryPackLayered(std::vector<Rectangle> &rectangles, const std::vector<GlyphGeometry *> &rectangleGlyphs, DimensionsConstraint dimensionsConstraint, int &width, int &height) const;
+    double packAndScale(GlyphGeometry *glyphs, int count);
 
 };
 
@@ -3,10 +3,12 @@
 
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
 
+#include <climits>
 #include <artery-font/std-artery-font.h>
 #include <artery-font/stdio-serialization.h>
 #include "GlyphGeometry.h"
 #include "image-encode.h"
+#include "bitmap-blit.h"
 
 namespace msdf_atlas {
 
@@ -37,11 +39,49 @@ static artery_font::CodepointType convertCodepointType(GlyphIdentifierType glyph
     return artery_font::CP_UNSPECIFIED;
 }
 
-template <typename T, int N>
-static bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<T, N> &atlas) {
-    // TODO
+// Only floating-point atlases can be encoded as TIFF
+template <int N>
+static bool encodeTiff(std::vector<byte> &, const msdfgen::BitmapConstRef<byte, N> &, const TiffEncoderSettings &) {
     return false;
 }
+template <int N>
+static bool encodeTiff(std::vector<byte> &, const msdfgen::BitmapConstRef<unorm16, N> &, const TiffEncoderSettings &) {
+    return false;
+}
+
+#ifndef MSDFGEN_DISABLE_PNG
+// Half-precision atlases cannot be encoded as PNG
+template <int N>
+static bool encodePng(std::vector<byte> &, const msdfgen::BitmapConstRef<half, N> &, const PngEncoderSettings &) {
+    return false;
+}
+#endif
+
+/// Byte array which only references image data owned elsewhere (the atlas bitmap or the encoder's output), so that it is written into the file without an intermediate copy
+class ImageDataReference {
+
+public:
+    inline ImageDataReference() : bytes(nullptr), byteCount(0) { }
+    inline ImageDataReference(const byte *bytes, size_t byteCount) : bytes(bytes), byteCount(byteCount) { }
+    inline int length() const {
+        return (int) byteCount;
+    }
+    inline explicit operator const byte *() const {
+        return bytes;
+    }
+    /// Returns false if the data is too large to be serialized (its length is stored as an int)
+    inline bool isSerializable() const {
+        return byteCount <= (size_t) INT_MAX;
+    }
+
+private:
+    const byte *bytes;
+    size_t byteCount;
+
+};
+
+template <typename REAL>
+using ReferencingArteryFont = artery_font::ArteryFont<REAL, artery_font::StdList, ImageDataReference, artery_font::StdString>;
 
 template <typename T>
 static artery_font::PixelFormat getPixelFormat();
@@ -54,18 +94,32 @@ template <>
 artery_font::PixelFormat getPixelFormat<float>() {
     return artery_font::PIXEL_FLOAT32;
 }
+// 16-bit atlases never match a raw binary pixel format
+template <>
+artery_font::PixelFormat getPixelFormat<unorm16>() {
+    return artery_font::PIXEL_UNKNOWN;
+}
+template <>
+artery_font::PixelFormat getPixelFormat<half>() {
+    return artery_font::PIXEL_UNKNOWN;
+}
 
 template <typename REAL, typename T, int N>
 bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<T, N> &atlas, const char *filename, const ArteryFontExportProperties &properties) {
-    artery_font::StdArteryFont<REAL> arfont = { };
+    return exportArteryFont<REAL>(fonts, fontCount, &atlas, 1, filename, properties);
+}
+
+template <typename REAL, typename T, int N>
+bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<T, N> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties) {
+    ReferencingArteryFont<REAL> arfont = { };
     arfont.metadataFormat = artery_font::METADATA_NONE;
 
-    arfont.variants = artery_font::StdList<typename artery_font::StdArteryFont<REAL>::Variant>(fontCount);
+    arfont.variants = artery_font::StdList<typename ReferencingArteryFont<REAL>::Variant>(fontCount);
     for (int i = 0; i < fontCount; ++i) {
         const FontGeometry &font = fonts[i];
         GlyphIdentifierType identifierType = font.getPreferredIdentifierType();
         const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
-        typename artery_font::StdArteryFont<REAL>::Variant &fontVariant = arfont.variants[i] = typename artery_font::StdArteryFont<REAL>::Variant();
+        typename ReferencingArteryFont<REAL>::Variant &fontVariant = arfont.variants[i] = typename ReferencingArteryFont<REAL>::Variant();
         fontVariant.codepointType = convertCodepointType(identifierType);
         fontVariant.imageType = convertImageType(properties.imageType);
         fontVariant.metrics.fontSize = REAL(properties.fontSize*fontMetrics.emSize);
@@ -87,7 +141,7 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
         for (const GlyphGeometry &glyphGeom : font.getGlyphs()) {
             artery_font::Glyph<REAL> &glyph = fontVariant.glyphs[j++];
             glyph.codepoint = glyphGeom.getIdentifier(identifierType);
-            glyph.image = 0;
+            glyph.image = glyphGeom.getBoxPage();
             double l, b, r, t;
             glyphGeom.getQuadPlaneBounds(l, b, r, t);
             glyph.planeBounds.l = REAL(l);
@@ -104,7 +158,7 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
         }
         switch (identifierType) {
             case GlyphIdentifierType::GLYPH_INDEX:
-                for (const std::pair<std::pair<int, int>, double> &elem : font.getKerning()) {
+                for (const std::pair<std::pair<int, int>, double> &elem : font.getKerningTable()) {
                     artery_font::KernPair<REAL> kernPair = { };
                     kernPair.codepoint1 = elem.first.first;
                     kernPair.codepoint2 = elem.first.second;
@@ -113,7 +167,7 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
                 }
                 break;
             case GlyphIdentifierType::UNICODE_CODEPOINT:
-                for (const std::pair<std::pair<int, int>, double> &elem : font.getKerning()) {
+                for (const std::pair<std::pair<int, int>, double> &elem : font.getKerningTable()) {
                     const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(elem.first.first));
                     const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(elem.first.second));
                     if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
@@ -128,9 +182,19 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
         }
     }
 
-    arfont.images = artery_font::StdList<typename artery_font::StdArteryFont<REAL>::Image>(1);
-    {
-        typename artery_font::StdArteryFont<REAL>::Image &image = arfont.images[0] = typename artery_font::StdArteryFont<REAL>::Image();
+    // Only encoded and reoriented images need to be stored, raw binary images in the atlas bitmap's orientation are written directly from it
+    std::vector<std::vector<byte> > imageData(pageCount);
+    arfont.images = artery_font::StdList<typename ReferencingArteryFont<REAL>::Image>(pageCount);
+    for (int i = 0; i < pageCount; ++i) {
+        msdfgen::BitmapConstRef<T, N> atlas = pages[i];
+        msdfgen::Bitmap<T, N> flippedAtlas;
+        // Image encoders expect a bottom-up bitmap
+        if (properties.atlasYDirection == YDirection::TOP_DOWN && (properties.imageFormat == ImageFormat::PNG || properties.imageFormat == ImageFormat::PNG16 || properties.imageFormat == ImageFormat::TIFF)) {
+            flippedAtlas = msdfgen::Bitmap<T, N>(atlas.width, atlas.height);
+            blitFlippedY(flippedAtlas, atlas, 0, 0, 0, 0, atlas.width, atlas.height);
+            atlas = flippedAtlas;
+        }
+        typename ReferencingArteryFont<REAL>::Image &image = arfont.images[i] = typename ReferencingArteryFont<REAL>::Image();
         image.width = atlas.width;
         image.height = atlas.height;
         image.channels = N;
@@ -138,17 +202,21 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
         switch (properties.imageFormat) {
         #ifndef MSDFGEN_DISABLE_PNG
             case ImageFormat::PNG:
+            case ImageFormat::PNG16:
                 image.encoding = artery_font::IMAGE_PNG;
-                image.pixelFormat = artery_font::PIXEL_UNSIGNED8;
-                if (!encodePng((std::vector<byte> &) image.data, atlas))
+                // The container has no 16-bit pixel format, so a 16-bit PNG is marked as unknown and described only by its encoding
+                image.pixelFormat = properties.imageFormat == ImageFormat::PNG16 ? artery_font::PIXEL_UNKNOWN : artery_font::PIXEL_UNSIGNED8;
+                if (!encodePng(imageData[i], atlas, properties.pngSettings))
                     return false;
+                image.data = ImageDataReference(imageData[i].data(), imageData[i].size());
                 break;
         #endif
             case ImageFormat::TIFF:
                 image.encoding = artery_font::IMAGE_TIFF;
                 image.pixelFormat = artery_font::PIXEL_FLOAT32;
-                if (!encodeTiff((std::vector<byte> &) image.data, atlas))
+                if (!encodeTiff(imageData[i], atlas, properties.tiffSettings))
                     return false;
+                image.data = ImageDataReference(imageData[i].data(), imageData[i].size());
                 break;
             case ImageFormat::BINARY:
                 image.pixelFormat = artery_font::PIXEL_UNSIGNED8;
@@ -156,31 +224,31 @@ bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::B
             case ImageFormat::BINARY_FLOAT:
                 image.pixelFormat = artery_font::PIXEL_FLOAT32;
                 goto BINARY_EITHER;
-            BINARY_EITHER:
+            BINARY_EITHER: {
                 if (image.pixelFormat != getPixelFormat<T>())
                     return false;
                 image.encoding = artery_font::IMAGE_RAW_BINARY;
-                image.rawBinaryFormat.rowLength = N*sizeof(T)*atlas.width;
-                image.data = artery_font::StdByteArray(N*sizeof(T)*atlas.width*atlas.height);
-                switch (properties.yDirection) {
-                    case YDirection::BOTTOM_UP:
-                        image.rawBinaryFormat.orientation = artery_font::ORIENTATION_BOTTOM_UP;
-                        memcpy((byte *) image.data, atlas.pixels, N*sizeof(T)*atlas.width*atlas.height);
-                        break;
-                    case YDirection::TOP_DOWN: {
-                        image.rawBinaryFormat.orientation = artery_font::ORIENTATION_TOP_DOWN;
-                        byte *imageData = (byte *) image.data;
-                        for (int y = atlas.height-1; y >= 0; --y) {
-                            memcpy(imageData, atlas.pixels+N*atlas.width*y, N*sizeof(T)*atlas.width);
-                            imageData += N*sizeof(T)*atlas.width;
-                        }
-                        break;
+                size_t rowLength = N*sizeof(T)*atlas.width;
+                image.rawBinaryFormat.rowLength = (uint32_t) rowLength;
+                image.rawBinaryFormat.orientation = properties.yDirection == YDirection::TOP_DOWN ? artery_font::ORIENTATION_TOP_DOWN : artery_font::ORIENTATION_BOTTOM_UP;
+                if (properties.yDirection == properties.atlasYDirection)
+                    image.data = ImageDataReference(reinterpret_cast<const byte *>(atlas.pixels), rowLength*atlas.height);
+                else {
+                    imageData[i].resize(rowLength*atlas.height);
+                    byte *dst = imageData[i].data();
+                    for (int y = atlas.height-1; y >= 0; --y) {
+                        memcpy(dst, atlas.pixels+N*atlas.width*y, rowLength);
+                        dst += rowLength;
                     }
+                    image.data = ImageDataReference(imageData[i].data(), imageData[i].size());
                 }
                 break;
+            }
             default:
                 return false;
         }
+        if (!image.data.isSerializable())
+            return false;
     }
 
     return artery_font::writeFile(arfont, filename);
@@ -192,6 +260,24 @@ template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount,
 template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<float, 1> &atlas, const char *filename, const ArteryFontExportProperties &properties);
 template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<float, 3> &atlas, const char *filename, const ArteryFontExportProperties &properties);
 template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<float, 4> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<unorm16, 1> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<unorm16, 3> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<unorm16, 4> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<half, 1> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<half, 3> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<half, 4> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<byte, 1> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<byte, 3> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<byte, 4> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<float, 1> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<float, 3> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<float, 4> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<unorm16, 1> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<unorm16, 3> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<unorm16, 4> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<half, 1> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<half, 3> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
+template bool exportArteryFont<float>(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<half, 4> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
 
 }
 
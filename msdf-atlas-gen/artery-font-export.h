@@ -7,6 +7,7 @@
 #include <msdfgen-ext.h>
 #include "types.h"
 #include "FontGeometry.h"
+#include "image-encode.h"
 
 namespace msdf_atlas {
 
@@ -16,11 +17,18 @@ struct ArteryFontExportProperties {
     ImageType imageType;
     ImageFormat imageFormat;
     YDirection yDirection;
+    /// Row order of the atlas bitmaps in memory
+    YDirection atlasYDirection;
+    PngEncoderSettings pngSettings;
+    TiffEncoderSettings tiffSettings;
 };
 
 /// Encodes the atlas bitmap and its layout into an Artery Atlas Font file
 template <typename REAL, typename T, int N>
 bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<T, N> &atlas, const char *filename, const ArteryFontExportProperties &properties);
+/// Encodes the pages of a multi-page atlas as separate images, each glyph references its page's image
+template <typename REAL, typename T, int N>
+bool exportArteryFont(const FontGeometry *fonts, int fontCount, const msdfgen::BitmapConstRef<T, N> *pages, int pageCount, const char *filename, const ArteryFontExportProperties &properties);
 
 }
 
@@ -0,0 +1,239 @@
+
+#include "binary-export.h"
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include "GlyphGeometry.h"
+#include "BufferedFileWriter.h"
+
+#define BINARY_LAYOUT_ALIGNMENT 8
+
+namespace msdf_atlas {
+
+// Values are stored byte by byte, which makes the output little-endian regardless of the host
+
+static void storeUint32(byte *dst, uint32_t value) {
+    dst[0] = byte(value);
+    dst[1] = byte(value>>8);
+    dst[2] = byte(value>>16);
+    dst[3] = byte(value>>24);
+}
+
+static void storeInt32(byte *dst, int32_t value) {
+    storeUint32(dst, uint32_t(value));
+}
+
+static void storeFloat(byte *dst, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    storeUint32(dst, bits);
+}
+
+static void storeDouble(byte *dst, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    storeUint32(dst, uint32_t(bits));
+    storeUint32(dst+4, uint32_t(bits>>32));
+}
+
+/// Appends a zero-initialized aligned section to the file data and returns its offset
+static size_t allocateSection(std::vector<byte> &data, size_t size) {
+    size_t offset = (data.size()+BINARY_LAYOUT_ALIGNMENT-1)/BINARY_LAYOUT_ALIGNMENT*BINARY_LAYOUT_ALIGNMENT;
+    data.resize(offset+size, 0);
+    return offset;
+}
+
+static uint32_t imageTypeCode(ImageType type) {
+    switch (type) {
+        case ImageType::HARD_MASK:
+            return 0;
+        case ImageType::SOFT_MASK:
+            return 1;
+        case ImageType::SDF:
+            return 2;
+        case ImageType::PSDF:
+            return 3;
+        case ImageType::MSDF:
+            return 4;
+        case ImageType::MTSDF:
+            return 5;
+    }
+    return 0;
+}
+
+static void storeFontData(std::vector<byte> &data, size_t recordOffset, const FontGeometry &font, const JsonAtlasMetrics &metrics, bool kerning) {
+    FontGeometry::GlyphRange glyphs = font.getGlyphs();
+    size_t glyphCount = glyphs.size();
+
+    size_t nameOffset = 0, nameLength = 0;
+    if (const char *name = font.getName()) {
+        nameLength = strlen(name);
+        nameOffset = allocateSection(data, nameLength+1);
+        memcpy(data.data()+nameOffset, name, nameLength);
+    }
+
+    // Glyph table
+    size_t indexOffset = allocateSection(data, sizeof(uint32_t)*glyphCount);
+    size_t codepointOffset = allocateSection(data, sizeof(uint32_t)*glyphCount);
+    size_t advanceOffset = allocateSection(data, sizeof(float)*glyphCount);
+    size_t planeBoundsOffset = allocateSection(data, 4*sizeof(float)*glyphCount);
+    size_t atlasBoundsOffset = allocateSection(data, 4*sizeof(float)*glyphCount);
+    size_t pageOffset = metrics.multiPage ? allocateSection(data, sizeof(uint32_t)*glyphCount) : 0;
+    size_t channelOffset = metrics.packedChannels > 1 ? allocateSection(data, sizeof(uint32_t)*glyphCount) : 0;
+    std::vector<std::pair<unicode_t, uint32_t> > codepointMap;
+    std::map<int, uint32_t> glyphSlots;
+    uint32_t slot = 0;
+    for (const GlyphGeometry &glyph : glyphs) {
+        storeUint32(data.data()+indexOffset+sizeof(uint32_t)*slot, uint32_t(glyph.getIndex()));
+        storeUint32(data.data()+codepointOffset+sizeof(uint32_t)*slot, glyph.getCodepoint());
+        storeFloat(data.data()+advanceOffset+sizeof(float)*slot, float(glyph.getAdvance()));
+        double l, b, r, t;
+        glyph.getQuadPlaneBounds(l, b, r, t);
+        if (metrics.yDirection == YDirection::TOP_DOWN)
+            b = -b, t = -t;
+        byte *planeBounds = data.data()+planeBoundsOffset+4*sizeof(float)*slot;
+        storeFloat(planeBounds, float(l)), storeFloat(planeBounds+4, float(b)), storeFloat(planeBounds+8, float(r)), storeFloat(planeBounds+12, float(t));
+        glyph.getQuadAtlasBounds(l, b, r, t);
+        if (metrics.yDirection == YDirection::TOP_DOWN)
+            b = metrics.height-b, t = metrics.height-t;
+        byte *atlasBounds = data.data()+atlasBoundsOffset+4*sizeof(float)*slot;
+        storeFloat(atlasBounds, float(l)), storeFloat(atlasBounds+4, float(b)), storeFloat(atlasBounds+8, float(r)), storeFloat(atlasBounds+12, float(t));
+        if (pageOffset)
+            storeUint32(data.data()+pageOffset+sizeof(uint32_t)*slot, uint32_t(glyph.getBoxPage()));
+        if (channelOffset)
+            storeUint32(data.data()+channelOffset+sizeof(uint32_t)*slot, uint32_t(glyph.getBoxChannel()));
+        if (glyph.getCodepoint())
+            codepointMap.push_back(std::make_pair(glyph.getCodepoint(), slot));
+        glyphSlots.insert(std::make_pair(glyph.getIndex(), slot));
+        ++slot;
+    }
+
+    // Codepoint lookup table
+    std::stable_sort(codepointMap.begin(), codepointMap.end(), [](const std::pair<unicode_t, uint32_t> &a, const std::pair<unicode_t, uint32_t> &b) {
+        return a.first < b.first;
+    });
+    size_t codepointMapOffset = codepointMap.empty() ? 0 : allocateSection(data, sizeof(BinaryLayoutCodepointEntry)*codepointMap.size());
+    for (size_t i = 0; i < codepointMap.size(); ++i) {
+        byte *entry = data.data()+codepointMapOffset+sizeof(BinaryLayoutCodepointEntry)*i;
+        storeUint32(entry+offsetof(BinaryLayoutCodepointEntry, codepoint), codepointMap[i].first);
+        storeUint32(entry+offsetof(BinaryLayoutCodepointEntry, glyph), codepointMap[i].second);
+    }
+
+    // Kerning table
+    std::vector<std::pair<std::pair<uint32_t, uint32_t>, double> > kerningPairs;
+    if (kerning) {
+        for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerningTable()) {
+            std::map<int, uint32_t>::const_iterator glyph1 = glyphSlots.find(kernPair.first.first);
+            std::map<int, uint32_t>::const_iterator glyph2 = glyphSlots.find(kernPair.first.second);
+            if (glyph1 != glyphSlots.end() && glyph2 != glyphSlots.end())
+                kerningPairs.push_back(std::make_pair(std::make_pair(glyph1->second, glyph2->second), kernPair.second));
+        }
+        std::sort(kerningPairs.begin(), kerningPairs.end());
+    }
+    size_t kerningOffset = kerningPairs.empty() ? 0 : allocateSection(data, sizeof(BinaryLayoutKerningPair)*kerningPairs.size());
+    for (size_t i = 0; i < kerningPairs.size(); ++i) {
+        byte *entry = data.data()+kerningOffset+sizeof(BinaryLayoutKerningPair)*i;
+        storeUint32(entry+offsetof(BinaryLayoutKerningPair, glyph1), kerningPairs[i].first.first);
+        storeUint32(entry+offsetof(BinaryLayoutKerningPair, glyph2), kerningPairs[i].first.second);
+        storeFloat(entry+offsetof(BinaryLayoutKerningPair, advance), float(kerningPairs[i].second));
+    }
+
+    // Font record
+    byte *record = data.data()+recordOffset;
+    double yFactor = metrics.yDirection == YDirection::TOP_DOWN ? -1 : 1;
+    const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
+    storeUint32(record+offsetof(BinaryLayoutFont, nameOffset), uint32_t(nameOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, nameLength), uint32_t(nameLength));
+    storeUint32(record+offsetof(BinaryLayoutFont, identifierType), font.getPreferredIdentifierType() == GlyphIdentifierType::UNICODE_CODEPOINT);
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphCount), uint32_t(glyphCount));
+    storeDouble(record+offsetof(BinaryLayoutFont, emSize), fontMetrics.emSize);
+    storeDouble(record+offsetof(BinaryLayoutFont, lineHeight), fontMetrics.lineHeight);
+    storeDouble(record+offsetof(BinaryLayoutFont, ascender), yFactor*fontMetrics.ascenderY);
+    storeDouble(record+offsetof(BinaryLayoutFont, descender), yFactor*fontMetrics.descenderY);
+    storeDouble(record+offsetof(BinaryLayoutFont, underlineY), yFactor*fontMetrics.underlineY);
+    storeDouble(record+offsetof(BinaryLayoutFont, underlineThickness), fontMetrics.underlineThickness);
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphIndexOffset), uint32_t(indexOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphCodepointOffset), uint32_t(codepointOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphAdvanceOffset), uint32_t(advanceOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphPlaneBoundsOffset), uint32_t(planeBoundsOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphAtlasBoundsOffset), uint32_t(atlasBoundsOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphPageOffset), uint32_t(pageOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, glyphChannelOffset), uint32_t(channelOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, codepointMapCount), uint32_t(codepointMap.size()));
+    storeUint32(record+offsetof(BinaryLayoutFont, codepointMapOffset), uint32_t(codepointMapOffset));
+    storeUint32(record+offsetof(BinaryLayoutFont, kerningCount), uint32_t(kerningPairs.size()));
+    storeUint32(record+offsetof(BinaryLayoutFont, kerningOffset), uint32_t(kerningOffset));
+}
+
+bool exportBinaryLayout(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning) {
+    std::vector<byte> data;
+    size_t headerOffset = allocateSection(data, sizeof(BinaryLayoutHeader));
+    size_t fontTableOffset = allocateSection(data, sizeof(BinaryLayoutFont)*fontCount);
+    for (int i = 0; i < fontCount; ++i)
+        storeFontData(data, fontTableOffset+sizeof(BinaryLayoutFont)*i, fonts[i], metrics, kerning);
+    data.resize(allocateSection(data, 0));
+    if (data.size() > 0xffffffffu)
+        return false;
+
+    // Header
+    byte *header = data.data()+headerOffset;
+    memcpy(header+offsetof(BinaryLayoutHeader, magic), MSDF_ATLAS_BINARY_LAYOUT_MAGIC, sizeof(BinaryLayoutHeader::magic));
+    storeUint32(header+offsetof(BinaryLayoutHeader, version), MSDF_ATLAS_BINARY_LAYOUT_VERSION);
+    storeUint32(header+offsetof(BinaryLayoutHeader, fileSize), uint32_t(data.size()));
+    storeUint32(header+offsetof(BinaryLayoutHeader, imageType), imageTypeCode(imageType));
+    storeUint32(header+offsetof(BinaryLayoutHeader, yOrigin), metrics.yDirection == YDirection::TOP_DOWN);
+    storeInt32(header+offsetof(BinaryLayoutHeader, width), metrics.width);
+    storeInt32(header+offsetof(BinaryLayoutHeader, height), metrics.height);
+    storeInt32(header+offsetof(BinaryLayoutHeader, pages), metrics.pages);
+    storeInt32(header+offsetof(BinaryLayoutHeader, packedChannels), metrics.packedChannels);
+    if (imageType == ImageType::SDF || imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF) {
+        storeDouble(header+offsetof(BinaryLayoutHeader, distanceRange), metrics.distanceRange.upper-metrics.distanceRange.lower);
+        storeDouble(header+offsetof(BinaryLayoutHeader, distanceRangeMiddle), .5*(metrics.distanceRange.lower+metrics.distanceRange.upper));
+    }
+    storeDouble(header+offsetof(BinaryLayoutHeader, size), metrics.size);
+    if (metrics.grid) {
+        storeInt32(header+offsetof(BinaryLayoutHeader, gridCellWidth), metrics.grid->cellWidth);
+        storeInt32(header+offsetof(BinaryLayoutHeader, gridCellHeight), metrics.grid->cellHeight);
+        storeInt32(header+offsetof(BinaryLayoutHeader, gridColumns), metrics.grid->columns);
+        storeInt32(header+offsetof(BinaryLayoutHeader, gridRows), metrics.grid->rows);
+        storeUint32(header+offsetof(BinaryLayoutHeader, gridFlags), (metrics.grid->originX ? 0x01u : 0u)|(metrics.grid->originY ? 0x02u : 0u));
+        if (metrics.grid->originX)
+            storeDouble(header+offsetof(BinaryLayoutHeader, gridOriginX), *metrics.grid->originX);
+        if (metrics.grid->originY) {
+            switch (metrics.yDirection) {
+                case YDirection::BOTTOM_UP:
+                    storeDouble(header+offsetof(BinaryLayoutHeader, gridOriginY), *metrics.grid->originY);
+                    break;
+                case YDirection::TOP_DOWN:
+                    storeDouble(header+offsetof(BinaryLayoutHeader, gridOriginY), (metrics.grid->cellHeight-metrics.grid->spacing-1)/metrics.size-*metrics.grid->originY);
+                    break;
+            }
+        }
+    }
+    if (metrics.shelves) {
+        storeInt32(header+offsetof(BinaryLayoutHeader, shelfHeight), metrics.shelves->shelfHeight);
+        storeInt32(header+offsetof(BinaryLayoutHeader, shelfStride), metrics.shelves->shelfHeight+metrics.shelves->spacing);
+        storeInt32(header+offsetof(BinaryLayoutHeader, shelfCount), metrics.shelves->shelves);
+        switch (metrics.yDirection) {
+            case YDirection::BOTTOM_UP:
+                storeDouble(header+offsetof(BinaryLayoutHeader, shelfOriginY), metrics.shelves->originY);
+                break;
+            case YDirection::TOP_DOWN:
+                storeDouble(header+offsetof(BinaryLayoutHeader, shelfOriginY), (metrics.shelves->shelfHeight-1)/metrics.size-metrics.shelves->originY);
+                break;
+        }
+    }
+    storeUint32(header+offsetof(BinaryLayoutHeader, fontCount), uint32_t(fontCount));
+    storeUint32(header+offsetof(BinaryLayoutHeader, fontTableOffset), uint32_t(fontTableOffset));
+
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    writer.write(data.data(), data.size());
+    return writer.close();
+}
+
+}
@@ -0,0 +1,89 @@
+
+#pragma once
+
+#include <cstdint>
+#include "types.h"
+#include "FontGeometry.h"
+#include "json-export.h"
+
+#define MSDF_ATLAS_BINARY_LAYOUT_MAGIC "MSDFALYT"
+#define MSDF_ATLAS_BINARY_LAYOUT_VERSION 1
+
+namespace msdf_atlas {
+
+/*
+ * Binary layout file format - all values are little-endian and every structure and array is aligned to 8 bytes,
+ * so that the file can be memory-mapped and accessed directly through the structures below.
+ * Offsets are in bytes from the start of the file, zero offset means that the section is not present.
+ * Glyphs are referenced by their position in the font's glyph table.
+ * Y-coordinates of bounds follow the yOrigin setting, i.e. for top-down Y, bottom and top are negated (plane bounds) or subtracted from atlas height (atlas bounds).
+ */
+
+/// Binary layout file header
+struct BinaryLayoutHeader {
+    char magic[8]; // MSDF_ATLAS_BINARY_LAYOUT_MAGIC
+    uint32_t version; // MSDF_ATLAS_BINARY_LAYOUT_VERSION
+    uint32_t fileSize;
+    uint32_t imageType; // 0 = hardmask, 1 = softmask, 2 = sdf, 3 = psdf, 4 = msdf, 5 = mtsdf
+    uint32_t yOrigin; // 0 = bottom, 1 = top
+    int32_t width, height;
+    int32_t pages, packedChannels;
+    double distanceRange, distanceRangeMiddle;
+    double size;
+    // Uniform grid layout (zero if not applicable)
+    int32_t gridCellWidth, gridCellHeight;
+    int32_t gridColumns, gridRows;
+    uint32_t gridFlags; // bit 0 = gridOriginX valid, bit 1 = gridOriginY valid
+    uint32_t reserved0;
+    double gridOriginX, gridOriginY;
+    // Shelf layout (zero if not applicable)
+    int32_t shelfHeight, shelfStride, shelfCount;
+    uint32_t reserved1;
+    double shelfOriginY;
+    uint32_t fontCount;
+    uint32_t fontTableOffset; // BinaryLayoutFont[fontCount]
+};
+
+/// Binary layout font (variant) record
+struct BinaryLayoutFont {
+    uint32_t nameOffset; // null-terminated UTF-8 string
+    uint32_t nameLength;
+    uint32_t identifierType; // preferred glyph identifier: 0 = glyph index, 1 = Unicode codepoint
+    uint32_t glyphCount;
+    double emSize, lineHeight, ascender, descender, underlineY, underlineThickness;
+    // Glyph table in struct-of-arrays form, each array has glyphCount elements
+    uint32_t glyphIndexOffset; // uint32_t[]
+    uint32_t glyphCodepointOffset; // uint32_t[], 0 if unknown
+    uint32_t glyphAdvanceOffset; // float[]
+    uint32_t glyphPlaneBoundsOffset; // float[4][] - left, bottom, right, top
+    uint32_t glyphAtlasBoundsOffset; // float[4][] - left, bottom, right, top
+    uint32_t glyphPageOffset; // uint32_t[], only for multi-page atlas (0 otherwise)
+    uint32_t glyphChannelOffset; // uint32_t[], only for channel-packed atlas
+    uint32_t codepointMapCount;
+    uint32_t codepointMapOffset; // BinaryLayoutCodepointEntry[], sorted by codepoint
+    uint32_t kerningCount;
+    uint32_t kerningOffset; // BinaryLayoutKerningPair[], sorted by glyph1, then glyph2
+    uint32_t reserved;
+};
+
+/// Binary layout codepoint to glyph mapping entry
+struct BinaryLayoutCodepointEntry {
+    uint32_t codepoint;
+    uint32_t glyph;
+};
+
+/// Binary layout kerning pair, advance is to be added to the base advance of glyph1
+struct BinaryLayoutKerningPair {
+    uint32_t glyph1, glyph2;
+    float advance;
+};
+
+static_assert(sizeof(BinaryLayoutHeader) == 136, "Unexpected BinaryLayoutHeader size");
+static_assert(sizeof(BinaryLayoutFont) == 112, "Unexpected BinaryLayoutFont size");
+static_assert(sizeof(BinaryLayoutCodepointEntry) == 8, "Unexpected BinaryLayoutCodepointEntry size");
+static_assert(sizeof(BinaryLayoutKerningPair) == 12, "Unexpected BinaryLayoutKerningPair size");
+
+/// Writes the font metrics and atlas layout data into a binary file, which can be memory-mapped and used directly at runtime
+bool exportBinaryLayout(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning);
+
+}
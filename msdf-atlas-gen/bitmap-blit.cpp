@@ -3,6 +3,7 @@
 
 #include <cstring>
 #include <algorithm>
+#include "pixel-conversion.h"
 
 namespace msdf_atlas {
 
@@ -30,6 +31,12 @@ BLIT_SAME_TYPE_IMPL(byte, 4)
 BLIT_SAME_TYPE_IMPL(float, 1)
 BLIT_SAME_TYPE_IMPL(float, 3)
 BLIT_SAME_TYPE_IMPL(float, 4)
+BLIT_SAME_TYPE_IMPL(unorm16, 1)
+BLIT_SAME_TYPE_IMPL(unorm16, 3)
+BLIT_SAME_TYPE_IMPL(unorm16, 4)
+BLIT_SAME_TYPE_IMPL(half, 1)
+BLIT_SAME_TYPE_IMPL(half, 3)
+BLIT_SAME_TYPE_IMPL(half, 4)
 
 void blit(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h) {
     BOUND_AREA();
@@ -69,4 +76,55 @@ void blit(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<
     }
 }
 
+template <typename T, int N, T CONVERT(float)>
+void blitFromFloat(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<float, N> &src, int dx, int dy, int sx, int sy, int w, int h) {
+    BOUND_AREA();
+    for (int y = 0; y < h; ++y) {
+        T *dstPixel = dst(dx, dy+y);
+        const float *srcPixel = src(sx, sy+y);
+        for (int x = 0; x < N*w; ++x)
+            *dstPixel++ = CONVERT(*srcPixel++);
+    }
+}
+
+#define BLIT_FROM_FLOAT_IMPL(T, N, CONVERT) void blit(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<float, N> &src, int dx, int dy, int sx, int sy, int w, int h) { blitFromFloat<T, N, CONVERT>(dst, src, dx, dy, sx, sy, w, h); }
+
+BLIT_FROM_FLOAT_IMPL(unorm16, 1, pixelFloatToUnorm16)
+BLIT_FROM_FLOAT_IMPL(unorm16, 3, pixelFloatToUnorm16)
+BLIT_FROM_FLOAT_IMPL(unorm16, 4, pixelFloatToUnorm16)
+BLIT_FROM_FLOAT_IMPL(half, 1, pixelFloatToHalf)
+BLIT_FROM_FLOAT_IMPL(half, 3, pixelFloatToHalf)
+BLIT_FROM_FLOAT_IMPL(half, 4, pixelFloatToHalf)
+
+template <typename T, typename S, int N>
+void blitFlippedYRows(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<S, N> &src, int dx, int dy, int sx, int sy, int w, int h) {
+    // Each row is clipped separately
+    for (int y = 0; y < h; ++y)
+        blit(dst, src, dx, dy+h-y-1, sx, sy+y, w, 1);
+}
+
+#define BLIT_FLIPPED_Y_IMPL(T, S, N) void blitFlippedY(const msdfgen::BitmapRef<T, N> &dst, const msdfgen::BitmapConstRef<S, N> &src, int dx, int dy, int sx, int sy, int w, int h) { blitFlippedYRows(dst, src, dx, dy, sx, sy, w, h); }
+
+BLIT_FLIPPED_Y_IMPL(byte, byte, 1)
+BLIT_FLIPPED_Y_IMPL(byte, byte, 3)
+BLIT_FLIPPED_Y_IMPL(byte, byte, 4)
+BLIT_FLIPPED_Y_IMPL(float, float, 1)
+BLIT_FLIPPED_Y_IMPL(float, float, 3)
+BLIT_FLIPPED_Y_IMPL(float, float, 4)
+BLIT_FLIPPED_Y_IMPL(byte, float, 1)
+BLIT_FLIPPED_Y_IMPL(byte, float, 3)
+BLIT_FLIPPED_Y_IMPL(byte, float, 4)
+BLIT_FLIPPED_Y_IMPL(unorm16, unorm16, 1)
+BLIT_FLIPPED_Y_IMPL(unorm16, unorm16, 3)
+BLIT_FLIPPED_Y_IMPL(unorm16, unorm16, 4)
+BLIT_FLIPPED_Y_IMPL(half, half, 1)
+BLIT_FLIPPED_Y_IMPL(half, half, 3)
+BLIT_FLIPPED_Y_IMPL(half, half, 4)
+BLIT_FLIPPED_Y_IMPL(unorm16, float, 1)
+BLIT_FLIPPED_Y_IMPL(unorm16, float, 3)
+BLIT_FLIPPED_Y_IMPL(unorm16, float, 4)
+BLIT_FLIPPED_Y_IMPL(half, float, 1)
+BLIT_FLIPPED_Y_IMPL(half, float, 3)
+BLIT_FLIPPED_Y_IMPL(half, float, 4)
+
 }
@@ -22,4 +22,53 @@ void blit(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<
 void blit(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
 void blit(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
 
+void blit(const msdfgen::BitmapRef<unorm16, 1> &dst, const msdfgen::BitmapConstRef<unorm16, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<unorm16, 3> &dst, const msdfgen::BitmapConstRef<unorm16, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<unorm16, 4> &dst, const msdfgen::BitmapConstRef<unorm16, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blit(const msdfgen::BitmapRef<half, 1> &dst, const msdfgen::BitmapConstRef<half, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<half, 3> &dst, const msdfgen::BitmapConstRef<half, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<half, 4> &dst, const msdfgen::BitmapConstRef<half, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blit(const msdfgen::BitmapRef<unorm16, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<unorm16, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<unorm16, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blit(const msdfgen::BitmapRef<half, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<half, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blit(const msdfgen::BitmapRef<half, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+/*
+ * Copies a rectangular section from source bitmap to destination bitmap with the order of its rows reversed,
+ * i.e. between a bottom-up and a top-down bitmap.
+ */
+
+void blitFlippedY(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<byte, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<byte, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<byte, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blitFlippedY(const msdfgen::BitmapRef<float, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<float, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<float, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blitFlippedY(const msdfgen::BitmapRef<byte, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<byte, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<byte, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blitFlippedY(const msdfgen::BitmapRef<unorm16, 1> &dst, const msdfgen::BitmapConstRef<unorm16, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<unorm16, 3> &dst, const msdfgen::BitmapConstRef<unorm16, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<unorm16, 4> &dst, const msdfgen::BitmapConstRef<unorm16, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blitFlippedY(const msdfgen::BitmapRef<half, 1> &dst, const msdfgen::BitmapConstRef<half, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<half, 3> &dst, const msdfgen::BitmapConstRef<half, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<half, 4> &dst, const msdfgen::BitmapConstRef<half, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blitFlippedY(const msdfgen::BitmapRef<unorm16, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<unorm16, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<unorm16, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
+void blitFlippedY(const msdfgen::BitmapRef<half, 1> &dst, const msdfgen::BitmapConstRef<float, 1> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<half, 3> &dst, const msdfgen::BitmapConstRef<float, 3> &src, int dx, int dy, int sx, int sy, int w, int h);
+void blitFlippedY(const msdfgen::BitmapRef<half, 4> &dst, const msdfgen::BitmapConstRef<float, 4> &src, int dx, int dy, int sx, int sy, int w, int h);
+
 }
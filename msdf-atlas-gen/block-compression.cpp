@@ -0,0 +1,438 @@
+
+#include "block-compression.h"
+
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "Workload.h"
+
+#define BLOCK_PIXELS 16
+#define ENDPOINT_REFINEMENT_ITERATIONS 2
+
+namespace msdf_atlas {
+
+/// Interpolation weights of 4-bit BC7 indices (out of 64)
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/// Relative importance of a distance value, which increases towards the edge (middle value) where errors displace the reconstructed shape
+static double distanceWeight(int value) {
+    return 1+3*(1-fabs(value-127.5)/127.5);
+}
+
+static int clampByte(double value, int maximum = 255) {
+    return std::min(std::max((int) lround(value), 0), maximum);
+}
+
+/// Fits endpoints a, b minimizing the weighted squared error of values interpolated at positions t (0 = a, 1 = b), returns false if singular
+static bool fitEndpoints(double &a, double &b, const double *t, const double *values, const double *weights, int count) {
+    double aa = 0, ab = 0, bb = 0, av = 0, bv = 0;
+    for (int i = 0; i < count; ++i) {
+        double s = 1-t[i];
+        aa += weights[i]*s*s, ab += weights[i]*s*t[i], bb += weights[i]*t[i]*t[i];
+        av += weights[i]*s*values[i], bv += weights[i]*t[i]*values[i];
+    }
+    double det = aa*bb-ab*ab;
+    if (fabs(det) < 1e-9)
+        return false;
+    a = (bb*av-ab*bv)/det;
+    b = (aa*bv-ab*av)/det;
+    return true;
+}
+
+size_t blockCompressedSize(int width, int height, int blockSize) {
+    return (size_t) blockSize*((width+3)/4)*((height+3)/4);
+}
+
+/// Loads the pixels of the block at block coordinates (bx, by) of the top-down image, pixels beyond the bitmap repeat its edge
+template <int N>
+static void loadBlock(byte (*pixels)[4], const msdfgen::BitmapConstRef<byte, N> &bitmap, int bx, int by) {
+    for (int y = 0; y < 4; ++y) {
+        int row = bitmap.height-1-std::min(4*by+y, bitmap.height-1);
+        for (int x = 0; x < 4; ++x) {
+            const byte *pixel = bitmap(std::min(4*bx+x, bitmap.width-1), row);
+            for (int c = 0; c < 4; ++c)
+                pixels[4*y+x][c] = c < N ? pixel[c] : byte(255);
+        }
+    }
+}
+
+template <int N>
+static void compressBlocks(byte *output, const msdfgen::BitmapConstRef<byte, N> &bitmap, int blockSize, void (*encodeBlock)(byte *, const byte (*)[4], int), int threadCount) {
+    int blocksX = (bitmap.width+3)/4, blocksY = (bitmap.height+3)/4;
+    Workload([&](int by, int) -> bool {
+        byte pixels[BLOCK_PIXELS][4];
+        for (int bx = 0; bx < blocksX; ++bx) {
+            loadBlock(pixels, bitmap, bx, by);
+            encodeBlock(output+(size_t) blockSize*((size_t) blocksX*by+bx), pixels, N);
+        }
+        return true;
+    }, blocksY).finish(threadCount);
+}
+
+// BC4
+
+static void bc4Palette(int *palette, int r0, int r1) {
+    palette[0] = r0;
+    palette[1] = r1;
+    if (r0 > r1) {
+        for (int i = 1; i <= 6; ++i)
+            palette[i+1] = ((7-i)*r0+i*r1+3)/7;
+    } else {
+        for (int i = 1; i <= 4; ++i)
+            palette[i+1] = ((5-i)*r0+i*r1+2)/5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+/// Assigns the nearest of the eight palette entries to each value and returns the weighted squared error
+static double paletteIndices(int *indices, const int *palette, const double *values, const double *weights) {
+    double error = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        int bestIndex = 0;
+        double bestDiff = fabs(values[i]-palette[0]);
+        for (int j = 1; j < 8; ++j) {
+            double diff = fabs(values[i]-palette[j]);
+            if (diff < bestDiff)
+                bestIndex = j, bestDiff = diff;
+        }
+        indices[i] = bestIndex;
+        error += weights[i]*bestDiff*bestDiff;
+    }
+    return error;
+}
+
+static double bc4Indices(int *indices, const double *values, const double *weights, int r0, int r1) {
+    int palette[8];
+    bc4Palette(palette, r0, r1);
+    return paletteIndices(indices, palette, values, weights);
+}
+
+/// Encodes the specified channel of the pixels as a BC4 block
+static void encodeBC4Channel(byte *output, const byte (*pixels)[4], int channel) {
+    double values[BLOCK_PIXELS], weights[BLOCK_PIXELS];
+    int lo = 255, hi = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        values[i] = pixels[i][channel];
+        weights[i] = distanceWeight(pixels[i][channel]);
+        lo = std::min(lo, (int) pixels[i][channel]);
+        hi = std::max(hi, (int) pixels[i][channel]);
+    }
+    int r0 = hi, r1 = lo;
+    int indices[BLOCK_PIXELS];
+    double error = bc4Indices(indices, values, weights, r0, r1);
+    // Refine endpoints by weighted least squares while the error improves
+    for (int iteration = 0; iteration < ENDPOINT_REFINEMENT_ITERATIONS && error > 0 && r0 > r1; ++iteration) {
+        double t[BLOCK_PIXELS];
+        for (int i = 0; i < BLOCK_PIXELS; ++i)
+            t[i] = indices[i] <= 1 ? indices[i] : (indices[i]-1)/7.;
+        double a, b;
+        if (!fitEndpoints(a, b, t, values, weights, BLOCK_PIXELS))
+            break;
+        int newR0 = clampByte(std::max(a, b)), newR1 = clampByte(std::min(a, b));
+        if (newR0 <= newR1)
+            break;
+        int newIndices[BLOCK_PIXELS];
+        double newError = bc4Indices(newIndices, values, weights, newR0, newR1);
+        if (newError >= error)
+            break;
+        r0 = newR0, r1 = newR1, error = newError;
+        memcpy(indices, newIndices, sizeof(indices));
+    }
+    output[0] = byte(r0);
+    output[1] = byte(r1);
+    unsigned long long bits = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i)
+        bits |= (unsigned long long) indices[i]<<(3*i);
+    for (int i = 0; i < 6; ++i)
+        output[2+i] = byte(bits>>(8*i));
+}
+
+static void encodeBC4Block(byte *output, const byte (*pixels)[4], int) {
+    encodeBC4Channel(output, pixels, 0);
+}
+
+/// BC5 consists of two independent BC4 blocks, one for red and one for green
+static void encodeBC5Block(byte *output, const byte (*pixels)[4], int) {
+    encodeBC4Channel(output, pixels, 0);
+    encodeBC4Channel(output+BC4_BLOCK_SIZE, pixels, 1);
+}
+
+void compressBC4(byte *output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, int threadCount) {
+    compressBlocks(output, bitmap, BC4_BLOCK_SIZE, &encodeBC4Block, threadCount);
+}
+
+void compressBC5(byte *output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, int threadCount) {
+    compressBlocks(output, bitmap, BC5_BLOCK_SIZE, &encodeBC5Block, threadCount);
+}
+
+// EAC R11 (ETC2 family - 8-bit base codeword, 4-bit multiplier, one of 16 modifier tables, and 3-bit indices, decoded to 11 bits)
+
+static const int EAC_MODIFIERS[16][8] = {
+    { -3, -6, -9, -15, 2, 5, 8, 14 },
+    { -3, -7, -10, -13, 2, 6, 9, 12 },
+    { -2, -5, -8, -13, 1, 4, 7, 12 },
+    { -2, -4, -6, -13, 1, 3, 5, 12 },
+    { -3, -6, -8, -12, 2, 5, 7, 11 },
+    { -3, -7, -9, -11, 2, 6, 8, 10 },
+    { -4, -7, -8, -11, 3, 6, 7, 10 },
+    { -3, -5, -8, -11, 2, 4, 7, 10 },
+    { -2, -6, -8, -10, 1, 5, 7, 9 },
+    { -2, -5, -8, -10, 1, 4, 7, 9 },
+    { -2, -4, -8, -10, 1, 3, 7, 9 },
+    { -2, -5, -7, -10, 1, 4, 6, 9 },
+    { -3, -4, -7, -10, 2, 3, 6, 9 },
+    { -1, -2, -3, -10, 0, 1, 2, 9 },
+    { -4, -6, -8, -9, 3, 5, 7, 8 },
+    { -3, -5, -7, -9, 2, 4, 6, 8 }
+};
+
+static double eacIndices(int *indices, const double *values, const double *weights, int base, int multiplier, int table) {
+    int palette[8];
+    for (int j = 0; j < 8; ++j) {
+        // A zero multiplier applies the modifiers unscaled, for finer precision in flat blocks
+        int modifier = multiplier ? 8*multiplier*EAC_MODIFIERS[table][j] : EAC_MODIFIERS[table][j];
+        palette[j] = std::min(std::max(8*base+4+modifier, 0), 2047);
+    }
+    return paletteIndices(indices, palette, values, weights);
+}
+
+/// Encodes the specified channel of the pixels as an EAC R11 block
+static void encodeEACChannel(byte *output, const byte (*pixels)[4], int channel) {
+    double values[BLOCK_PIXELS], weights[BLOCK_PIXELS];
+    double lo = 2047, hi = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        values[i] = 2047/255.*pixels[i][channel];
+        weights[i] = distanceWeight(pixels[i][channel]);
+        lo = std::min(lo, values[i]);
+        hi = std::max(hi, values[i]);
+    }
+    int bestBase = 0, bestMultiplier = 0, bestTable = 0;
+    int bestIndices[BLOCK_PIXELS] = { };
+    double bestError = -1;
+    // For each table, try the multipliers whose modifier span is nearest to the value range, and bases around the one centering them on it
+    for (int table = 0; table < 16 && bestError != 0; ++table) {
+        int minModifier = EAC_MODIFIERS[table][3], maxModifier = EAC_MODIFIERS[table][7];
+        int multiplier0 = std::min((int) ((hi-lo)/(8*(maxModifier-minModifier))), 14);
+        for (int multiplier = multiplier0; multiplier <= multiplier0+1; ++multiplier) {
+            double scale = multiplier ? 8*multiplier : 1;
+            int base0 = clampByte((.5*(lo+hi)-.5*scale*(minModifier+maxModifier)-4)/8);
+            for (int base = std::max(base0-1, 0); base <= std::min(base0+1, 255); ++base) {
+                int indices[BLOCK_PIXELS];
+                double error = eacIndices(indices, values, weights, base, multiplier, table);
+                if (bestError < 0 || error < bestError) {
+                    bestBase = base, bestMultiplier = multiplier, bestTable = table, bestError = error;
+                    memcpy(bestIndices, indices, sizeof(indices));
+                }
+            }
+        }
+    }
+    // The block is a big-endian 64-bit word and its indices go column by column
+    unsigned long long bits = (unsigned long long) bestBase<<56|(unsigned long long) bestMultiplier<<52|(unsigned long long) bestTable<<48;
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 4; ++x)
+            bits |= (unsigned long long) bestIndices[4*y+x]<<(45-3*(4*x+y));
+    }
+    for (int i = 0; i < 8; ++i)
+        output[i] = byte(bits>>(56-8*i));
+}
+
+static void encodeEACR11Block(byte *output, const byte (*pixels)[4], int) {
+    encodeEACChannel(output, pixels, 0);
+}
+
+/// EAC RG11 consists of two independent EAC R11 blocks, one for red and one for green
+static void encodeEACRG11Block(byte *output, const byte (*pixels)[4], int) {
+    encodeEACChannel(output, pixels, 0);
+    encodeEACChannel(output+EAC_R11_BLOCK_SIZE, pixels, 1);
+}
+
+void compressEACR11(byte *output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, int threadCount) {
+    compressBlocks(output, bitmap, EAC_R11_BLOCK_SIZE, &encodeEACR11Block, threadCount);
+}
+
+void compressEACRG11(byte *output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, int threadCount) {
+    compressBlocks(output, bitmap, EAC_RG11_BLOCK_SIZE, &encodeEACRG11Block, threadCount);
+}
+
+// BC7 (mode 6 - single subset, RGBA with 7-bit endpoints, a shared bit per endpoint, and 4-bit indices)
+
+struct BC7Mode6Block {
+    int endpoints[2][4];
+    int pBits[2];
+    int indices[BLOCK_PIXELS];
+    double error;
+};
+
+/// Quantizes an endpoint to 7 bits per channel with the shared least significant bit which minimizes its error
+static void bc7QuantizeEndpoint(int *endpoint, int &pBit, const double *value, int channels) {
+    double bestError = -1;
+    for (int p = 0; p < 2; ++p) {
+        int quantized[4];
+        double error = 0;
+        for (int c = 0; c < channels; ++c) {
+            quantized[c] = clampByte(.5*(value[c]-p), 127);
+            double diff = value[c]-(quantized[c]<<1|p);
+            error += diff*diff;
+        }
+        if (bestError < 0 || error < bestError) {
+            bestError = error;
+            pBit = p;
+            for (int c = 0; c < channels; ++c)
+                endpoint[c] = quantized[c];
+        }
+    }
+    for (int c = channels; c < 4; ++c)
+        endpoint[c] = 127;
+}
+
+/// Quantizes the endpoints and assigns the nearest interpolated color to each pixel
+static void bc7EvaluateBlock(BC7Mode6Block &block, const double (*endpoints)[4], const byte (*pixels)[4], const double (*weights)[4], int channels) {
+    bc7QuantizeEndpoint(block.endpoints[0], block.pBits[0], endpoints[0], channels);
+    bc7QuantizeEndpoint(block.endpoints[1], block.pBits[1], endpoints[1], channels);
+    int palette[16][4];
+    for (int c = 0; c < channels; ++c) {
+        int e0 = block.endpoints[0][c]<<1|block.pBits[0];
+        int e1 = block.endpoints[1][c]<<1|block.pBits[1];
+        for (int k = 0; k < 16; ++k)
+            palette[k][c] = ((64-BC7_WEIGHTS[k])*e0+BC7_WEIGHTS[k]*e1+32)>>6;
+    }
+    block.error = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        int bestIndex = 0;
+        double bestError = -1;
+        for (int k = 0; k < 16; ++k) {
+            double error = 0;
+            for (int c = 0; c < channels; ++c) {
+                int diff = palette[k][c]-pixels[i][c];
+                error += weights[i][c]*diff*diff;
+            }
+            if (bestError < 0 || error < bestError)
+                bestIndex = k, bestError = error;
+        }
+        block.indices[i] = bestIndex;
+        block.error += bestError;
+    }
+}
+
+static void bc7PutBits(byte *output, int &position, int value, int bitCount) {
+    for (int i = 0; i < bitCount; ++i, ++position) {
+        if (value>>i&1)
+            output[position>>3] |= byte(1<<(position&7));
+    }
+}
+
+static void encodeBC7Block(byte *output, const byte (*pixels)[4], int channels) {
+    // Each channel is an independent distance (of the same glyph in MSDF, of different glyphs if channel-packed), so its error is weighted by its own proximity to the edge
+    double weights[BLOCK_PIXELS][4], pixelWeights[BLOCK_PIXELS];
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        pixelWeights[i] = 0;
+        for (int c = 0; c < channels; ++c)
+            pixelWeights[i] += weights[i][c] = distanceWeight(pixels[i][c]);
+    }
+
+    // Principal axis of the weighted pixel colors
+    double mean[4] = { }, totalWeight = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        for (int c = 0; c < channels; ++c)
+            mean[c] += pixelWeights[i]*pixels[i][c];
+        totalWeight += pixelWeights[i];
+    }
+    for (int c = 0; c < channels; ++c)
+        mean[c] /= totalWeight;
+    double covariance[4][4] = { };
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        for (int c = 0; c < channels; ++c) {
+            for (int d = 0; d < channels; ++d)
+                covariance[c][d] += pixelWeights[i]*(pixels[i][c]-mean[c])*(pixels[i][d]-mean[d]);
+        }
+    }
+    double axis[4] = { 1, 1, 1, 1 };
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        double next[4] = { }, length = 0;
+        for (int c = 0; c < channels; ++c) {
+            for (int d = 0; d < channels; ++d)
+                next[c] += covariance[c][d]*axis[d];
+            length += next[c]*next[c];
+        }
+        if (length < 1e-12)
+            break;
+        length = sqrt(length);
+        for (int c = 0; c < channels; ++c)
+            axis[c] = next[c]/length;
+    }
+
+    // Initial endpoints span the projection of the pixels onto the axis
+    double lo = 0, hi = 0;
+    for (int i = 0; i < BLOCK_PIXELS; ++i) {
+        double t = 0;
+        for (int c = 0; c < channels; ++c)
+            t += (pixels[i][c]-mean[c])*axis[c];
+        lo = std::min(lo, t);
+        hi = std::max(hi, t);
+    }
+    double endpoints[2][4] = { };
+    for (int c = 0; c < channels; ++c) {
+        endpoints[0][c] = std::min(std::max(mean[c]+lo*axis[c], 0.), 255.);
+        endpoints[1][c] = std::min(std::max(mean[c]+hi*axis[c], 0.), 255.);
+    }
+    BC7Mode6Block block;
+    bc7EvaluateBlock(block, endpoints, pixels, weights, channels);
+
+    // Refine endpoints by weighted least squares while the error improves
+    for (int iteration = 0; iteration < ENDPOINT_REFINEMENT_ITERATIONS && block.error > 0; ++iteration) {
+        double t[BLOCK_PIXELS], values[BLOCK_PIXELS], channelWeights[BLOCK_PIXELS];
+        for (int i = 0; i < BLOCK_PIXELS; ++i)
+            t[i] = BC7_WEIGHTS[block.indices[i]]/64.;
+        bool fitted = true;
+        for (int c = 0; c < channels && fitted; ++c) {
+            for (int i = 0; i < BLOCK_PIXELS; ++i) {
+                values[i] = pixels[i][c];
+                channelWeights[i] = weights[i][c];
+            }
+            double a, b;
+            if ((fitted = fitEndpoints(a, b, t, values, channelWeights, BLOCK_PIXELS))) {
+                endpoints[0][c] = std::min(std::max(a, 0.), 255.);
+                endpoints[1][c] = std::min(std::max(b, 0.), 255.);
+            }
+        }
+        if (!fitted)
+            break;
+        BC7Mode6Block refined;
+        bc7EvaluateBlock(refined, endpoints, pixels, weights, channels);
+        if (refined.error >= block.error)
+            break;
+        block = refined;
+    }
+
+    // The most significant bit of the first index is implicitly zero, which is ensured by swapping the endpoints
+    if (block.indices[0] >= 8) {
+        for (int c = 0; c < 4; ++c)
+            std::swap(block.endpoints[0][c], block.endpoints[1][c]);
+        std::swap(block.pBits[0], block.pBits[1]);
+        for (int i = 0; i < BLOCK_PIXELS; ++i)
+            block.indices[i] = 15-block.indices[i];
+    }
+    memset(output, 0, BC7_BLOCK_SIZE);
+    int position = 0;
+    bc7PutBits(output, position, 1<<6, 7);
+    for (int c = 0; c < 4; ++c) {
+        bc7PutBits(output, position, block.endpoints[0][c], 7);
+        bc7PutBits(output, position, block.endpoints[1][c], 7);
+    }
+    bc7PutBits(output, position, block.pBits[0], 1);
+    bc7PutBits(output, position, block.pBits[1], 1);
+    bc7PutBits(output, position, block.indices[0], 3);
+    for (int i = 1; i < BLOCK_PIXELS; ++i)
+        bc7PutBits(output, position, block.indices[i], 4);
+}
+
+void compressBC7(byte *output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, int threadCount) {
+    compressBlocks(output, bitmap, BC7_BLOCK_SIZE, &encodeBC7Block, threadCount);
+}
+
+void compressBC7(byte *output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, int threadCount) {
+    compressBlocks(output, bitmap, BC7_BLOCK_SIZE, &encodeBC7Block, threadCount);
+}
+
+}
@@ -0,0 +1,34 @@
+
+#pragma once
+
+#include <cstddef>
+#include <msdfgen.h>
+#include "types.h"
+
+#define BC4_BLOCK_SIZE 8
+#define BC5_BLOCK_SIZE 16
+#define BC7_BLOCK_SIZE 16
+#define EAC_R11_BLOCK_SIZE 8
+#define EAC_RG11_BLOCK_SIZE 16
+
+namespace msdf_atlas {
+
+// CPU encoders of GPU block-compressed texture formats, tuned for distance fields (errors near the edge value are weighted more heavily)
+// The output blocks are stored top-down, rows of blocks are compressed in parallel
+
+/// Returns the size in bytes of an image compressed into blocks of 4x4 pixels
+size_t blockCompressedSize(int width, int height, int blockSize);
+/// Compresses a single-channel bitmap as BC4 (8 bytes per block)
+void compressBC4(byte *output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, int threadCount = 1);
+/// Compresses the red and green channels of an RGBA bitmap as BC5 (16 bytes per block)
+void compressBC5(byte *output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, int threadCount = 1);
+/// Compresses an RGB bitmap as BC7 (16 bytes per block), the output alpha channel is not meaningful
+void compressBC7(byte *output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, int threadCount = 1);
+/// Compresses an RGBA bitmap as BC7 (16 bytes per block)
+void compressBC7(byte *output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, int threadCount = 1);
+/// Compresses a single-channel bitmap as EAC R11 (8 bytes per block)
+void compressEACR11(byte *output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, int threadCount = 1);
+/// Compresses the red and green channels of an RGBA bitmap as EAC RG11 (16 bytes per block)
+void compressEACRG11(byte *output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, int threadCount = 1);
+
+}
@@ -2,6 +2,7 @@
 #include "Charset.h"
 
 #include <cstdio>
+#include <algorithm>
 #include <string>
 #include "utf8.h"
 
@@ -86,7 +87,17 @@ static bool readString(void *userData, std::string &str, char terminator) {
     }
 }
 
-template <int (READ_CHAR)(void *), void (ADD)(void *, unicode_t), bool (INCLUDE)(void *, const std::string &)>
+/// Adds codepoints of a string literal as consecutive ranges, reordering the buffer in the process
+template <void (ADD)(void *, unicode_t, unicode_t)>
+static void addCodepoints(void *userData, std::vector<unicode_t> &codepoints) {
+    std::sort(codepoints.begin(), codepoints.end());
+    for (size_t i = 0, j; i < codepoints.size(); i = j) {
+        for (j = i+1; j < codepoints.size() && codepoints[j]-codepoints[j-1] <= 1; ++j);
+        ADD(userData, codepoints[i], codepoints[j-1]);
+    }
+}
+
+template <int (READ_CHAR)(void *), void (ADD)(void *, unicode_t, unicode_t), bool (INCLUDE)(void *, const std::string &)>
 static bool charsetParse(void *userData, bool disableCharLiterals, bool disableInclude) {
 
     enum {
@@ -115,7 +126,7 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                     switch (state) {
                         case CLEAR:
                             if (cp >= 0)
-                                ADD(userData, (unicode_t) cp);
+                                ADD(userData, (unicode_t) cp, (unicode_t) cp);
                             state = TIGHT;
                             break;
                         case RANGE_BRACKET:
@@ -123,8 +134,8 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                             state = RANGE_START;
                             break;
                         case RANGE_SEPARATOR:
-                            for (unicode_t u = rangeStart; (int) u <= cp; ++u)
-                                ADD(userData, u);
+                            if (cp >= 0)
+                                ADD(userData, rangeStart, (unicode_t) cp);
                             state = RANGE_END;
                             break;
                         default:;
@@ -142,7 +153,7 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                     switch (state) {
                         case CLEAR:
                             if (unicodeBuffer[0] > 0)
-                                ADD(userData, unicodeBuffer[0]);
+                                ADD(userData, unicodeBuffer[0], unicodeBuffer[0]);
                             state = TIGHT;
                             break;
                         case RANGE_BRACKET:
@@ -150,8 +161,7 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                             state = RANGE_START;
                             break;
                         case RANGE_SEPARATOR:
-                            for (unicode_t u = rangeStart; u <= unicodeBuffer[0]; ++u)
-                                ADD(userData, u);
+                            ADD(userData, rangeStart, unicodeBuffer[0]);
                             state = RANGE_END;
                             break;
                         default:;
@@ -167,8 +177,7 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                 if (!readString<READ_CHAR>(userData, buffer, '"'))
                     return false;
                 utf8Decode(unicodeBuffer, buffer.c_str());
-                for (unicode_t cp : unicodeBuffer)
-                    ADD(userData, cp);
+                addCodepoints<ADD>(userData, unicodeBuffer);
                 unicodeBuffer.clear();
                 buffer.clear();
                 state = TIGHT;
@@ -188,7 +197,7 @@ static bool charsetParse(void *userData, bool disableCharLiterals, bool disableI
                 if (state != CLEAR)
                     return false;
                 c = readWord<READ_CHAR>(userData, buffer);
-                if (buffer == "include") {
+                if (buffer == "include" && !disableInclude) {
                     while (c == ' ' || c == '\t' || c == '\n' || c == '\r')
                         c = READ_CHAR(userData);
                     if (c != '"')
@@ -251,8 +260,8 @@ struct CharsetLoadData {
         return fgetc(reinterpret_cast<CharsetLoadData *>(userData)->file);
     }
 
-    static void add(void *userData, unicode_t cp) {
-        reinterpret_cast<CharsetLoadData *>(userData)->charset->add(cp);
+    static void add(void *userData, unicode_t first, unicode_t last) {
+        reinterpret_cast<CharsetLoadData *>(userData)->charset->add(first, last);
     }
 
     static bool include(void *userData, const std::string &path) {
@@ -280,8 +289,8 @@ struct CharsetParseData {
         return ud.cur < ud.end ? (int) (unsigned char) *ud.cur++ : -1;
     }
 
-    static void add(void *userData, unicode_t cp) {
-        reinterpret_cast<CharsetParseData *>(userData)->charset->add(cp);
+    static void add(void *userData, unicode_t first, unicode_t last) {
+        reinterpret_cast<CharsetParseData *>(userData)->charset->add(first, last);
     }
 
     static bool include(void *, const std::string &) {
@@ -0,0 +1,47 @@
+
+#include "Charset.h"
+
+#include <vector>
+#include "utf8.h"
+#include "text-decoding.h"
+
+namespace msdf_atlas {
+
+void Charset::addText(const char *utf8, size_t length, int threadCount) {
+    if (!length)
+        return;
+    threadCount = textChunkThreadCount(length, threadCount);
+    // Each thread marks codepoints in its own bit set
+    std::vector<std::vector<uint64_t> > threadCodepointBits(threadCount, std::vector<uint64_t>(UNICODE_CODEPOINT_COUNT/64));
+    decodeTextChunks(utf8, length, threadCount, [&threadCodepointBits](const char *chunk, size_t chunkLength, int threadNo) {
+        utf8MarkCodepoints(threadCodepointBits[threadNo].data(), chunk, chunkLength);
+    });
+    std::vector<uint64_t> &codepointBits = threadCodepointBits[0];
+    for (int i = 1; i < threadCount; ++i)
+        for (size_t j = 0; j < codepointBits.size(); ++j)
+            codepointBits[j] |= threadCodepointBits[i][j];
+    // Exclude control characters (U+0000 - U+001F, U+007F - U+009F)
+    codepointBits[0] &= ~(uint64_t) 0xffffffffu;
+    codepointBits[1] &= ~((uint64_t) 1<<63);
+    codepointBits[2] &= ~(uint64_t) 0xffffffffu;
+    // Convert bit set to ranges
+    Charset textCharset;
+    for (size_t j = 0; j < codepointBits.size(); ++j) {
+        if (uint64_t word = codepointBits[j]) {
+            for (int k = 0; k < 64; ++k)
+                if (word&(uint64_t) 1<<k)
+                    textCharset.add(unicode_t(64*j+k));
+        }
+    }
+    add(textCharset);
+}
+
+bool Charset::loadText(const char *filename, int threadCount) {
+    MappedFile file;
+    if (!mapTextFile(file, filename))
+        return false;
+    addText(reinterpret_cast<const char *>(file.data()), file.size(), threadCount);
+    return true;
+}
+
+}
@@ -0,0 +1,99 @@
+
+#include "codepoint-frequencies.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "utf8.h"
+#include "text-decoding.h"
+
+namespace msdf_atlas {
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static bool parseFrequencyLine(unicode_t &codepoint, double &frequency, const char *line) {
+    const char *cur = line;
+    if (*cur == '\'') {
+        const char *end = strchr(cur+1, '\'');
+        if (!end)
+            return false;
+        std::vector<unicode_t> codepoints;
+        utf8Decode(codepoints, std::string(cur+1, end).c_str());
+        if (codepoints.size() != 1)
+            return false;
+        codepoint = codepoints[0];
+        cur = end+1;
+    } else {
+        char *end = nullptr;
+        if (cur[0] == '0' && (cur[1] == 'x' || cur[1] == 'X'))
+            codepoint = (unicode_t) strtoul(cur+2, &end, 16);
+        else
+            codepoint = (unicode_t) strtoul(cur, &end, 10);
+        if (end == cur || !isSpace(*end))
+            return false;
+        cur = end;
+    }
+    char *end = nullptr;
+    frequency = strtod(cur, &end);
+    if (end == cur)
+        return false;
+    for (cur = end; isSpace(*cur); ++cur);
+    return !*cur && frequency >= 0;
+}
+
+bool loadCodepointFrequencies(std::map<unicode_t, double> &frequencies, const char *filename) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        return false;
+    bool success = true;
+    std::string line;
+    for (int c = fgetc(f); success; c = fgetc(f)) {
+        if (c < 0 || c == '\n') {
+            size_t start = 0;
+            while (start < line.size() && isSpace(line[start]))
+                ++start;
+            if (start < line.size()) {
+                unicode_t codepoint;
+                double frequency;
+                if (parseFrequencyLine(codepoint, frequency, line.c_str()+start))
+                    frequencies[codepoint] += frequency;
+                else
+                    success = false;
+            }
+            line.clear();
+            if (c < 0)
+                break;
+        } else
+            line.push_back((char) c);
+    }
+    fclose(f);
+    return success;
+}
+
+bool countCodepointFrequencies(std::map<unicode_t, double> &frequencies, const char *filename, int threadCount) {
+    MappedFile file;
+    if (!mapTextFile(file, filename))
+        return false;
+    const char *text = reinterpret_cast<const char *>(file.data());
+    size_t length = file.size();
+    threadCount = textChunkThreadCount(length, threadCount);
+    // Each thread counts codepoints in its own array
+    std::vector<std::vector<uint32_t> > threadCodepointCounts(threadCount, std::vector<uint32_t>(UNICODE_CODEPOINT_COUNT));
+    decodeTextChunks(text, length, threadCount, [&threadCodepointCounts](const char *chunk, size_t chunkLength, int threadNo) {
+        utf8CountCodepoints(threadCodepointCounts[threadNo].data(), chunk, chunkLength);
+    });
+    for (unicode_t cp = 0; cp < UNICODE_CODEPOINT_COUNT; ++cp) {
+        double count = 0;
+        for (const std::vector<uint32_t> &codepointCounts : threadCodepointCounts)
+            count += codepointCounts[cp];
+        if (count > 0)
+            frequencies[cp] += count;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,14 @@
+
+#pragma once
+
+#include <map>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// Loads codepoint frequencies from a text file where each line consists of a codepoint (decimal or hexadecimal number or a 'character' literal) followed by its frequency
+bool loadCodepointFrequencies(std::map<unicode_t, double> &frequencies, const char *filename);
+/// Adds the number of occurrences of each codepoint in a UTF-8 encoded text file (e.g. a text corpus) to frequencies, the text is decoded in parallel chunks
+bool countCodepointFrequencies(std::map<unicode_t, double> &frequencies, const char *filename, int threadCount = 1);
+
+}
@@ -1,45 +1,72 @@
 
 #include "csv-export.h"
 
-#include <cstdio>
+#include <string>
+#include <vector>
 #include "GlyphGeometry.h"
+#include "Workload.h"
+#include "BufferedFileWriter.h"
+#include "number-format.h"
 
 namespace msdf_atlas {
 
-bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename) {
-    FILE *f = fopen(filename, "w");
-    if (!f)
-        return false;
+static void appendBounds(std::string &csv, double l, double b, double r, double t) {
+    appendDouble(csv, l), csv += ',';
+    appendDouble(csv, b), csv += ',';
+    appendDouble(csv, r), csv += ',';
+    appendDouble(csv, t);
+}
 
-    for (int i = 0; i < fontCount; ++i) {
-        for (const GlyphGeometry &glyph : fonts[i].getGlyphs()) {
-            double l, b, r, t;
-            if (fontCount > 1)
-                fprintf(f, "%d,", i);
-            fprintf(f, "%d,%.17g,", glyph.getIdentifier(fonts[i].getPreferredIdentifierType()), glyph.getAdvance());
-            glyph.getQuadPlaneBounds(l, b, r, t);
-            switch (yDirection) {
-                case YDirection::BOTTOM_UP:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, b, r, t);
-                    break;
-                case YDirection::TOP_DOWN:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g,", l, -t, r, -b);
-                    break;
-            }
-            glyph.getQuadAtlasBounds(l, b, r, t);
-            switch (yDirection) {
-                case YDirection::BOTTOM_UP:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, b, r, t);
-                    break;
-                case YDirection::TOP_DOWN:
-                    fprintf(f, "%.17g,%.17g,%.17g,%.17g\n", l, atlasHeight-t, r, atlasHeight-b);
-                    break;
-            }
+static std::string fontCSV(const FontGeometry &font, int fontIndex, int fontCount, int atlasHeight, YDirection yDirection, bool multiPage, int packedChannelCount) {
+    std::string csv;
+    csv.reserve(96*font.getGlyphs().size());
+    for (const GlyphGeometry &glyph : font.getGlyphs()) {
+        double l, b, r, t;
+        if (fontCount > 1)
+            appendInt(csv, fontIndex), csv += ',';
+        appendInt(csv, glyph.getIdentifier(font.getPreferredIdentifierType())), csv += ',';
+        appendDouble(csv, glyph.getAdvance()), csv += ',';
+        glyph.getQuadPlaneBounds(l, b, r, t);
+        switch (yDirection) {
+            case YDirection::BOTTOM_UP:
+                appendBounds(csv, l, b, r, t);
+                break;
+            case YDirection::TOP_DOWN:
+                appendBounds(csv, l, -t, r, -b);
+                break;
+        }
+        csv += ',';
+        glyph.getQuadAtlasBounds(l, b, r, t);
+        switch (yDirection) {
+            case YDirection::BOTTOM_UP:
+                appendBounds(csv, l, b, r, t);
+                break;
+            case YDirection::TOP_DOWN:
+                appendBounds(csv, l, atlasHeight-t, r, atlasHeight-b);
+                break;
         }
+        if (multiPage)
+            csv += ',', appendInt(csv, glyph.getBoxPage());
+        if (packedChannelCount > 1)
+            csv += ',', appendInt(csv, glyph.getBoxChannel());
+        csv += '\n';
     }
+    return csv;
+}
+
+bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasHeight, YDirection yDirection, const char *filename, bool multiPage, int packedChannelCount, int threadCount) {
+    std::vector<std::string> fontStrings(fontCount);
+    Workload([&](int i, int) -> bool {
+        fontStrings[i] = fontCSV(fonts[i], i, fontCount, atlasHeight, yDirection, multiPage, packedChannelCount);
+        return true;
+    }, fontCount).finish(threadCount);
 
-    fclose(f);
-    return true;
+    BufferedFileWriter writer;
+    if (!writer.open(filename, true))
+        return false;
+    for (const std::string &fontString : fontStrings)
+        writer.write(fontString.data(), fontString.size());
+    return writer.close();
 }
 
 }
@@ -7,8 +7,9 @@ namespace msdf_atlas {
 
 /**
  * Writes the positioning data and atlas layout of the glyphs into a CSV file
- * The columns are: font variant index (if fontCount > 1), glyph identifier (index or Unicode), horizontal advance, plane bounds (l, b, r, t), atlas bounds (l, b, r, t)
+ * The columns are: font variant index (if fontCount > 1), glyph identifier (index or Unicode), horizontal advance, plane bounds (l, b, r, t), atlas bounds (l, b, r, t), atlas page index (if multiPage), image channel index (if packedChannelCount > 1)
+ * Each font is formatted on a separate thread (up to threadCount threads)
  */
-bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasWidth, int atlasHeight, YDirection yDirection, const char *filename);
+bool exportCSV(const FontGeometry *fonts, int fontCount, int atlasHeight, YDirection yDirection, const char *filename, bool multiPage = false, int packedChannelCount = 1, int threadCount = 1);
 
 }
@@ -0,0 +1,284 @@
+
+#include "font-kerning.h"
+
+#include <set>
+#include <algorithm>
+
+namespace msdf_atlas {
+
+#define SFNT_TAG(a, b, c, d) ((unsigned) (a)<<24|(unsigned) (b)<<16|(unsigned) (c)<<8|(unsigned) (d))
+
+/// Bounds-checked big-endian reader - reads past the end of data return zero
+class FontDataReader {
+
+public:
+    inline FontDataReader(const byte *data, size_t length) : data(data), length(length) { }
+    inline unsigned u16(size_t offset) const {
+        return offset+2 <= length ? (unsigned) data[offset]<<8|(unsigned) data[offset+1] : 0u;
+    }
+    inline int s16(size_t offset) const {
+        return (int) (short) u16(offset);
+    }
+    inline unsigned u32(size_t offset) const {
+        return offset+4 <= length ? (unsigned) data[offset]<<24|(unsigned) data[offset+1]<<16|(unsigned) data[offset+2]<<8|(unsigned) data[offset+3] : 0u;
+    }
+    inline size_t size() const {
+        return length;
+    }
+
+private:
+    const byte *data;
+    size_t length;
+
+};
+
+struct KerningContext {
+    const FontDataReader &font;
+    const std::vector<bool> &glyphFilter;
+    std::map<std::pair<int, int>, int> &output;
+    std::vector<int> glyphs;
+};
+
+static bool isGlyphLoaded(const KerningContext &ctx, unsigned glyph) {
+    return glyph < ctx.glyphFilter.size() && ctx.glyphFilter[glyph];
+}
+
+static int valueRecordSize(unsigned valueFormat) {
+    int size = 0;
+    for (; valueFormat; valueFormat >>= 1)
+        size += 2*(valueFormat&1);
+    return size;
+}
+
+static int valueRecordXAdvance(const FontDataReader &font, size_t offset, unsigned valueFormat) {
+    if (valueFormat&0x0004)
+        return font.s16(offset+valueRecordSize(valueFormat&0x0003));
+    return 0;
+}
+
+/// Calls fn(glyph, coverageIndex) for each loaded glyph in coverage table
+template <typename FN>
+static void forEachCoveredGlyph(const KerningContext &ctx, size_t coverage, FN fn) {
+    const FontDataReader &font = ctx.font;
+    switch (font.u16(coverage)) {
+        case 1:
+            for (unsigned i = 0, count = font.u16(coverage+2); i < count; ++i) {
+                unsigned glyph = font.u16(coverage+4+2*i);
+                if (isGlyphLoaded(ctx, glyph))
+                    fn(glyph, i);
+            }
+            break;
+        case 2:
+            // Ranges past the end of data are skipped and only loaded glyphs are visited, so malformed ranges can't inflate the work
+            for (unsigned i = 0, count = font.u16(coverage+2); i < count && coverage+4+6*i+6 <= font.size(); ++i) {
+                size_t range = coverage+4+6*i;
+                unsigned start = font.u16(range), end = font.u16(range+2), startIndex = font.u16(range+4);
+                for (std::vector<int>::const_iterator it = std::lower_bound(ctx.glyphs.begin(), ctx.glyphs.end(), (int) start); it != ctx.glyphs.end() && (unsigned) *it <= end; ++it)
+                    fn((unsigned) *it, startIndex+((unsigned) *it-start));
+            }
+            break;
+    }
+}
+
+/// Outputs the class of each loaded glyph (in the order of ctx.glyphs)
+static void readClassDef(std::vector<unsigned> &classes, const KerningContext &ctx, size_t classDef) {
+    const FontDataReader &font = ctx.font;
+    classes.assign(ctx.glyphs.size(), 0);
+    std::vector<int>::const_iterator begin = ctx.glyphs.begin();
+    switch (font.u16(classDef)) {
+        case 1: {
+            unsigned start = font.u16(classDef+2), count = font.u16(classDef+4);
+            for (std::vector<int>::const_iterator it = std::lower_bound(begin, ctx.glyphs.end(), (int) start); it != ctx.glyphs.end() && (unsigned) *it < start+count; ++it)
+                classes[it-begin] = font.u16(classDef+6+2*(*it-start));
+            break;
+        }
+        case 2:
+            for (unsigned i = 0, count = font.u16(classDef+2); i < count; ++i) {
+                size_t range = classDef+4+6*i;
+                unsigned start = font.u16(range), end = font.u16(range+2), value = font.u16(range+4);
+                for (std::vector<int>::const_iterator it = std::lower_bound(begin, ctx.glyphs.end(), (int) start); it != ctx.glyphs.end() && (unsigned) *it <= end; ++it)
+                    classes[it-begin] = value;
+            }
+            break;
+    }
+}
+
+/// State of a single lookup - a pair is only adjusted by the first subtable that applies to it
+struct LookupState {
+    std::set<std::pair<int, int> > appliedPairs;
+    std::set<int> appliedFirstGlyphs;
+};
+
+static void readPairPosFormat1(const KerningContext &ctx, LookupState &state, size_t subtable) {
+    const FontDataReader &font = ctx.font;
+    unsigned valueFormat1 = font.u16(subtable+4), valueFormat2 = font.u16(subtable+6);
+    unsigned pairSetCount = font.u16(subtable+8);
+    size_t recordSize = 2+valueRecordSize(valueFormat1)+valueRecordSize(valueFormat2);
+    forEachCoveredGlyph(ctx, subtable+font.u16(subtable+2), [&](unsigned first, unsigned coverageIndex) {
+        if (coverageIndex >= pairSetCount || state.appliedFirstGlyphs.count(first))
+            return;
+        size_t pairSet = subtable+font.u16(subtable+10+2*coverageIndex);
+        for (unsigned i = 0, count = font.u16(pairSet); i < count; ++i) {
+            size_t record = pairSet+2+recordSize*i;
+            unsigned second = font.u16(record);
+            // The pair is marked as applied even without a horizontal advance adjustment, since it blocks later subtables
+            if (isGlyphLoaded(ctx, second) && state.appliedPairs.insert(std::make_pair((int) first, (int) second)).second) {
+                if (int value = valueRecordXAdvance(font, record+2, valueFormat1))
+                    ctx.output[std::make_pair((int) first, (int) second)] += value;
+            }
+        }
+    });
+}
+
+static void readPairPosFormat2(const KerningContext &ctx, LookupState &state, size_t subtable) {
+    const FontDataReader &font = ctx.font;
+    unsigned valueFormat1 = font.u16(subtable+4), valueFormat2 = font.u16(subtable+6);
+    unsigned class1Count = font.u16(subtable+12), class2Count = font.u16(subtable+14);
+    size_t class2RecordSize = valueRecordSize(valueFormat1)+valueRecordSize(valueFormat2);
+    std::vector<unsigned> classes1, classes2;
+    readClassDef(classes1, ctx, subtable+font.u16(subtable+8));
+    readClassDef(classes2, ctx, subtable+font.u16(subtable+10));
+    // Group loaded second glyphs by class
+    std::vector<std::vector<int> > class2Glyphs(class2Count);
+    for (size_t i = 0; i < ctx.glyphs.size(); ++i) {
+        if (classes2[i] < class2Count)
+            class2Glyphs[classes2[i]].push_back(ctx.glyphs[i]);
+    }
+    forEachCoveredGlyph(ctx, subtable+font.u16(subtable+2), [&](unsigned first, unsigned) {
+        // Once a format 2 subtable covers the first glyph, it applies to all pairs starting with it
+        if (!state.appliedFirstGlyphs.insert((int) first).second)
+            return;
+        unsigned class1 = classes1[std::lower_bound(ctx.glyphs.begin(), ctx.glyphs.end(), (int) first)-ctx.glyphs.begin()];
+        if (class1 >= class1Count)
+            return;
+        size_t class1Record = subtable+16+class1*class2Count*class2RecordSize;
+        for (unsigned class2 = 0; class2 < class2Count; ++class2) {
+            if (int value = valueRecordXAdvance(font, class1Record+class2*class2RecordSize, valueFormat1)) {
+                for (int second : class2Glyphs[class2]) {
+                    if (!state.appliedPairs.count(std::make_pair((int) first, second)))
+                        ctx.output[std::make_pair((int) first, second)] += value;
+                }
+            }
+        }
+    });
+}
+
+static bool readGposKerning(const KerningContext &ctx, size_t gpos) {
+    const FontDataReader &font = ctx.font;
+    if (font.u16(gpos) != 1)
+        return false;
+    size_t featureList = gpos+font.u16(gpos+6), lookupList = gpos+font.u16(gpos+8);
+    // Collect lookups of the kern feature (of any script and language)
+    std::set<unsigned> lookupIndices;
+    for (unsigned i = 0, count = font.u16(featureList); i < count; ++i) {
+        size_t record = featureList+2+6*i;
+        if (font.u32(record) == SFNT_TAG('k', 'e', 'r', 'n')) {
+            size_t feature = featureList+font.u16(record+4);
+            for (unsigned j = 0, lookupCount = font.u16(feature+2); j < lookupCount; ++j)
+                lookupIndices.insert(font.u16(feature+4+2*j));
+        }
+    }
+    if (lookupIndices.empty())
+        return false;
+    // Pair adjustment values of distinct lookups accumulate
+    for (unsigned lookupIndex : lookupIndices) {
+        if (lookupIndex >= font.u16(lookupList))
+            continue;
+        size_t lookup = lookupList+font.u16(lookupList+2+2*lookupIndex);
+        unsigned lookupType = font.u16(lookup);
+        LookupState state;
+        for (unsigned i = 0, subtableCount = font.u16(lookup+4); i < subtableCount; ++i) {
+            size_t subtable = lookup+font.u16(lookup+6+2*i);
+            unsigned subtableType = lookupType;
+            if (lookupType == 9 && font.u16(subtable) == 1) {
+                subtableType = font.u16(subtable+2);
+                subtable += font.u32(subtable+4);
+            }
+            if (subtableType != 2)
+                continue;
+            switch (font.u16(subtable)) {
+                case 1:
+                    readPairPosFormat1(ctx, state, subtable);
+                    break;
+                case 2:
+                    readPairPosFormat2(ctx, state, subtable);
+                    break;
+            }
+        }
+    }
+    return true;
+}
+
+static void readKernPairs(const KerningContext &ctx, size_t pairs, unsigned pairCount, bool override) {
+    const FontDataReader &font = ctx.font;
+    for (unsigned i = 0; i < pairCount; ++i) {
+        size_t pair = pairs+6*i;
+        unsigned first = font.u16(pair), second = font.u16(pair+2);
+        if (isGlyphLoaded(ctx, first) && isGlyphLoaded(ctx, second)) {
+            if (override)
+                ctx.output[std::make_pair((int) first, (int) second)] = font.s16(pair+4);
+            else
+                ctx.output[std::make_pair((int) first, (int) second)] += font.s16(pair+4);
+        }
+    }
+}
+
+static void readKernTable(const KerningContext &ctx, size_t kern, size_t kernEnd) {
+    const FontDataReader &font = ctx.font;
+    if (font.u16(kern) == 0) {
+        // Microsoft / OpenType version
+        size_t subtable = kern+4;
+        for (unsigned i = 0, count = font.u16(kern+2); i < count && subtable < kernEnd; ++i) {
+            unsigned coverage = font.u16(subtable+4);
+            unsigned pairCount = font.u16(subtable+6);
+            // Only horizontal, non-minimum, non-cross-stream format 0 subtables
+            if ((coverage&0xff07) == 0x0001)
+                readKernPairs(ctx, subtable+14, pairCount, (coverage&0x0008) != 0);
+            // The 16-bit length field overflows for large format 0 subtables
+            subtable += (coverage>>8) == 0 ? 14+6*pairCount : font.u16(subtable+2);
+        }
+    } else if (font.u32(kern) == 0x00010000u) {
+        // Apple version
+        size_t subtable = kern+8;
+        for (unsigned i = 0, count = font.u32(kern+4); i < count && subtable < kernEnd; ++i) {
+            unsigned length = font.u32(subtable);
+            unsigned coverage = font.u16(subtable+4);
+            // Only horizontal, non-cross-stream, non-variation format 0 subtables
+            if ((coverage&0xe0ff) == 0)
+                readKernPairs(ctx, subtable+16, font.u16(subtable+8), false);
+            if (!length)
+                break;
+            subtable += length;
+        }
+    }
+}
+
+bool readFontKerning(std::map<std::pair<int, int>, int> &output, const byte *fontData, size_t length, const std::vector<bool> &glyphFilter) {
+    FontDataReader font(fontData, length);
+    size_t tableDirectory = 0;
+    if (font.u32(0) == SFNT_TAG('t', 't', 'c', 'f'))
+        tableDirectory = font.u32(12);
+    unsigned sfntVersion = font.u32(tableDirectory);
+    if (!(sfntVersion == 0x00010000u || sfntVersion == SFNT_TAG('O', 'T', 'T', 'O') || sfntVersion == SFNT_TAG('t', 'r', 'u', 'e')))
+        return false;
+    size_t gpos = 0, kern = 0, kernEnd = 0;
+    for (unsigned i = 0, count = font.u16(tableDirectory+4); i < count; ++i) {
+        size_t record = tableDirectory+12+16*i;
+        size_t offset = font.u32(record+8);
+        if (font.u32(record) == SFNT_TAG('G', 'P', 'O', 'S'))
+            gpos = offset;
+        else if (font.u32(record) == SFNT_TAG('k', 'e', 'r', 'n'))
+            kern = offset, kernEnd = offset+font.u32(record+12);
+    }
+    KerningContext ctx = { font, glyphFilter, output, std::vector<int>() };
+    for (size_t i = 0; i < glyphFilter.size(); ++i) {
+        if (glyphFilter[i])
+            ctx.glyphs.push_back((int) i);
+    }
+    // As in common shaping engines, the kern table is only used if GPOS has no kern feature
+    if (!(gpos && readGposKerning(ctx, gpos)) && kern)
+        readKernTable(ctx, kern, std::min(kernEnd, font.size()));
+    return true;
+}
+
+}
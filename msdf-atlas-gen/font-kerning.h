@@ -0,0 +1,20 @@
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include <map>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/**
+ * Reads the horizontal kerning pairs of a TrueType / OpenType font file (or the first font of a collection) in memory
+ * directly from its GPOS table (pair adjustment lookups of the kern feature) or, if that is not present, its kern table.
+ * Only pairs of glyph indices for which glyphFilter is true are output, with their values in font units.
+ * Returns false if the data is not in a supported format.
+ */
+bool readFontKerning(std::map<std::pair<int, int>, int> &output, const byte *fontData, size_t length, const std::vector<bool> &glyphFilter);
+
+}
@@ -1,50 +1,72 @@
 
 #include "glyph-generators.h"
 
+#include <cmath>
+
 namespace msdf_atlas {
 
+static double boxScale(const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    return ldexp(glyph.getBoxScale(), -attribs.mipLevel);
+}
+
+static msdfgen::Vector2 boxTranslate(const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    msdfgen::Vector2 translate = attribs.mipLevel ? glyph.getMipBoxTranslate(attribs.mipLevel) : glyph.getBoxTranslate();
+    // If the border is skipped, the output bitmap starts one pixel into the box
+    if (attribs.skipBoxBorder)
+        return translate-msdfgen::Vector2(1/boxScale(glyph, attribs));
+    return translate;
+}
+
+static msdfgen::Projection boxProjection(const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    return msdfgen::Projection(msdfgen::Vector2(boxScale(glyph, attribs)), boxTranslate(glyph, attribs));
+}
+
 void scanlineGenerator(const msdfgen::BitmapRef<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
-    msdfgen::rasterize(output, glyph.getShape(), glyph.getBoxScale(), glyph.getBoxTranslate(), MSDF_ATLAS_GLYPH_FILL_RULE);
+    msdfgen::rasterize(output, glyph.getShape(), boxScale(glyph, attribs), boxTranslate(glyph, attribs), MSDF_ATLAS_GLYPH_FILL_RULE);
 }
 
 void sdfGenerator(const msdfgen::BitmapRef<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
-    msdfgen::generateSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
+    msdfgen::Projection projection = boxProjection(glyph, attribs);
+    msdfgen::generateSDF(output, glyph.getShape(), projection, glyph.getBoxRange(), attribs.config);
     if (attribs.scanlinePass)
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
+        msdfgen::distanceSignCorrection(output, glyph.getShape(), projection, MSDF_ATLAS_GLYPH_FILL_RULE);
 }
 
 void psdfGenerator(const msdfgen::BitmapRef<float, 1> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
-    msdfgen::generatePSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), attribs.config);
+    msdfgen::Projection projection = boxProjection(glyph, attribs);
+    msdfgen::generatePSDF(output, glyph.getShape(), projection, glyph.getBoxRange(), attribs.config);
     if (attribs.scanlinePass)
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
+        msdfgen::distanceSignCorrection(output, glyph.getShape(), projection, MSDF_ATLAS_GLYPH_FILL_RULE);
 }
 
 void msdfGenerator(const msdfgen::BitmapRef<float, 3> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    msdfgen::Projection projection = boxProjection(glyph, attribs);
     msdfgen::MSDFGeneratorConfig config = attribs.config;
     if (attribs.scanlinePass)
         config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
-    msdfgen::generateMSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+    msdfgen::generateMSDF(output, glyph.getShape(), projection, glyph.getBoxRange(), config);
     if (attribs.scanlinePass) {
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
+        msdfgen::distanceSignCorrection(output, glyph.getShape(), projection, MSDF_ATLAS_GLYPH_FILL_RULE);
         if (attribs.config.errorCorrection.mode != msdfgen::ErrorCorrectionConfig::DISABLED) {
             config.errorCorrection.mode = attribs.config.errorCorrection.mode;
             config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
-            msdfgen::msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+            msdfgen::msdfErrorCorrection(output, glyph.getShape(), projection, glyph.getBoxRange(), config);
         }
     }
 }
 
 void mtsdfGenerator(const msdfgen::BitmapRef<float, 4> &output, const GlyphGeometry &glyph, const GeneratorAttributes &attribs) {
+    msdfgen::Projection projection = boxProjection(glyph, attribs);
     msdfgen::MSDFGeneratorConfig config = attribs.config;
     if (attribs.scanlinePass)
         config.errorCorrection.mode = msdfgen::ErrorCorrectionConfig::DISABLED;
-    msdfgen::generateMTSDF(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+    msdfgen::generateMTSDF(output, glyph.getShape(), projection, glyph.getBoxRange(), config);
     if (attribs.scanlinePass) {
-        msdfgen::distanceSignCorrection(output, glyph.getShape(), glyph.getBoxProjection(), MSDF_ATLAS_GLYPH_FILL_RULE);
+        msdfgen::distanceSignCorrection(output, glyph.getShape(), projection, MSDF_ATLAS_GLYPH_FILL_RULE);
         if (attribs.config.errorCorrection.mode != msdfgen::ErrorCorrectionConfig::DISABLED) {
             config.errorCorrection.mode = attribs.config.errorCorrection.mode;
             config.errorCorrection.distanceCheckMode = msdfgen::ErrorCorrectionConfig::DO_NOT_CHECK_DISTANCE;
-            msdfgen::msdfErrorCorrection(output, glyph.getShape(), glyph.getBoxProjection(), glyph.getBoxRange(), config);
+            msdfgen::msdfErrorCorrection(output, glyph.getShape(), projection, glyph.getBoxRange(), config);
         }
     }
 }
@@ -5,86 +5,295 @@
 
 #ifdef MSDFGEN_USE_LIBPNG
 
-#include <png.h>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <zlib.h>
+#include "Workload.h"
+
+// Uncompressed size of row strips compressed independently
+#define PNG_STRIP_SIZE 0x100000
+#define PNG_MAX_IDAT_LENGTH 0x40000000
+#define DEFLATE_WINDOW_SIZE 0x8000
 
 namespace msdf_atlas {
 
-class PngGuard {
-    png_structp png;
-    png_infop info;
+static void pngWriteUint32(std::vector<byte> &output, uint32_t value) {
+    output.push_back(byte(value>>24));
+    output.push_back(byte(value>>16));
+    output.push_back(byte(value>>8));
+    output.push_back(byte(value));
+}
 
-public:
-    inline PngGuard(png_structp png, png_infop info) : png(png), info(info) { }
-    inline ~PngGuard() {
-        png_destroy_write_struct(&png, &info);
-    }
+static void pngWriteChunk(std::vector<byte> &output, const char *type, const byte *data, size_t length) {
+    pngWriteUint32(output, (uint32_t) length);
+    size_t typePos = output.size();
+    output.insert(output.end(), type, type+4);
+    output.insert(output.end(), data, data+length);
+    pngWriteUint32(output, (uint32_t) crc32(0, output.data()+typePos, (uInt) (4+length)));
+}
 
-};
+/// Writes the concatenation of data pieces as a sequence of IDAT chunks
+static void pngWriteImageData(std::vector<byte> &output, const std::vector<std::pair<const byte *, size_t> > &pieces, size_t totalLength) {
+    size_t pieceIndex = 0, pieceOffset = 0;
+    do {
+        size_t chunkLength = std::min(totalLength, (size_t) PNG_MAX_IDAT_LENGTH);
+        pngWriteUint32(output, (uint32_t) chunkLength);
+        size_t typePos = output.size();
+        output.insert(output.end(), "IDAT", "IDAT"+4);
+        for (size_t remaining = chunkLength; remaining;) {
+            size_t length = std::min(remaining, pieces[pieceIndex].second-pieceOffset);
+            output.insert(output.end(), pieces[pieceIndex].first+pieceOffset, pieces[pieceIndex].first+pieceOffset+length);
+            pieceOffset += length;
+            remaining -= length;
+            if (pieceOffset == pieces[pieceIndex].second)
+                ++pieceIndex, pieceOffset = 0;
+        }
+        pngWriteUint32(output, (uint32_t) crc32(0, output.data()+typePos, (uInt) (4+chunkLength)));
+        totalLength -= chunkLength;
+    } while (totalLength);
+}
 
-static void pngIgnoreError(png_structp, png_const_charp) { }
+static int paethPredictor(int a, int b, int c) {
+    int p = a+b-c;
+    int pa = abs(p-a), pb = abs(p-b), pc = abs(p-c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    if (pb <= pc)
+        return b;
+    return c;
+}
 
-static void pngWrite(png_structp png, png_bytep data, png_size_t length) {
-    std::vector<byte> &output = *reinterpret_cast<std::vector<byte> *>(png_get_io_ptr(png));
-    output.insert(output.end(), data, data+length);
+/// Outputs the filter type byte followed by the filtered row, prevRow is null for the first row
+static void pngFilterRow(byte *dst, int filterType, const byte *row, const byte *prevRow, size_t rowLength, int bpp) {
+    *dst++ = (byte) filterType;
+    switch (filterType) {
+        case 0:
+            memcpy(dst, row, rowLength);
+            break;
+        case 1:
+            for (size_t i = 0; i < rowLength; ++i)
+                dst[i] = byte(row[i]-(i >= (size_t) bpp ? row[i-bpp] : 0));
+            break;
+        case 2:
+            for (size_t i = 0; i < rowLength; ++i)
+                dst[i] = byte(row[i]-(prevRow ? prevRow[i] : 0));
+            break;
+        case 3:
+            for (size_t i = 0; i < rowLength; ++i)
+                dst[i] = byte(row[i]-(((i >= (size_t) bpp ? row[i-bpp] : 0)+(prevRow ? prevRow[i] : 0))>>1));
+            break;
+        case 4:
+            for (size_t i = 0; i < rowLength; ++i) {
+                int left = i >= (size_t) bpp ? row[i-bpp] : 0;
+                int up = prevRow ? prevRow[i] : 0;
+                int upLeft = prevRow && i >= (size_t) bpp ? prevRow[i-bpp] : 0;
+                dst[i] = byte(row[i]-paethPredictor(left, up, upLeft));
+            }
+            break;
+    }
 }
 
-static void pngFlush(png_structp) { }
+/// Estimates how well a filtered row will compress as the sum of absolute values of its signed bytes (lower is better)
+static size_t pngFilterCost(const byte *filtered, size_t rowLength) {
+    size_t cost = 0;
+    for (size_t i = 0; i < rowLength; ++i)
+        cost += filtered[i] < 0x80 ? filtered[i] : 0x100-filtered[i];
+    return cost;
+}
 
-static bool pngEncode(std::vector<byte> &output, const byte *pixels, int width, int height, int channels, int colorType) {
-    if (!(pixels && width && height))
-        return false;
-    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, &pngIgnoreError, &pngIgnoreError);
-    if (!png)
+static void pngFilterRows(byte *dst, const byte *const *rows, int rowCount, bool firstRow, size_t rowLength, int bpp, PngFilter filter) {
+    std::vector<byte> candidate, bestCandidate;
+    if (filter == PngFilter::ADAPTIVE) {
+        candidate.resize(rowLength+1);
+        bestCandidate.resize(rowLength+1);
+    }
+    for (int y = 0; y < rowCount; ++y, dst += rowLength+1) {
+        const byte *prevRow = y > 0 || !firstRow ? rows[y-1] : nullptr;
+        switch (filter) {
+            case PngFilter::NONE:
+                pngFilterRow(dst, 0, rows[y], prevRow, rowLength, bpp);
+                break;
+            case PngFilter::SUB:
+                pngFilterRow(dst, 1, rows[y], prevRow, rowLength, bpp);
+                break;
+            case PngFilter::UP:
+                pngFilterRow(dst, 2, rows[y], prevRow, rowLength, bpp);
+                break;
+            case PngFilter::AVERAGE:
+                pngFilterRow(dst, 3, rows[y], prevRow, rowLength, bpp);
+                break;
+            case PngFilter::PAETH:
+                pngFilterRow(dst, 4, rows[y], prevRow, rowLength, bpp);
+                break;
+            case PngFilter::ADAPTIVE: {
+                size_t bestCost = (size_t) -1;
+                for (int filterType = 0; filterType <= 4; ++filterType) {
+                    pngFilterRow(candidate.data(), filterType, rows[y], prevRow, rowLength, bpp);
+                    size_t cost = pngFilterCost(candidate.data()+1, rowLength);
+                    if (cost < bestCost) {
+                        bestCost = cost;
+                        candidate.swap(bestCandidate);
+                    }
+                }
+                memcpy(dst, bestCandidate.data(), rowLength+1);
+                break;
+            }
+        }
+    }
+}
+
+/// Compresses a strip of the filtered image data as a raw deflate stream, which is terminated if last or else ends byte-aligned so that strips can be concatenated
+static bool pngDeflateStrip(std::vector<byte> &output, const byte *input, size_t length, const byte *dictionary, size_t dictionaryLength, int level, bool last) {
+    z_stream stream = { };
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
         return false;
-    png_infop info = png_create_info_struct(png);
-    PngGuard guard(png, info);
-    if (!info)
+    bool success = !dictionaryLength || deflateSetDictionary(&stream, dictionary, (uInt) dictionaryLength) == Z_OK;
+    output.resize(deflateBound(&stream, (uLong) length)+16);
+    stream.next_in = const_cast<Bytef *>(input);
+    stream.avail_in = (uInt) length;
+    while (success) {
+        if (stream.total_out == output.size())
+            output.resize(2*output.size());
+        stream.next_out = output.data()+stream.total_out;
+        stream.avail_out = (uInt) (output.size()-stream.total_out);
+        int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+        if (last ? result == Z_STREAM_END : stream.avail_out > 0 && !stream.avail_in)
+            break;
+        if (result != Z_OK && result != Z_BUF_ERROR)
+            success = false;
+    }
+    output.resize(stream.total_out);
+    deflateEnd(&stream);
+    return success;
+}
+
+static bool pngEncode(std::vector<byte> &output, const byte *pixels, int width, int height, int channels, byte colorType, int bitDepth, const PngEncoderSettings &settings) {
+    if (!(pixels && width > 0 && height > 0))
         return false;
+    int bytesPerPixel = channels*bitDepth/8;
+    size_t rowLength = (size_t) bytesPerPixel*width;
     std::vector<const byte *> rows(height);
     for (int y = 0; y < height; ++y)
-        rows[y] = pixels+channels*width*(height-y-1);
-    if (setjmp(png_jmpbuf(png)))
+        rows[y] = pixels+rowLength*(height-y-1);
+    int level = std::min(std::max(settings.compressionLevel, 0), 9);
+    int threadCount = std::max(settings.threadCount, 1);
+
+    // Filter and compress strips of rows in parallel, each strip uses the end of the previous one as its dictionary
+    int stripHeight = (int) std::min(std::max(PNG_STRIP_SIZE/(rowLength+1), (size_t) 1), (size_t) height);
+    int stripCount = (height+stripHeight-1)/stripHeight;
+    std::vector<byte> filtered((rowLength+1)*height);
+    Workload([&rows, &filtered, &settings, rowLength, bytesPerPixel, height, stripHeight](int strip, int) -> bool {
+        int y = strip*stripHeight;
+        pngFilterRows(filtered.data()+(rowLength+1)*y, rows.data()+y, std::min(stripHeight, height-y), !y, rowLength, bytesPerPixel, settings.filter);
+        return true;
+    }, stripCount).finish(threadCount);
+    std::vector<std::vector<byte> > strips(stripCount);
+    std::vector<uLong> stripChecksums(stripCount);
+    size_t stripLength = (rowLength+1)*stripHeight;
+    if (!Workload([&filtered, &strips, &stripChecksums, stripLength, stripCount, level](int strip, int) -> bool {
+        size_t start = stripLength*strip;
+        size_t length = std::min(stripLength, filtered.size()-start);
+        size_t dictionaryLength = level ? std::min(start, (size_t) DEFLATE_WINDOW_SIZE) : 0;
+        stripChecksums[strip] = adler32(adler32(0, Z_NULL, 0), filtered.data()+start, (uInt) length);
+        return pngDeflateStrip(strips[strip], filtered.data()+start, length, filtered.data()+start-dictionaryLength, dictionaryLength, level, strip == stripCount-1);
+    }, stripCount).finish(threadCount))
         return false;
-    png_set_write_fn(png, &output, &pngWrite, &pngFlush);
-    png_set_IHDR(png, info, width, height, 8, colorType, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-    png_set_compression_level(png, 9);
-    png_set_rows(png, info, const_cast<png_bytepp>(&rows[0]));
-    png_write_png(png, info, PNG_TRANSFORM_IDENTITY, NULL);
+
+    // Assemble zlib stream
+    const byte zlibHeader[2] = { 0x78, byte(level < 2 ? 0x01 : level < 6 ? 0x5e : level == 6 ? 0x9c : 0xda) };
+    uLong checksum = adler32(0, Z_NULL, 0);
+    for (int i = 0; i < stripCount; ++i)
+        checksum = adler32_combine(checksum, stripChecksums[i], (z_off_t) std::min(stripLength, filtered.size()-stripLength*i));
+    const byte zlibTrailer[4] = { byte(checksum>>24), byte(checksum>>16), byte(checksum>>8), byte(checksum) };
+    std::vector<std::pair<const byte *, size_t> > pieces;
+    pieces.reserve(stripCount+2);
+    pieces.push_back(std::make_pair(zlibHeader, sizeof(zlibHeader)));
+    for (const std::vector<byte> &strip : strips)
+        pieces.push_back(std::make_pair(strip.data(), strip.size()));
+    pieces.push_back(std::make_pair(zlibTrailer, sizeof(zlibTrailer)));
+    size_t zlibLength = 0;
+    for (const std::pair<const byte *, size_t> &piece : pieces)
+        zlibLength += piece.second;
+
+    // Write PNG file structure into a buffer reserved for its final size
+    static const byte signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    const byte header[13] = {
+        byte(width>>24), byte(width>>16), byte(width>>8), byte(width),
+        byte(height>>24), byte(height>>16), byte(height>>8), byte(height),
+        byte(bitDepth), colorType, 0, 0, 0
+    };
+    output.clear();
+    output.reserve(sizeof(signature)+(12+sizeof(header))+(12*((zlibLength+PNG_MAX_IDAT_LENGTH-1)/PNG_MAX_IDAT_LENGTH)+zlibLength)+12);
+    output.insert(output.end(), signature, signature+sizeof(signature));
+    pngWriteChunk(output, "IHDR", header, sizeof(header));
+    pngWriteImageData(output, pieces, zlibLength);
+    pngWriteChunk(output, "IEND", nullptr, 0);
     return true;
 }
 
-static bool pngEncode(std::vector<byte> &output, const float *pixels, int width, int height, int channels, int colorType) {
+static bool pngEncode(std::vector<byte> &output, const float *pixels, int width, int height, int channels, byte colorType, const PngEncoderSettings &settings) {
     if (!(pixels && width && height))
         return false;
     int subpixels = channels*width*height;
     std::vector<byte> bytePixels(subpixels);
     for (int i = 0; i < subpixels; ++i)
         bytePixels[i] = msdfgen::pixelFloatToByte(pixels[i]);
-    return pngEncode(output, bytePixels.data(), width, height, channels, colorType);
+    return pngEncode(output, bytePixels.data(), width, height, channels, colorType, 8, settings);
+}
+
+static bool pngEncode(std::vector<byte> &output, const unorm16 *pixels, int width, int height, int channels, byte colorType, const PngEncoderSettings &settings) {
+    if (!(pixels && width && height))
+        return false;
+    // 16-bit samples are stored big-endian
+    size_t subpixels = (size_t) channels*width*height;
+    std::vector<byte> bytePixels(2*subpixels);
+    for (size_t i = 0; i < subpixels; ++i) {
+        bytePixels[2*i] = byte(pixels[i]>>8);
+        bytePixels[2*i+1] = byte(pixels[i]);
+    }
+    return pngEncode(output, bytePixels.data(), width, height, channels, colorType, 16, settings);
+}
+
+// PNG color types
+#define PNG_COLOR_TYPE_GRAY 0
+#define PNG_COLOR_TYPE_RGB 2
+#define PNG_COLOR_TYPE_RGB_ALPHA 6
+
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 1, PNG_COLOR_TYPE_GRAY, 8, settings);
+}
+
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 3, PNG_COLOR_TYPE_RGB, 8, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap) {
-    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 1, PNG_COLOR_TYPE_GRAY);
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 4, PNG_COLOR_TYPE_RGB_ALPHA, 8, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap) {
-    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 3, PNG_COLOR_TYPE_RGB);
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 1, PNG_COLOR_TYPE_GRAY, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap) {
-    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 4, PNG_COLOR_TYPE_RGB_ALPHA);
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 3, PNG_COLOR_TYPE_RGB, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap) {
-    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 1, PNG_COLOR_TYPE_GRAY);
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 4, PNG_COLOR_TYPE_RGB_ALPHA, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap) {
-    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 3, PNG_COLOR_TYPE_RGB);
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 1> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 1, PNG_COLOR_TYPE_GRAY, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap) {
-    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 4, PNG_COLOR_TYPE_RGB_ALPHA);
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 3> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 3, PNG_COLOR_TYPE_RGB, settings);
+}
+
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 4> &bitmap, const PngEncoderSettings &settings) {
+    return pngEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 4, PNG_COLOR_TYPE_RGB_ALPHA, settings);
 }
 
 }
@@ -93,41 +302,78 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4
 
 #ifdef MSDFGEN_USE_LODEPNG
 
+#include <algorithm>
 #include <lodepng.h>
 
 namespace msdf_atlas {
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap) {
+static bool lodepngEncode(std::vector<byte> &output, const std::vector<byte> &pixels, int width, int height, LodePNGColorType colorType, const PngEncoderSettings &settings, unsigned bitDepth = 8) {
+    lodepng::State state;
+    state.info_raw.colortype = colorType;
+    state.info_raw.bitdepth = bitDepth;
+    state.info_png.color.colortype = colorType;
+    state.info_png.color.bitdepth = bitDepth;
+    // LodePNG has no compression levels, so the level is mapped onto the window size
+    int level = std::min(std::max(settings.compressionLevel, 0), 9);
+    if (level) {
+        state.encoder.zlibsettings.windowsize = 1u<<std::min(7+level, 15);
+        state.encoder.zlibsettings.lazymatching = level >= 4;
+    } else
+        state.encoder.zlibsettings.btype = 0;
+    switch (settings.filter) {
+        case PngFilter::NONE:
+            state.encoder.filter_strategy = LFS_ZERO;
+            break;
+        case PngFilter::SUB:
+            state.encoder.filter_strategy = LFS_ONE;
+            break;
+        case PngFilter::UP:
+            state.encoder.filter_strategy = LFS_TWO;
+            break;
+        case PngFilter::AVERAGE:
+            state.encoder.filter_strategy = LFS_THREE;
+            break;
+        case PngFilter::PAETH:
+            state.encoder.filter_strategy = LFS_FOUR;
+            break;
+        case PngFilter::ADAPTIVE:
+            state.encoder.filter_strategy = LFS_MINSUM;
+            break;
+    }
+    return !lodepng::encode(output, pixels, width, height, state);
+}
+
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap, const PngEncoderSettings &settings) {
     std::vector<byte> pixels(bitmap.width*bitmap.height);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[bitmap.width*y], bitmap(0, bitmap.height-y-1), bitmap.width);
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_GREY, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap) {
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap, const PngEncoderSettings &settings) {
     std::vector<byte> pixels(3*bitmap.width*bitmap.height);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[3*bitmap.width*y], bitmap(0, bitmap.height-y-1), 3*bitmap.width);
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGB, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap) {
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap, const PngEncoderSettings &settings) {
     std::vector<byte> pixels(4*bitmap.width*bitmap.height);
     for (int y = 0; y < bitmap.height; ++y)
         memcpy(&pixels[4*bitmap.width*y], bitmap(0, bitmap.height-y-1), 4*bitmap.width);
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap) {
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap, const PngEncoderSettings &settings) {
     std::vector<byte> pixels(bitmap.width*bitmap.height);
     std::vector<byte>::iterator it = pixels.begin();
     for (int y = bitmap.height-1; y >= 0; --y)
         for (int x = 0; x < bitmap.width; ++x)
             *it++ = msdfgen::pixelFloatToByte(*bitmap(x, y));
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_GREY);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_GREY, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap) {
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap, const PngEncoderSettings &settings) {
     std::vector<byte> pixels(3*bitmap.width*bitmap.height);
     std::vector<byte>::iterator it = pixels.begin();
     for (int y = bitmap.height-1; y >= 0; --y)
@@ -136,10 +382,10 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3
             *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[1]);
             *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[2]);
         }
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGB);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGB, settings);
 }
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap) {
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap, const PngEncoderSettings &settings) {
     std::vector<byte> pixels(4*bitmap.width*bitmap.height);
     std::vector<byte>::iterator it = pixels.begin();
     for (int y = bitmap.height-1; y >= 0; --y)
@@ -149,9 +395,554 @@ bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4
             *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[2]);
             *it++ = msdfgen::pixelFloatToByte(bitmap(x, y)[3]);
         }
-    return !lodepng::encode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA);
+    return lodepngEncode(output, pixels, bitmap.width, bitmap.height, LCT_RGBA, settings);
+}
+
+/// Converts a bottom-up 16-bit bitmap into top-down big-endian samples expected by LodePNG
+template <int N>
+static std::vector<byte> lodepngUnorm16Pixels(const msdfgen::BitmapConstRef<unorm16, N> &bitmap) {
+    std::vector<byte> pixels(2*N*bitmap.width*bitmap.height);
+    std::vector<byte>::iterator it = pixels.begin();
+    for (int y = bitmap.height-1; y >= 0; --y) {
+        const unorm16 *p = bitmap(0, y);
+        for (int x = 0; x < N*bitmap.width; ++x, ++p) {
+            *it++ = byte(*p>>8);
+            *it++ = byte(*p);
+        }
+    }
+    return pixels;
 }
 
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 1> &bitmap, const PngEncoderSettings &settings) {
+    return lodepngEncode(output, lodepngUnorm16Pixels(bitmap), bitmap.width, bitmap.height, LCT_GREY, settings, 16);
 }
 
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 3> &bitmap, const PngEncoderSettings &settings) {
+    return lodepngEncode(output, lodepngUnorm16Pixels(bitmap), bitmap.width, bitmap.height, LCT_RGB, settings, 16);
+}
+
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 4> &bitmap, const PngEncoderSettings &settings) {
+    return lodepngEncode(output, lodepngUnorm16Pixels(bitmap), bitmap.width, bitmap.height, LCT_RGBA, settings, 16);
+}
+
+}
+
+#endif
+
+// TIFF encoder
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "Workload.h"
+#include "pixel-conversion.h"
+#if defined(MSDFGEN_USE_LIBPNG)
+    #include <zlib.h>
+    #define TIFF_DEFLATE_AVAILABLE
+#elif defined(MSDFGEN_USE_LODEPNG)
+    #include <lodepng.h>
+    #define TIFF_DEFLATE_AVAILABLE
+#endif
+
+// Uncompressed size of row strips, which are encoded independently
+#define TIFF_STRIP_SIZE 0x40000
+
+#define TIFF_TYPE_SHORT 3
+#define TIFF_TYPE_LONG 4
+
+#define TIFF_TAG_IMAGE_WIDTH 256
+#define TIFF_TAG_IMAGE_LENGTH 257
+#define TIFF_TAG_BITS_PER_SAMPLE 258
+#define TIFF_TAG_COMPRESSION 259
+#define TIFF_TAG_PHOTOMETRIC_INTERPRETATION 262
+#define TIFF_TAG_STRIP_OFFSETS 273
+#define TIFF_TAG_SAMPLES_PER_PIXEL 277
+#define TIFF_TAG_ROWS_PER_STRIP 278
+#define TIFF_TAG_STRIP_BYTE_COUNTS 279
+#define TIFF_TAG_PLANAR_CONFIGURATION 284
+#define TIFF_TAG_PREDICTOR 317
+#define TIFF_TAG_EXTRA_SAMPLES 338
+#define TIFF_TAG_SAMPLE_FORMAT 339
+
+#define TIFF_COMPRESSION_NONE 1
+#define TIFF_COMPRESSION_DEFLATE 8
+#define TIFF_PREDICTOR_FLOATING_POINT 3
+#define TIFF_SAMPLE_FORMAT_IEEE_FLOAT 3
+
+namespace msdf_atlas {
+
+/// Returns the bit pattern of a sample as stored in the file
+static uint32_t tiffSampleBits(float value, bool halfFloat) {
+    if (halfFloat)
+        return pixelFloatToHalf(value).bits;
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static uint32_t tiffSampleBits(half value, bool) {
+    return value.bits;
+}
+
+/// Converts a row of samples, either into little-endian values or, for the floating-point predictor, into big-endian byte planes with horizontal differencing
+template <typename T>
+static void tiffEncodeRow(byte *dst, const T *src, size_t sampleCount, int channels, bool halfFloat, bool predictor) {
+    int bytesPerSample = halfFloat ? 2 : 4;
+    for (size_t i = 0; i < sampleCount; ++i) {
+        uint32_t sample = tiffSampleBits(src[i], halfFloat);
+        for (int b = 0; b < bytesPerSample; ++b) {
+            if (predictor)
+                dst[sampleCount*b+i] = byte(sample>>(8*(bytesPerSample-b-1)));
+            else
+                dst[bytesPerSample*i+b] = byte(sample>>(8*b));
+        }
+    }
+    if (predictor) {
+        for (size_t i = bytesPerSample*sampleCount-1; i >= (size_t) channels; --i)
+            dst[i] = byte(dst[i]-dst[i-channels]);
+    }
+}
+
+#ifdef TIFF_DEFLATE_AVAILABLE
+static bool tiffDeflate(std::vector<byte> &output, const byte *input, size_t length, int level) {
+#ifdef MSDFGEN_USE_LIBPNG
+    uLongf outputLength = compressBound((uLong) length);
+    output.resize(outputLength);
+    if (compress2(output.data(), &outputLength, input, (uLong) length, level) != Z_OK)
+        return false;
+    output.resize(outputLength);
+    return true;
+#else
+    // LodePNG has no compression levels, so the level is mapped onto the window size
+    LodePNGCompressSettings compressSettings = lodepng_default_compress_settings;
+    compressSettings.windowsize = 1u<<std::min(7+level, 15);
+    compressSettings.lazymatching = level >= 4;
+    output.clear();
+    return !lodepng::compress(output, input, length, compressSettings);
+#endif
+}
 #endif
+
+static void writeUint16LE(byte *dst, uint32_t value) {
+    dst[0] = byte(value);
+    dst[1] = byte(value>>8);
+}
+
+static void writeUint32LE(byte *dst, uint32_t value) {
+    dst[0] = byte(value);
+    dst[1] = byte(value>>8);
+    dst[2] = byte(value>>16);
+    dst[3] = byte(value>>24);
+}
+
+template <typename T>
+static bool tiffEncode(std::vector<byte> &output, const T *pixels, int width, int height, int channels, bool halfFloat, const TiffEncoderSettings &settings) {
+    if (!(pixels && width > 0 && height > 0))
+        return false;
+    int level = std::min(std::max(settings.compressionLevel, 0), 9);
+#ifndef TIFF_DEFLATE_AVAILABLE
+    level = 0;
+#endif
+    int bytesPerSample = halfFloat ? 2 : 4;
+    size_t rowSamples = (size_t) channels*width;
+    size_t rowLength = bytesPerSample*rowSamples;
+
+    // Encode strips of rows in parallel, rows are stored top-down
+    int stripHeight = (int) std::min(std::max(TIFF_STRIP_SIZE/rowLength, (size_t) 1), (size_t) height);
+    int stripCount = (height+stripHeight-1)/stripHeight;
+    std::vector<std::vector<byte> > strips(stripCount);
+    if (!Workload([&](int strip, int) -> bool {
+        int y = strip*stripHeight;
+        int rowCount = std::min(stripHeight, height-y);
+        std::vector<byte> rows(rowLength*rowCount);
+        for (int i = 0; i < rowCount; ++i)
+            tiffEncodeRow(rows.data()+rowLength*i, pixels+rowSamples*(height-y-i-1), rowSamples, channels, halfFloat, level > 0);
+    #ifdef TIFF_DEFLATE_AVAILABLE
+        if (level)
+            return tiffDeflate(strips[strip], rows.data(), rows.size(), level);
+    #endif
+        strips[strip].swap(rows);
+        return true;
+    }, stripCount).finish(std::max(settings.threadCount, 1)))
+        return false;
+
+    // Layout: header, strips, arrays of tag values which do not fit into the directory, image file directory
+    size_t dataLength = 0;
+    for (const std::vector<byte> &strip : strips)
+        dataLength += strip.size();
+    size_t arraysOffset = (8+dataLength+1)&~(size_t) 1;
+    size_t sampleArrayLength = channels > 2 ? 2*channels : 0;
+    size_t stripArrayLength = stripCount > 1 ? 4*stripCount : 0;
+    size_t bitsPerSampleOffset = arraysOffset;
+    size_t sampleFormatOffset = bitsPerSampleOffset+sampleArrayLength;
+    size_t stripOffsetsOffset = sampleFormatOffset+sampleArrayLength;
+    size_t stripByteCountsOffset = stripOffsetsOffset+stripArrayLength;
+    size_t directoryOffset = stripByteCountsOffset+stripArrayLength;
+    int entryCount = 11+(level > 0)+(channels == 4);
+    size_t fileSize = directoryOffset+2+12*entryCount+4;
+    if (fileSize > 0xffffffffu)
+        return false;
+
+    output.assign(fileSize, 0);
+    byte *file = output.data();
+    file[0] = 'I', file[1] = 'I';
+    writeUint16LE(file+2, 42);
+    writeUint32LE(file+4, (uint32_t) directoryOffset);
+    size_t stripOffset = 8;
+    for (int i = 0; i < stripCount; ++i) {
+        memcpy(file+stripOffset, strips[i].data(), strips[i].size());
+        if (stripCount > 1) {
+            writeUint32LE(file+stripOffsetsOffset+4*i, (uint32_t) stripOffset);
+            writeUint32LE(file+stripByteCountsOffset+4*i, (uint32_t) strips[i].size());
+        }
+        stripOffset += strips[i].size();
+    }
+    if (channels > 2) {
+        for (int i = 0; i < channels; ++i) {
+            writeUint16LE(file+bitsPerSampleOffset+2*i, 8*bytesPerSample);
+            writeUint16LE(file+sampleFormatOffset+2*i, TIFF_SAMPLE_FORMAT_IEEE_FLOAT);
+        }
+    }
+
+    // Image file directory, entries must be sorted by tag
+    byte *entry = file+directoryOffset;
+    writeUint16LE(entry, entryCount);
+    entry += 2;
+    auto writeEntry = [&entry](int tag, int type, size_t count, size_t value) {
+        writeUint16LE(entry, tag);
+        writeUint16LE(entry+2, type);
+        writeUint32LE(entry+4, (uint32_t) count);
+        if (type == TIFF_TYPE_SHORT && count == 1)
+            writeUint16LE(entry+8, (uint32_t) value);
+        else
+            writeUint32LE(entry+8, (uint32_t) value);
+        entry += 12;
+    };
+    writeEntry(TIFF_TAG_IMAGE_WIDTH, TIFF_TYPE_LONG, 1, width);
+    writeEntry(TIFF_TAG_IMAGE_LENGTH, TIFF_TYPE_LONG, 1, height);
+    writeEntry(TIFF_TAG_BITS_PER_SAMPLE, TIFF_TYPE_SHORT, channels, channels > 2 ? bitsPerSampleOffset : 8*bytesPerSample);
+    writeEntry(TIFF_TAG_COMPRESSION, TIFF_TYPE_SHORT, 1, level > 0 ? TIFF_COMPRESSION_DEFLATE : TIFF_COMPRESSION_NONE);
+    writeEntry(TIFF_TAG_PHOTOMETRIC_INTERPRETATION, TIFF_TYPE_SHORT, 1, channels >= 3 ? 2 : 1);
+    writeEntry(TIFF_TAG_STRIP_OFFSETS, TIFF_TYPE_LONG, stripCount, stripCount > 1 ? stripOffsetsOffset : 8);
+    writeEntry(TIFF_TAG_SAMPLES_PER_PIXEL, TIFF_TYPE_SHORT, 1, channels);
+    writeEntry(TIFF_TAG_ROWS_PER_STRIP, TIFF_TYPE_LONG, 1, stripHeight);
+    writeEntry(TIFF_TAG_STRIP_BYTE_COUNTS, TIFF_TYPE_LONG, stripCount, stripCount > 1 ? stripByteCountsOffset : dataLength);
+    writeEntry(TIFF_TAG_PLANAR_CONFIGURATION, TIFF_TYPE_SHORT, 1, 1);
+    if (level > 0)
+        writeEntry(TIFF_TAG_PREDICTOR, TIFF_TYPE_SHORT, 1, TIFF_PREDICTOR_FLOATING_POINT);
+    // The fourth channel of MTSDF is not an alpha channel (unspecified extra sample)
+    if (channels == 4)
+        writeEntry(TIFF_TAG_EXTRA_SAMPLES, TIFF_TYPE_SHORT, 1, 0);
+    writeEntry(TIFF_TAG_SAMPLE_FORMAT, TIFF_TYPE_SHORT, channels, channels > 2 ? sampleFormatOffset : TIFF_SAMPLE_FORMAT_IEEE_FLOAT);
+    return true;
+}
+
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap, const TiffEncoderSettings &settings) {
+    return tiffEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 1, settings.halfFloat, settings);
+}
+
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap, const TiffEncoderSettings &settings) {
+    return tiffEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 3, settings.halfFloat, settings);
+}
+
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap, const TiffEncoderSettings &settings) {
+    return tiffEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 4, settings.halfFloat, settings);
+}
+
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<half, 1> &bitmap, const TiffEncoderSettings &settings) {
+    return tiffEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 1, true, settings);
+}
+
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<half, 3> &bitmap, const TiffEncoderSettings &settings) {
+    return tiffEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 3, true, settings);
+}
+
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<half, 4> &bitmap, const TiffEncoderSettings &settings) {
+    return tiffEncode(output, bitmap.pixels, bitmap.width, bitmap.height, 4, true, settings);
+}
+
+}
+
+// KTX2 & DDS encoders
+
+#include "block-compression.h"
+
+#define KTX2_HEADER_LENGTH 80
+#define KTX2_LEVEL_INDEX_LENGTH 24
+#define KTX2_DFD_BASE_LENGTH 28
+#define KTX2_DFD_SAMPLE_LENGTH 16
+#define KTX2_VK_FORMAT_BC4_UNORM_BLOCK 139
+#define KTX2_VK_FORMAT_BC5_UNORM_BLOCK 141
+#define KTX2_VK_FORMAT_BC7_UNORM_BLOCK 145
+#define KTX2_VK_FORMAT_EAC_R11_UNORM_BLOCK 153
+#define KTX2_VK_FORMAT_EAC_R11G11_UNORM_BLOCK 155
+#define KTX2_DF_MODEL_BC4 131
+#define KTX2_DF_MODEL_BC5 132
+#define KTX2_DF_MODEL_BC7 134
+#define KTX2_DF_MODEL_ETC2 161
+#define KTX2_DF_PRIMARIES_BT709 1
+#define KTX2_DF_TRANSFER_LINEAR 1
+
+#define DDS_HEADER_LENGTH 124
+#define DDS_DX10_HEADER_LENGTH 20
+#define DDS_FLAGS_TEXTURE 0x81007 // caps, height, width, pixel format, linear size
+#define DDS_FLAGS_MIPMAP_COUNT 0x20000
+#define DDS_PIXEL_FORMAT_FOURCC 0x4
+#define DDS_CAPS_TEXTURE 0x1000
+#define DDS_CAPS_MIPMAP 0x400008 // complex, mipmap
+#define DDS_DXGI_FORMAT_BC4_UNORM 80
+#define DDS_DXGI_FORMAT_BC5_UNORM 83
+#define DDS_DXGI_FORMAT_BC7_UNORM 98
+#define DDS_DIMENSION_TEXTURE2D 3
+#define DDS_ALPHA_MODE_OPAQUE 3
+
+namespace msdf_atlas {
+
+enum class BlockFormat {
+    BC4,
+    BC5,
+    BC7,
+    EAC_R11,
+    EAC_RG11
+};
+
+/// Identifiers of a block-compressed format in the containers (zero if not available) and its layout
+struct BlockFormatProperties {
+    uint32_t vkFormat;
+    byte dfModel;
+    uint32_t dxgiFormat;
+    int blockSize;
+    /// Number of independently compressed channels, each is a separate sample of the data format descriptor
+    int planes;
+};
+
+static BlockFormatProperties blockFormatProperties(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC4:
+            return BlockFormatProperties { KTX2_VK_FORMAT_BC4_UNORM_BLOCK, KTX2_DF_MODEL_BC4, DDS_DXGI_FORMAT_BC4_UNORM, BC4_BLOCK_SIZE, 1 };
+        case BlockFormat::BC5:
+            return BlockFormatProperties { KTX2_VK_FORMAT_BC5_UNORM_BLOCK, KTX2_DF_MODEL_BC5, DDS_DXGI_FORMAT_BC5_UNORM, BC5_BLOCK_SIZE, 2 };
+        case BlockFormat::BC7:
+            return BlockFormatProperties { KTX2_VK_FORMAT_BC7_UNORM_BLOCK, KTX2_DF_MODEL_BC7, DDS_DXGI_FORMAT_BC7_UNORM, BC7_BLOCK_SIZE, 1 };
+        case BlockFormat::EAC_R11:
+            return BlockFormatProperties { KTX2_VK_FORMAT_EAC_R11_UNORM_BLOCK, KTX2_DF_MODEL_ETC2, 0, EAC_R11_BLOCK_SIZE, 1 };
+        case BlockFormat::EAC_RG11:
+            return BlockFormatProperties { KTX2_VK_FORMAT_EAC_R11G11_UNORM_BLOCK, KTX2_DF_MODEL_ETC2, 0, EAC_RG11_BLOCK_SIZE, 2 };
+    }
+    return BlockFormatProperties();
+}
+
+/// Selects the block-compressed format of an image with N channels, returns false if EAC is requested for more than two channels
+static bool selectBlockFormat(BlockFormat &format, int N, const BlockEncoderSettings &settings) {
+    if (N == 1)
+        format = settings.eac ? BlockFormat::EAC_R11 : BlockFormat::BC4;
+    else if (N == 4 && settings.channelCount == 2)
+        format = settings.eac ? BlockFormat::EAC_RG11 : BlockFormat::BC5;
+    else if (settings.eac)
+        return false;
+    else
+        format = BlockFormat::BC7;
+    return true;
+}
+
+static void blockCompress(byte *output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, BlockFormat format, int threadCount) {
+    if (format == BlockFormat::EAC_R11)
+        compressEACR11(output, bitmap, threadCount);
+    else
+        compressBC4(output, bitmap, threadCount);
+}
+
+static void blockCompress(byte *output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, BlockFormat, int threadCount) {
+    compressBC7(output, bitmap, threadCount);
+}
+
+static void blockCompress(byte *output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, BlockFormat format, int threadCount) {
+    switch (format) {
+        case BlockFormat::BC5:
+            compressBC5(output, bitmap, threadCount);
+            break;
+        case BlockFormat::EAC_RG11:
+            compressEACRG11(output, bitmap, threadCount);
+            break;
+        default:
+            compressBC7(output, bitmap, threadCount);
+    }
+}
+
+static void writeUint64LE(byte *dst, uint64_t value) {
+    writeUint32LE(dst, (uint32_t) value);
+    writeUint32LE(dst+4, (uint32_t) (value>>32));
+}
+
+/// Returns true if the levels form a valid mipmap chain, each one half the size of the previous one (rounded down)
+template <int N>
+static bool isMipmapChain(const msdfgen::BitmapConstRef<byte, N> *levels, int levelCount) {
+    if (!(levels && levelCount > 0))
+        return false;
+    for (int i = 0; i < levelCount; ++i) {
+        if (!(levels[i].pixels && levels[i].width > 0 && levels[i].height > 0))
+            return false;
+        if (i > 0 && !(levels[i].width == std::max(levels[i-1].width>>1, 1) && levels[i].height == std::max(levels[i-1].height>>1, 1)))
+            return false;
+    }
+    return true;
+}
+
+template <int N>
+static bool ktx2Encode(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, N> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    static const byte identifier[12] = { 0xab, 'K', 'T', 'X', ' ', '2', '0', 0xbb, '\r', '\n', 0x1a, '\n' };
+    static const char keyValueData[] = "\x12\0\0\0KTXorientation\0rd\0\0\0" "\x19\0\0\0KTXwriter\0msdf-atlas-gen\0\0\0\0";
+    BlockFormat format;
+    if (!(isMipmapChain(levels, levelCount) && selectBlockFormat(format, N, settings)))
+        return false;
+    BlockFormatProperties properties = blockFormatProperties(format);
+    int blockSize = properties.blockSize;
+    size_t dfdLength = KTX2_DFD_BASE_LENGTH+KTX2_DFD_SAMPLE_LENGTH*properties.planes;
+    size_t dfdOffset = KTX2_HEADER_LENGTH+KTX2_LEVEL_INDEX_LENGTH*levelCount;
+    size_t kvdOffset = dfdOffset+dfdLength;
+    size_t kvdLength = sizeof(keyValueData)-1;
+    size_t dataOffset = (kvdOffset+kvdLength+blockSize-1)/blockSize*blockSize;
+    size_t dataLength = 0;
+    for (int i = 0; i < levelCount; ++i)
+        dataLength += blockCompressedSize(levels[i].width, levels[i].height, blockSize);
+    output.assign(dataOffset+dataLength, 0);
+    byte *file = output.data();
+
+    // Header & index
+    memcpy(file, identifier, sizeof(identifier));
+    writeUint32LE(file+12, properties.vkFormat);
+    writeUint32LE(file+16, 1); // type size
+    writeUint32LE(file+20, levels[0].width);
+    writeUint32LE(file+24, levels[0].height);
+    writeUint32LE(file+36, 1); // face count
+    writeUint32LE(file+40, levelCount);
+    writeUint32LE(file+48, (uint32_t) dfdOffset);
+    writeUint32LE(file+52, (uint32_t) dfdLength);
+    writeUint32LE(file+56, (uint32_t) kvdOffset);
+    writeUint32LE(file+60, (uint32_t) kvdLength);
+
+    // Data format descriptor - basic descriptor block with a sample for each independently compressed channel (red, green) or the whole block
+    byte *dfd = file+dfdOffset;
+    writeUint32LE(dfd, (uint32_t) dfdLength);
+    writeUint32LE(dfd+8, 2|(uint32_t) (dfdLength-4)<<16); // version, block size
+    dfd[12] = properties.dfModel;
+    dfd[13] = byte(KTX2_DF_PRIMARIES_BT709);
+    dfd[14] = byte(KTX2_DF_TRANSFER_LINEAR);
+    dfd[16] = 3, dfd[17] = 3; // texel block dimensions minus one
+    dfd[20] = byte(blockSize);
+    for (int i = 0; i < properties.planes; ++i) {
+        byte *sample = dfd+KTX2_DFD_BASE_LENGTH+KTX2_DFD_SAMPLE_LENGTH*i;
+        int bitLength = 8*blockSize/properties.planes;
+        writeUint32LE(sample, i*bitLength|(bitLength-1)<<16|i<<24); // bit offset, bit length minus one, channel
+        writeUint32LE(sample+12, 0xffffffffu); // sample upper
+    }
+
+    memcpy(file+kvdOffset, keyValueData, kvdLength);
+
+    // Level images are stored from the smallest to the largest
+    size_t levelOffset = output.size();
+    for (int i = 0; i < levelCount; ++i) {
+        size_t levelLength = blockCompressedSize(levels[i].width, levels[i].height, blockSize);
+        levelOffset -= levelLength;
+        byte *levelIndex = file+KTX2_HEADER_LENGTH+KTX2_LEVEL_INDEX_LENGTH*i;
+        writeUint64LE(levelIndex, levelOffset);
+        writeUint64LE(levelIndex+8, levelLength);
+        writeUint64LE(levelIndex+16, levelLength);
+        blockCompress(file+levelOffset, levels[i], format, std::max(settings.threadCount, 1));
+    }
+    return true;
+}
+
+template <int N>
+static bool ddsEncode(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, N> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    BlockFormat format;
+    if (!(isMipmapChain(levels, levelCount) && selectBlockFormat(format, N, settings)))
+        return false;
+    BlockFormatProperties properties = blockFormatProperties(format);
+    if (!properties.dxgiFormat)
+        return false;
+    int blockSize = properties.blockSize;
+    size_t baseLength = blockCompressedSize(levels[0].width, levels[0].height, blockSize);
+    size_t dataOffset = 4+DDS_HEADER_LENGTH+DDS_DX10_HEADER_LENGTH;
+    size_t dataLength = 0;
+    for (int i = 0; i < levelCount; ++i)
+        dataLength += blockCompressedSize(levels[i].width, levels[i].height, blockSize);
+    if (baseLength > 0xffffffffu)
+        return false;
+    output.assign(dataOffset+dataLength, 0);
+    byte *file = output.data();
+    memcpy(file, "DDS ", 4);
+    byte *header = file+4;
+    writeUint32LE(header, DDS_HEADER_LENGTH);
+    writeUint32LE(header+4, DDS_FLAGS_TEXTURE|(levelCount > 1 ? DDS_FLAGS_MIPMAP_COUNT : 0));
+    writeUint32LE(header+8, levels[0].height);
+    writeUint32LE(header+12, levels[0].width);
+    writeUint32LE(header+16, (uint32_t) baseLength);
+    writeUint32LE(header+24, levelCount > 1 ? levelCount : 0);
+    writeUint32LE(header+72, 32); // pixel format size
+    writeUint32LE(header+76, DDS_PIXEL_FORMAT_FOURCC);
+    memcpy(header+80, "DX10", 4);
+    writeUint32LE(header+104, DDS_CAPS_TEXTURE|(levelCount > 1 ? DDS_CAPS_MIPMAP : 0));
+    byte *dx10Header = header+DDS_HEADER_LENGTH;
+    writeUint32LE(dx10Header, properties.dxgiFormat);
+    writeUint32LE(dx10Header+4, DDS_DIMENSION_TEXTURE2D);
+    writeUint32LE(dx10Header+12, 1); // array size
+    writeUint32LE(dx10Header+16, N == 3 ? DDS_ALPHA_MODE_OPAQUE : 0);
+    // Level images are stored from the largest to the smallest
+    size_t levelOffset = dataOffset;
+    for (int i = 0; i < levelCount; ++i) {
+        blockCompress(file+levelOffset, levels[i], format, std::max(settings.threadCount, 1));
+        levelOffset += blockCompressedSize(levels[i].width, levels[i].height, blockSize);
+    }
+    return true;
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, const BlockEncoderSettings &settings) {
+    return ktx2Encode(output, &bitmap, 1, settings);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, const BlockEncoderSettings &settings) {
+    return ktx2Encode(output, &bitmap, 1, settings);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, const BlockEncoderSettings &settings) {
+    return ktx2Encode(output, &bitmap, 1, settings);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    return ktx2Encode(output, levels, levelCount, settings);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    return ktx2Encode(output, levels, levelCount, settings);
+}
+
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    return ktx2Encode(output, levels, levelCount, settings);
+}
+
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, const BlockEncoderSettings &settings) {
+    return ddsEncode(output, &bitmap, 1, settings);
+}
+
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, const BlockEncoderSettings &settings) {
+    return ddsEncode(output, &bitmap, 1, settings);
+}
+
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, const BlockEncoderSettings &settings) {
+    return ddsEncode(output, &bitmap, 1, settings);
+}
+
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    return ddsEncode(output, levels, levelCount, settings);
+}
+
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    return ddsEncode(output, levels, levelCount, settings);
+}
+
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *levels, int levelCount, const BlockEncoderSettings &settings) {
+    return ddsEncode(output, levels, levelCount, settings);
+}
+
+}
@@ -5,6 +5,80 @@
 #include <msdfgen.h>
 #include "types.h"
 
+namespace msdf_atlas {
+
+/// Row filtering strategy of the PNG encoder
+enum class PngFilter {
+    NONE,
+    SUB,
+    UP,
+    AVERAGE,
+    PAETH,
+    /// Selects the filter that minimizes the sum of absolute differences for each row
+    ADAPTIVE
+};
+
+/// Configuration of the PNG encoder
+struct PngEncoderSettings {
+    /// zlib compression level (0 = none, 9 = maximum)
+    int compressionLevel;
+    PngFilter filter;
+    /// Number of threads compressing independent strips of rows (only with libpng)
+    int threadCount;
+
+    inline PngEncoderSettings(int compressionLevel = 9, PngFilter filter = PngFilter::ADAPTIVE, int threadCount = 1) : compressionLevel(compressionLevel), filter(filter), threadCount(threadCount) { }
+};
+
+/// Configuration of the floating-point TIFF encoder
+struct TiffEncoderSettings {
+    /// Deflate compression level of the strips, combined with the floating-point predictor (0 = uncompressed, 9 = maximum)
+    int compressionLevel;
+    /// Stores samples as 16-bit half-precision instead of 32-bit floats
+    bool halfFloat;
+    /// Number of threads encoding independent strips of rows
+    int threadCount;
+
+    inline TiffEncoderSettings(int compressionLevel = 0, bool halfFloat = false, int threadCount = 1) : compressionLevel(compressionLevel), halfFloat(halfFloat), threadCount(threadCount) { }
+};
+
+/// Configuration of the GPU block-compressed texture encoder
+struct BlockEncoderSettings {
+    /// Selects EAC (ETC2 family, KTX2 only) instead of BC formats, which requires at most two channels
+    bool eac;
+    /// Number of leading channels of an RGBA image that hold data (e.g. channel-packed), with two it is compressed as BC5 / EAC RG11 instead of BC7 (0 = all)
+    int channelCount;
+    /// Number of threads compressing independent rows of blocks
+    int threadCount;
+
+    inline BlockEncoderSettings(bool eac = false, int channelCount = 0, int threadCount = 1) : eac(eac), channelCount(channelCount), threadCount(threadCount) { }
+};
+
+// Encodes a floating-point image as a TIFF file (half-precision bitmaps always with 16-bit samples), compression requires PNG support (zlib or LodePNG) and is otherwise ignored
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap, const TiffEncoderSettings &settings = TiffEncoderSettings());
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap, const TiffEncoderSettings &settings = TiffEncoderSettings());
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap, const TiffEncoderSettings &settings = TiffEncoderSettings());
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<half, 1> &bitmap, const TiffEncoderSettings &settings = TiffEncoderSettings());
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<half, 3> &bitmap, const TiffEncoderSettings &settings = TiffEncoderSettings());
+bool encodeTiff(std::vector<byte> &output, const msdfgen::BitmapConstRef<half, 4> &bitmap, const TiffEncoderSettings &settings = TiffEncoderSettings());
+
+// Encodes an image as a block-compressed GPU texture in a KTX2 or DDS container, rows are stored top-down
+// Single-channel images are compressed as BC4 / EAC R11, RGBA images with two meaningful channels (settings.channelCount) as BC5 / EAC RG11, others as BC7 (EAC is not available in DDS)
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> &bitmap, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> &bitmap, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> &bitmap, const BlockEncoderSettings &settings = BlockEncoderSettings());
+// Encodes a mipmap chain (full resolution first, each level half the size of the previous one) as a single block-compressed texture
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *levels, int levelCount, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *levels, int levelCount, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeKtx2(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *levels, int levelCount, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 1> *levels, int levelCount, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 3> *levels, int levelCount, const BlockEncoderSettings &settings = BlockEncoderSettings());
+bool encodeDds(std::vector<byte> &output, const msdfgen::BitmapConstRef<byte, 4> *levels, int levelCount, const BlockEncoderSettings &settings = BlockEncoderSettings());
+
+}
+
 #ifndef MSDFGEN_DISABLE_PNG
 
 namespace msdf_atlas {
@@ -12,12 +86,16 @@ namespace msdf_atlas {
 // Functions to encode an image as a sequence of bytes in memory
 // Only PNG format available currently
 
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap);
-bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap);
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 1> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 3> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<msdfgen::byte, 4> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 1> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 3> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<float, 4> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+// 16-bit unsigned normalized bitmaps are encoded with 16 bits per sample
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 1> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 3> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
+bool encodePng(std::vector<byte> &output, const msdfgen::BitmapConstRef<unorm16, 4> &bitmap, const PngEncoderSettings &settings = PngEncoderSettings());
 
 }
 
@@ -3,12 +3,16 @@
 
 #include <msdfgen.h>
 #include "types.h"
+#include "image-encode.h"
 
 namespace msdf_atlas {
 
-/// Saves the bitmap as an image file with the specified format
+/// Saves the bitmap as an image file with the specified format, blockSettings apply to block-compressed formats, bitmapYDirection is the row order of the bitmap in memory
 template <typename T, int N>
-bool saveImage(const msdfgen::BitmapConstRef<T, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP);
+bool saveImage(const msdfgen::BitmapConstRef<T, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP, const PngEncoderSettings &pngSettings = PngEncoderSettings(), const TiffEncoderSettings &tiffSettings = TiffEncoderSettings(), const BlockEncoderSettings &blockSettings = BlockEncoderSettings(), YDirection bitmapYDirection = YDirection::BOTTOM_UP);
+/// Saves a mipmap chain (full resolution first) as a single image file, only block-compressed formats (KTX2, DDS) are supported
+template <typename T, int N>
+bool saveImageMipmaps(const msdfgen::BitmapConstRef<T, N> *levels, int levelCount, ImageFormat format, const char *filename, const BlockEncoderSettings &blockSettings = BlockEncoderSettings());
 
 }
 
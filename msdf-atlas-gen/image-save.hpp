@@ -2,28 +2,53 @@
 #include "image-save.h"
 
 #include <cstdio>
+#include <vector>
 #include <msdfgen-ext.h>
+#include "BufferedFileWriter.h"
+#include "number-format.h"
+#include "bitmap-blit.h"
 
 namespace msdf_atlas {
 
+#ifndef MSDFGEN_DISABLE_PNG
+template <typename T, int N>
+bool saveImagePng(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename, const PngEncoderSettings &settings);
+#endif
+template <typename T, int N>
+bool saveImageTiff(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename, const TiffEncoderSettings &settings);
 template <int N>
-bool saveImageBinary(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageBlockCompressed(const msdfgen::BitmapConstRef<byte, N> *levels, int levelCount, ImageFormat format, const char *filename, const BlockEncoderSettings &settings);
 template <int N>
-bool saveImageBinaryLE(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageBinary(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection);
 template <int N>
-bool saveImageBinaryBE(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageBinaryLE(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection);
+template <int N>
+bool saveImageBinaryBE(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection);
+template <typename T, int N>
+bool saveImageBinary16LE(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection);
 
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageText(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection);
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection);
+bool saveImageText(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection);
+
+/// Returns true if the image format's writer can output the bitmap rows in either order without a flipped copy
+inline bool isRowOrderAgnosticFormat(ImageFormat format) {
+    return format == ImageFormat::TEXT || format == ImageFormat::TEXT_FLOAT || format == ImageFormat::BINARY || format == ImageFormat::BINARY_FLOAT || format == ImageFormat::BINARY_FLOAT_BE || format == ImageFormat::BINARY_UNORM16 || format == ImageFormat::BINARY_HALF;
+}
 
 template <int N>
-bool saveImage(const msdfgen::BitmapConstRef<byte, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP) {
+bool saveImage(const msdfgen::BitmapConstRef<byte, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP, const PngEncoderSettings &pngSettings = PngEncoderSettings(), const TiffEncoderSettings &tiffSettings = TiffEncoderSettings(), const BlockEncoderSettings &blockSettings = BlockEncoderSettings(), YDirection bitmapYDirection = YDirection::BOTTOM_UP) {
+    if (bitmapYDirection != YDirection::BOTTOM_UP && !isRowOrderAgnosticFormat(format)) {
+        msdfgen::Bitmap<byte, N> flipped(bitmap.width, bitmap.height);
+        blitFlippedY(flipped, bitmap, 0, 0, 0, 0, bitmap.width, bitmap.height);
+        msdfgen::BitmapConstRef<byte, N> flippedRef = flipped;
+        return saveImage(flippedRef, format, filename, outputYDirection, pngSettings, tiffSettings, blockSettings);
+    }
     switch (format) {
     #ifndef MSDFGEN_DISABLE_PNG
         case ImageFormat::PNG:
-            return msdfgen::savePng(bitmap, filename);
+            return saveImagePng(bitmap, filename, pngSettings);
     #endif
         case ImageFormat::BMP:
             return msdfgen::saveBmp(bitmap, filename);
@@ -34,30 +59,39 @@ bool saveImage(const msdfgen::BitmapConstRef<byte, N> &bitmap, ImageFormat forma
         case ImageFormat::FL32:
             return false;
         case ImageFormat::TEXT:
-            return saveImageText(bitmap, filename, outputYDirection);
+            return saveImageText(bitmap, filename, bitmapYDirection, outputYDirection);
         case ImageFormat::TEXT_FLOAT:
             return false;
         case ImageFormat::BINARY:
-            return saveImageBinary(bitmap, filename, outputYDirection);
+            return saveImageBinary(bitmap, filename, bitmapYDirection, outputYDirection);
         case ImageFormat::BINARY_FLOAT:
         case ImageFormat::BINARY_FLOAT_BE:
             return false;
+        case ImageFormat::KTX2:
+        case ImageFormat::DDS:
+            return saveImageBlockCompressed(&bitmap, 1, format, filename, blockSettings);
         default:;
     }
     return false;
 }
 
 template <int N>
-bool saveImage(const msdfgen::BitmapConstRef<float, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP) {
+bool saveImage(const msdfgen::BitmapConstRef<float, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP, const PngEncoderSettings &pngSettings = PngEncoderSettings(), const TiffEncoderSettings &tiffSettings = TiffEncoderSettings(), const BlockEncoderSettings &blockSettings = BlockEncoderSettings(), YDirection bitmapYDirection = YDirection::BOTTOM_UP) {
+    if (bitmapYDirection != YDirection::BOTTOM_UP && !isRowOrderAgnosticFormat(format)) {
+        msdfgen::Bitmap<float, N> flipped(bitmap.width, bitmap.height);
+        blitFlippedY(flipped, bitmap, 0, 0, 0, 0, bitmap.width, bitmap.height);
+        msdfgen::BitmapConstRef<float, N> flippedRef = flipped;
+        return saveImage(flippedRef, format, filename, outputYDirection, pngSettings, tiffSettings, blockSettings);
+    }
     switch (format) {
     #ifndef MSDFGEN_DISABLE_PNG
         case ImageFormat::PNG:
-            return msdfgen::savePng(bitmap, filename);
+            return saveImagePng(bitmap, filename, pngSettings);
     #endif
         case ImageFormat::BMP:
             return msdfgen::saveBmp(bitmap, filename);
         case ImageFormat::TIFF:
-            return msdfgen::saveTiff(bitmap, filename);
+            return saveImageTiff(bitmap, filename, tiffSettings);
         case ImageFormat::RGBA:
             return msdfgen::saveRgba(bitmap, filename);
         case ImageFormat::FL32:
@@ -65,36 +99,131 @@ bool saveImage(const msdfgen::BitmapConstRef<float, N> &bitmap, ImageFormat form
         case ImageFormat::TEXT:
             return false;
         case ImageFormat::TEXT_FLOAT:
-            return saveImageText(bitmap, filename, outputYDirection);
+            return saveImageText(bitmap, filename, bitmapYDirection, outputYDirection);
         case ImageFormat::BINARY:
             return false;
         case ImageFormat::BINARY_FLOAT:
-            return saveImageBinaryLE(bitmap, filename, outputYDirection);
+            return saveImageBinaryLE(bitmap, filename, bitmapYDirection, outputYDirection);
         case ImageFormat::BINARY_FLOAT_BE:
-            return saveImageBinaryBE(bitmap, filename, outputYDirection);
+            return saveImageBinaryBE(bitmap, filename, bitmapYDirection, outputYDirection);
+        case ImageFormat::KTX2:
+        case ImageFormat::DDS:
+            return false;
         default:;
     }
     return false;
 }
 
 template <int N>
-bool saveImageBinary(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection) {
-    bool success = false;
-    if (FILE *f = fopen(filename, "wb")) {
-        size_t written = 0;
-        switch (outputYDirection) {
-            case YDirection::BOTTOM_UP:
-                written = fwrite(bitmap.pixels, 1, (size_t) N*bitmap.width*bitmap.height, f);
-                break;
-            case YDirection::TOP_DOWN:
-                for (int y = bitmap.height-1; y >= 0; --y)
-                    written += fwrite(bitmap.pixels+(size_t) N*bitmap.width*y, 1, (size_t) N*bitmap.width, f);
-                break;
-        }
-        success = written == (size_t) N*bitmap.width*bitmap.height;
-        fclose(f);
+bool saveImage(const msdfgen::BitmapConstRef<unorm16, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP, const PngEncoderSettings &pngSettings = PngEncoderSettings(), const TiffEncoderSettings &tiffSettings = TiffEncoderSettings(), const BlockEncoderSettings &blockSettings = BlockEncoderSettings(), YDirection bitmapYDirection = YDirection::BOTTOM_UP) {
+    if (bitmapYDirection != YDirection::BOTTOM_UP && !isRowOrderAgnosticFormat(format)) {
+        msdfgen::Bitmap<unorm16, N> flipped(bitmap.width, bitmap.height);
+        blitFlippedY(flipped, bitmap, 0, 0, 0, 0, bitmap.width, bitmap.height);
+        msdfgen::BitmapConstRef<unorm16, N> flippedRef = flipped;
+        return saveImage(flippedRef, format, filename, outputYDirection, pngSettings, tiffSettings, blockSettings);
+    }
+    switch (format) {
+    #ifndef MSDFGEN_DISABLE_PNG
+        case ImageFormat::PNG16:
+            return saveImagePng(bitmap, filename, pngSettings);
+    #endif
+        case ImageFormat::BINARY_UNORM16:
+            return saveImageBinary16LE(bitmap, filename, bitmapYDirection, outputYDirection);
+        default:;
+    }
+    return false;
+}
+
+template <int N>
+bool saveImage(const msdfgen::BitmapConstRef<half, N> &bitmap, ImageFormat format, const char *filename, YDirection outputYDirection = YDirection::BOTTOM_UP, const PngEncoderSettings &pngSettings = PngEncoderSettings(), const TiffEncoderSettings &tiffSettings = TiffEncoderSettings(), const BlockEncoderSettings &blockSettings = BlockEncoderSettings(), YDirection bitmapYDirection = YDirection::BOTTOM_UP) {
+    if (bitmapYDirection != YDirection::BOTTOM_UP && !isRowOrderAgnosticFormat(format)) {
+        msdfgen::Bitmap<half, N> flipped(bitmap.width, bitmap.height);
+        blitFlippedY(flipped, bitmap, 0, 0, 0, 0, bitmap.width, bitmap.height);
+        msdfgen::BitmapConstRef<half, N> flippedRef = flipped;
+        return saveImage(flippedRef, format, filename, outputYDirection, pngSettings, tiffSettings, blockSettings);
+    }
+    switch (format) {
+        case ImageFormat::TIFF:
+            return saveImageTiff(bitmap, filename, tiffSettings);
+        case ImageFormat::BINARY_HALF:
+            return saveImageBinary16LE(bitmap, filename, bitmapYDirection, outputYDirection);
+        default:;
+    }
+    return false;
+}
+
+template <int N>
+bool saveImageMipmaps(const msdfgen::BitmapConstRef<byte, N> *levels, int levelCount, ImageFormat format, const char *filename, const BlockEncoderSettings &blockSettings = BlockEncoderSettings()) {
+    if (format == ImageFormat::KTX2 || format == ImageFormat::DDS)
+        return saveImageBlockCompressed(levels, levelCount, format, filename, blockSettings);
+    return false;
+}
+
+template <int N>
+bool saveImageMipmaps(const msdfgen::BitmapConstRef<float, N> *, int, ImageFormat, const char *, const BlockEncoderSettings & = BlockEncoderSettings()) {
+    return false;
+}
+
+template <int N>
+bool saveImageMipmaps(const msdfgen::BitmapConstRef<unorm16, N> *, int, ImageFormat, const char *, const BlockEncoderSettings & = BlockEncoderSettings()) {
+    return false;
+}
+
+template <int N>
+bool saveImageMipmaps(const msdfgen::BitmapConstRef<half, N> *, int, ImageFormat, const char *, const BlockEncoderSettings & = BlockEncoderSettings()) {
+    return false;
+}
+
+#ifndef MSDFGEN_DISABLE_PNG
+template <typename T, int N>
+bool saveImagePng(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename, const PngEncoderSettings &settings) {
+    std::vector<byte> data;
+    if (!encodePng(data, bitmap, settings))
+        return false;
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    writer.write(data.data(), data.size());
+    return writer.close();
+}
+#endif
+
+template <typename T, int N>
+bool saveImageTiff(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename, const TiffEncoderSettings &settings) {
+    std::vector<byte> data;
+    if (!encodeTiff(data, bitmap, settings))
+        return false;
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    writer.write(data.data(), data.size());
+    return writer.close();
+}
+
+template <int N>
+bool saveImageBlockCompressed(const msdfgen::BitmapConstRef<byte, N> *levels, int levelCount, ImageFormat format, const char *filename, const BlockEncoderSettings &settings) {
+    std::vector<byte> data;
+    if (!(format == ImageFormat::KTX2 ? encodeKtx2(data, levels, levelCount, settings) : encodeDds(data, levels, levelCount, settings)))
+        return false;
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    writer.write(data.data(), data.size());
+    return writer.close();
+}
+
+template <int N>
+bool saveImageBinary(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection) {
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    if (outputYDirection == bitmapYDirection)
+        writer.write(bitmap.pixels, (size_t) N*bitmap.width*bitmap.height);
+    else {
+        for (int y = bitmap.height-1; y >= 0; --y)
+            writer.write(bitmap.pixels+(size_t) N*bitmap.width*y, (size_t) N*bitmap.width);
     }
-    return success;
+    return writer.close();
 }
 
 template <int N>
@@ -104,23 +233,17 @@ bool
     #else
         saveImageBinaryLE
     #endif
-        (const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
-    bool success = false;
-    if (FILE *f = fopen(filename, "wb")) {
-        size_t written = 0;
-        switch (outputYDirection) {
-            case YDirection::BOTTOM_UP:
-                written = fwrite(bitmap.pixels, sizeof(float), (size_t) N*bitmap.width*bitmap.height, f);
-                break;
-            case YDirection::TOP_DOWN:
-                for (int y = bitmap.height-1; y >= 0; --y)
-                    written += fwrite(bitmap.pixels+(size_t) N*bitmap.width*y, sizeof(float), (size_t) N*bitmap.width, f);
-                break;
-        }
-        success = written == (size_t) N*bitmap.width*bitmap.height;
-        fclose(f);
+        (const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection) {
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    if (outputYDirection == bitmapYDirection)
+        writer.write(bitmap.pixels, sizeof(float)*(size_t) N*bitmap.width*bitmap.height);
+    else {
+        for (int y = bitmap.height-1; y >= 0; --y)
+            writer.write(bitmap.pixels+(size_t) N*bitmap.width*y, sizeof(float)*(size_t) N*bitmap.width);
     }
-    return success;
+    return writer.close();
 }
 
 template <int N>
@@ -130,55 +253,73 @@ bool
     #else
         saveImageBinaryBE
     #endif
-        (const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
-    bool success = false;
-    if (FILE *f = fopen(filename, "wb")) {
-        size_t written = 0;
-        for (int y = 0; y < bitmap.height; ++y) {
-            const float *p = bitmap.pixels+(size_t) N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y);
-            for (int x = 0; x < bitmap.width; ++x) {
-                const unsigned char *b = reinterpret_cast<const unsigned char *>(p++);
-                for (int i = sizeof(float)-1; i >= 0; --i)
-                    written += fwrite(b+i, 1, 1, f);
-            }
-        }
-        success = written == sizeof(float)*N*bitmap.width*bitmap.height;
-        fclose(f);
+        (const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection) {
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    if (outputYDirection == bitmapYDirection)
+        writer.writeByteSwapped32(bitmap.pixels, (size_t) N*bitmap.width*bitmap.height);
+    else {
+        for (int y = bitmap.height-1; y >= 0; --y)
+            writer.writeByteSwapped32(bitmap.pixels+(size_t) N*bitmap.width*y, (size_t) N*bitmap.width);
     }
-    return success;
+    return writer.close();
 }
 
+template <typename T, int N>
+bool saveImageBinary16LE(const msdfgen::BitmapConstRef<T, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection) {
+    static_assert(sizeof(T) == 2, "Only for 16-bit samples");
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    size_t rowSamples = (size_t) N*bitmap.width;
+    for (int y = 0; y < bitmap.height; ++y) {
+        const T *row = bitmap.pixels+rowSamples*(outputYDirection != bitmapYDirection ? bitmap.height-y-1 : y);
+    #ifdef __BIG_ENDIAN__
+        writer.writeByteSwapped16(row, rowSamples);
+    #else
+        writer.write(row, sizeof(T)*rowSamples);
+    #endif
+    }
+    return writer.close();
+}
 
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection outputYDirection) {
-    bool success = false;
-    if (FILE *f = fopen(filename, "wb")) {
-        success = true;
-        for (int y = 0; y < bitmap.height; ++y) {
-            const byte *p = bitmap.pixels+(size_t) N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y);
-            for (int x = 0; x < N*bitmap.width; ++x)
-                success &= fprintf(f, x ? " %02X" : "%02X", (unsigned) *p++) > 0;
-            success &= fprintf(f, "\n") > 0;
+bool saveImageText(const msdfgen::BitmapConstRef<byte, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection) {
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    for (int y = 0; y < bitmap.height; ++y) {
+        const byte *p = bitmap.pixels+(size_t) N*bitmap.width*(outputYDirection != bitmapYDirection ? bitmap.height-y-1 : y);
+        char *cur = writer.reserve((size_t) (MSDF_ATLAS_HEX_BYTE_MAX_LENGTH+1)*N*bitmap.width+1);
+        for (int x = 0; x < N*bitmap.width; ++x) {
+            if (x)
+                *cur++ = ' ';
+            cur = formatHexByte(cur, *p++);
         }
-        fclose(f);
+        *cur++ = '\n';
+        writer.commit(cur);
     }
-    return success;
+    return writer.close();
 }
 
 template <int N>
-bool saveImageText(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection outputYDirection) {
-    bool success = false;
-    if (FILE *f = fopen(filename, "wb")) {
-        success = true;
-        for (int y = 0; y < bitmap.height; ++y) {
-            const float *p = bitmap.pixels+(size_t) N*bitmap.width*(outputYDirection == YDirection::TOP_DOWN ? bitmap.height-y-1 : y);
-            for (int x = 0; x < N*bitmap.width; ++x)
-                success &= fprintf(f, x ? " %g" : "%g", *p++) > 0;
-            success &= fprintf(f, "\n") > 0;
+bool saveImageText(const msdfgen::BitmapConstRef<float, N> &bitmap, const char *filename, YDirection bitmapYDirection, YDirection outputYDirection) {
+    BufferedFileWriter writer;
+    if (!writer.open(filename))
+        return false;
+    for (int y = 0; y < bitmap.height; ++y) {
+        const float *p = bitmap.pixels+(size_t) N*bitmap.width*(outputYDirection != bitmapYDirection ? bitmap.height-y-1 : y);
+        char *cur = writer.reserve((size_t) (MSDF_ATLAS_FLOAT_G_MAX_LENGTH+1)*N*bitmap.width+1);
+        for (int x = 0; x < N*bitmap.width; ++x) {
+            if (x)
+                *cur++ = ' ';
+            cur = formatFloatG(cur, *p++);
         }
-        fclose(f);
+        *cur++ = '\n';
+        writer.commit(cur);
     }
-    return success;
+    return writer.close();
 }
 
 }
@@ -2,7 +2,11 @@
 #include "json-export.h"
 
 #include <string>
+#include <vector>
 #include "GlyphGeometry.h"
+#include "Workload.h"
+#include "BufferedFileWriter.h"
+#include "number-format.h"
 
 namespace msdf_atlas {
 
@@ -58,151 +62,197 @@ static const char *imageTypeString(ImageType type) {
     return nullptr;
 }
 
-bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning) {
-    FILE *f = fopen(filename, "w");
-    if (!f)
-        return false;
-    fputs("{", f);
+static void appendBounds(std::string &json, const char *key, const char *name1, double value1, const char *name2, double value2, const char *name3, double value3, const char *name4, double value4) {
+    json += ",\"", json += key, json += "\":{\"", json += name1, json += "\":";
+    appendDouble(json, value1);
+    json += ",\"", json += name2, json += "\":";
+    appendDouble(json, value2);
+    json += ",\"", json += name3, json += "\":";
+    appendDouble(json, value3);
+    json += ",\"", json += name4, json += "\":";
+    appendDouble(json, value4);
+    json += '}';
+}
+
+static std::string fontJSON(const FontGeometry &font, const JsonAtlasMetrics &metrics, bool kerning) {
+    std::string json;
+    json.reserve(128*font.getGlyphs().size()+(kerning ? 48*font.getKerningTable().size() : 0)+512);
+
+    // Font name
+    const char *name = font.getName();
+    if (name)
+        json += "\"name\":\"", json += escapeJsonString(name), json += "\",";
+
+    // Font metrics
+    json += "\"metrics\":{"; {
+        double yFactor = metrics.yDirection == YDirection::TOP_DOWN ? -1 : 1;
+        const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
+        json += "\"emSize\":", appendDouble(json, fontMetrics.emSize);
+        json += ",\"lineHeight\":", appendDouble(json, fontMetrics.lineHeight);
+        json += ",\"ascender\":", appendDouble(json, yFactor*fontMetrics.ascenderY);
+        json += ",\"descender\":", appendDouble(json, yFactor*fontMetrics.descenderY);
+        json += ",\"underlineY\":", appendDouble(json, yFactor*fontMetrics.underlineY);
+        json += ",\"underlineThickness\":", appendDouble(json, fontMetrics.underlineThickness);
+    } json += "},";
+
+    // Glyph mapping
+    json += "\"glyphs\":[";
+    bool firstGlyph = true;
+    for (const GlyphGeometry &glyph : font.getGlyphs()) {
+        json += firstGlyph ? "{" : ",{";
+        switch (font.getPreferredIdentifierType()) {
+            case GlyphIdentifierType::GLYPH_INDEX:
+                json += "\"index\":", appendInt(json, glyph.getIndex());
+                break;
+            case GlyphIdentifierType::UNICODE_CODEPOINT:
+                json += "\"unicode\":", appendUnsigned(json, glyph.getCodepoint());
+                break;
+        }
+        json += ",\"advance\":", appendDouble(json, glyph.getAdvance());
+        if (metrics.multiPage)
+            json += ",\"page\":", appendInt(json, glyph.getBoxPage());
+        if (metrics.packedChannels > 1)
+            json += ",\"channel\":", appendInt(json, glyph.getBoxChannel());
+        double l, b, r, t;
+        glyph.getQuadPlaneBounds(l, b, r, t);
+        if (l || b || r || t) {
+            switch (metrics.yDirection) {
+                case YDirection::BOTTOM_UP:
+                    appendBounds(json, "planeBounds", "left", l, "bottom", b, "right", r, "top", t);
+                    break;
+                case YDirection::TOP_DOWN:
+                    appendBounds(json, "planeBounds", "left", l, "top", -t, "right", r, "bottom", -b);
+                    break;
+            }
+        }
+        glyph.getQuadAtlasBounds(l, b, r, t);
+        if (l || b || r || t) {
+            switch (metrics.yDirection) {
+                case YDirection::BOTTOM_UP:
+                    appendBounds(json, "atlasBounds", "left", l, "bottom", b, "right", r, "top", t);
+                    break;
+                case YDirection::TOP_DOWN:
+                    appendBounds(json, "atlasBounds", "left", l, "top", metrics.height-t, "right", r, "bottom", metrics.height-b);
+                    break;
+            }
+        }
+        json += '}';
+        firstGlyph = false;
+    } json += ']';
+
+    // Kerning pairs
+    if (kerning) {
+        json += ",\"kerning\":[";
+        bool firstPair = true;
+        switch (font.getPreferredIdentifierType()) {
+            case GlyphIdentifierType::GLYPH_INDEX:
+                for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerningTable()) {
+                    json += firstPair ? "{" : ",{";
+                    json += "\"index1\":", appendInt(json, kernPair.first.first);
+                    json += ",\"index2\":", appendInt(json, kernPair.first.second);
+                    json += ",\"advance\":", appendDouble(json, kernPair.second);
+                    json += '}';
+                    firstPair = false;
+                }
+                break;
+            case GlyphIdentifierType::UNICODE_CODEPOINT:
+                for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerningTable()) {
+                    const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
+                    const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
+                    if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
+                        json += firstPair ? "{" : ",{";
+                        json += "\"unicode1\":", appendUnsigned(json, glyph1->getCodepoint());
+                        json += ",\"unicode2\":", appendUnsigned(json, glyph2->getCodepoint());
+                        json += ",\"advance\":", appendDouble(json, kernPair.second);
+                        json += '}';
+                        firstPair = false;
+                    }
+                }
+                break;
+        } json += ']';
+    }
+    return json;
+}
+
+bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning, int threadCount) {
+    // Fonts are formatted in parallel, each into its own string
+    std::vector<std::string> fontStrings(fontCount);
+    Workload([fonts, &metrics, kerning, &fontStrings](int i, int) -> bool {
+        fontStrings[i] = fontJSON(fonts[i], metrics, kerning);
+        return true;
+    }, fontCount).finish(threadCount);
+
+    std::string json = "{";
 
     // Atlas properties
-    fputs("\"atlas\":{", f); {
-        fprintf(f, "\"type\":\"%s\",", imageTypeString(imageType));
+    json += "\"atlas\":{"; {
+        json += "\"type\":\"", json += imageTypeString(imageType), json += "\",";
         if (imageType == ImageType::SDF || imageType == ImageType::PSDF || imageType == ImageType::MSDF || imageType == ImageType::MTSDF) {
-            fprintf(f, "\"distanceRange\":%.17g,", metrics.distanceRange.upper-metrics.distanceRange.lower);
-            fprintf(f, "\"distanceRangeMiddle\":%.17g,", .5*(metrics.distanceRange.lower+metrics.distanceRange.upper));
+            json += "\"distanceRange\":", appendDouble(json, metrics.distanceRange.upper-metrics.distanceRange.lower), json += ',';
+            json += "\"distanceRangeMiddle\":", appendDouble(json, .5*(metrics.distanceRange.lower+metrics.distanceRange.upper)), json += ',';
         }
-        fprintf(f, "\"size\":%.17g,", metrics.size);
-        fprintf(f, "\"width\":%d,", metrics.width);
-        fprintf(f, "\"height\":%d,", metrics.height);
-        fprintf(f, "\"yOrigin\":\"%s\"", metrics.yDirection == YDirection::TOP_DOWN ? "top" : "bottom");
+        json += "\"size\":", appendDouble(json, metrics.size), json += ',';
+        json += "\"width\":", appendInt(json, metrics.width), json += ',';
+        json += "\"height\":", appendInt(json, metrics.height), json += ',';
+        if (metrics.multiPage)
+            json += "\"pages\":", appendInt(json, metrics.pages), json += ',';
+        if (metrics.packedChannels > 1)
+            json += "\"packedChannels\":", appendInt(json, metrics.packedChannels), json += ',';
+        json += "\"yOrigin\":\"", json += metrics.yDirection == YDirection::TOP_DOWN ? "top" : "bottom", json += '"';
         if (metrics.grid) {
-            fputs(",\"grid\":{", f);
-            fprintf(f, "\"cellWidth\":%d,", metrics.grid->cellWidth);
-            fprintf(f, "\"cellHeight\":%d,", metrics.grid->cellHeight);
-            fprintf(f, "\"columns\":%d,", metrics.grid->columns);
-            fprintf(f, "\"rows\":%d", metrics.grid->rows);
+            json += ",\"grid\":{";
+            json += "\"cellWidth\":", appendInt(json, metrics.grid->cellWidth), json += ',';
+            json += "\"cellHeight\":", appendInt(json, metrics.grid->cellHeight), json += ',';
+            json += "\"columns\":", appendInt(json, metrics.grid->columns), json += ',';
+            json += "\"rows\":", appendInt(json, metrics.grid->rows);
             if (metrics.grid->originX)
-                fprintf(f, ",\"originX\":%.17g", *metrics.grid->originX);
+                json += ",\"originX\":", appendDouble(json, *metrics.grid->originX);
             if (metrics.grid->originY) {
                 switch (metrics.yDirection) {
                     case YDirection::BOTTOM_UP:
-                        fprintf(f, ",\"originY\":%.17g", *metrics.grid->originY);
+                        json += ",\"originY\":", appendDouble(json, *metrics.grid->originY);
                         break;
                     case YDirection::TOP_DOWN:
-                        fprintf(f, ",\"originY\":%.17g", (metrics.grid->cellHeight-metrics.grid->spacing-1)/metrics.size-*metrics.grid->originY);
+                        json += ",\"originY\":", appendDouble(json, (metrics.grid->cellHeight-metrics.grid->spacing-1)/metrics.size-*metrics.grid->originY);
                         break;
                 }
             }
-            fputs("}", f);
+            json += '}';
         }
-    } fputs("},", f);
-
-    if (fontCount > 1)
-        fputs("\"variants\":[", f);
-    for (int i = 0; i < fontCount; ++i) {
-        const FontGeometry &font = fonts[i];
-        if (fontCount > 1)
-            fputs(i == 0 ? "{" : ",{", f);
-
-        // Font name
-        const char *name = font.getName();
-        if (name)
-            fprintf(f, "\"name\":\"%s\",", escapeJsonString(name).c_str());
-
-        // Font metrics
-        fputs("\"metrics\":{", f); {
-            double yFactor = metrics.yDirection == YDirection::TOP_DOWN ? -1 : 1;
-            const msdfgen::FontMetrics &fontMetrics = font.getMetrics();
-            fprintf(f, "\"emSize\":%.17g,", fontMetrics.emSize);
-            fprintf(f, "\"lineHeight\":%.17g,", fontMetrics.lineHeight);
-            fprintf(f, "\"ascender\":%.17g,", yFactor*fontMetrics.ascenderY);
-            fprintf(f, "\"descender\":%.17g,", yFactor*fontMetrics.descenderY);
-            fprintf(f, "\"underlineY\":%.17g,", yFactor*fontMetrics.underlineY);
-            fprintf(f, "\"underlineThickness\":%.17g", fontMetrics.underlineThickness);
-        } fputs("},", f);
-
-        // Glyph mapping
-        fputs("\"glyphs\":[", f);
-        bool firstGlyph = true;
-        for (const GlyphGeometry &glyph : font.getGlyphs()) {
-            fputs(firstGlyph ? "{" : ",{", f);
-            switch (font.getPreferredIdentifierType()) {
-                case GlyphIdentifierType::GLYPH_INDEX:
-                    fprintf(f, "\"index\":%d,", glyph.getIndex());
+        if (metrics.shelves) {
+            json += ",\"shelves\":{";
+            json += "\"shelfHeight\":", appendInt(json, metrics.shelves->shelfHeight), json += ',';
+            json += "\"stride\":", appendInt(json, metrics.shelves->shelfHeight+metrics.shelves->spacing), json += ',';
+            json += "\"count\":", appendInt(json, metrics.shelves->shelves), json += ',';
+            switch (metrics.yDirection) {
+                case YDirection::BOTTOM_UP:
+                    json += "\"originY\":", appendDouble(json, metrics.shelves->originY);
                     break;
-                case GlyphIdentifierType::UNICODE_CODEPOINT:
-                    fprintf(f, "\"unicode\":%u,", glyph.getCodepoint());
+                case YDirection::TOP_DOWN:
+                    json += "\"originY\":", appendDouble(json, (metrics.shelves->shelfHeight-1)/metrics.size-metrics.shelves->originY);
                     break;
             }
-            fprintf(f, "\"advance\":%.17g", glyph.getAdvance());
-            double l, b, r, t;
-            glyph.getQuadPlaneBounds(l, b, r, t);
-            if (l || b || r || t) {
-                switch (metrics.yDirection) {
-                    case YDirection::BOTTOM_UP:
-                        fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
-                        break;
-                    case YDirection::TOP_DOWN:
-                        fprintf(f, ",\"planeBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}", l, -t, r, -b);
-                        break;
-                }
-            }
-            glyph.getQuadAtlasBounds(l, b, r, t);
-            if (l || b || r || t) {
-                switch (metrics.yDirection) {
-                    case YDirection::BOTTOM_UP:
-                        fprintf(f, ",\"atlasBounds\":{\"left\":%.17g,\"bottom\":%.17g,\"right\":%.17g,\"top\":%.17g}", l, b, r, t);
-                        break;
-                    case YDirection::TOP_DOWN:
-                        fprintf(f, ",\"atlasBounds\":{\"left\":%.17g,\"top\":%.17g,\"right\":%.17g,\"bottom\":%.17g}", l, metrics.height-t, r, metrics.height-b);
-                        break;
-                }
-            }
-            fputs("}", f);
-            firstGlyph = false;
-        } fputs("]", f);
-
-        // Kerning pairs
-        if (kerning) {
-            fputs(",\"kerning\":[", f);
-            bool firstPair = true;
-            switch (font.getPreferredIdentifierType()) {
-                case GlyphIdentifierType::GLYPH_INDEX:
-                    for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
-                        fputs(firstPair ? "{" : ",{", f);
-                        fprintf(f, "\"index1\":%d,", kernPair.first.first);
-                        fprintf(f, "\"index2\":%d,", kernPair.first.second);
-                        fprintf(f, "\"advance\":%.17g", kernPair.second);
-                        fputs("}", f);
-                        firstPair = false;
-                    }
-                    break;
-                case GlyphIdentifierType::UNICODE_CODEPOINT:
-                    for (const std::pair<std::pair<int, int>, double> &kernPair : font.getKerning()) {
-                        const GlyphGeometry *glyph1 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.first));
-                        const GlyphGeometry *glyph2 = font.getGlyph(msdfgen::GlyphIndex(kernPair.first.second));
-                        if (glyph1 && glyph2 && glyph1->getCodepoint() && glyph2->getCodepoint()) {
-                            fputs(firstPair ? "{" : ",{", f);
-                            fprintf(f, "\"unicode1\":%u,", glyph1->getCodepoint());
-                            fprintf(f, "\"unicode2\":%u,", glyph2->getCodepoint());
-                            fprintf(f, "\"advance\":%.17g", kernPair.second);
-                            fputs("}", f);
-                            firstPair = false;
-                        }
-                    }
-                    break;
-            } fputs("]", f);
+            json += '}';
         }
+    } json += "},";
 
+    BufferedFileWriter writer;
+    if (!writer.open(filename, true))
+        return false;
+    if (fontCount > 1)
+        json += "\"variants\":[";
+    writer.write(json.data(), json.size());
+    for (int i = 0; i < fontCount; ++i) {
+        if (fontCount > 1)
+            writer.write(i == 0 ? "{" : ",{");
+        writer.write(fontStrings[i].data(), fontStrings[i].size());
         if (fontCount > 1)
-            fputs("}", f);
+            writer.write("}");
     }
     if (fontCount > 1)
-        fputs("]", f);
-
-    fputs("}\n", f);
-    fclose(f);
-    return true;
+        writer.write("]");
+    writer.write("}\n");
+    return writer.close();
 }
 
 }
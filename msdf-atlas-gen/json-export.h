@@ -15,14 +15,24 @@ struct JsonAtlasMetrics {
         const double *originX, *originY;
         int spacing;
     };
+    struct ShelfMetrics {
+        int shelfHeight;
+        int shelves;
+        double originY;
+        int spacing;
+    };
     msdfgen::Range distanceRange;
     double size;
     int width, height;
+    int pages;
+    bool multiPage;
+    int packedChannels;
     YDirection yDirection;
     const GridMetrics *grid;
+    const ShelfMetrics *shelves;
 };
 
-/// Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file
-bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning);
+/// Writes the font and glyph metrics and atlas layout data into a comprehensive JSON file, each font is formatted on a separate thread (up to threadCount threads)
+bool exportJSON(const FontGeometry *fonts, int fontCount, ImageType imageType, const JsonAtlasMetrics &metrics, const char *filename, bool kerning, int threadCount = 1);
 
 }
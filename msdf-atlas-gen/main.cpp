@@ -11,8 +11,12 @@
 #include <cstdio>
 #include <cmath>
 #include <cstring>
+#include <climits>
 #include <cassert>
 #include <vector>
+#include <string>
+#include <map>
+#include <deque>
 #include <algorithm>
 #include <thread>
 
@@ -24,6 +28,7 @@ using namespace msdf_atlas;
 #define DEFAULT_ANGLE_THRESHOLD 3.0
 #define DEFAULT_MITER_LIMIT 1.0
 #define DEFAULT_PIXEL_RANGE 2.0
+#define MAX_MIP_LEVELS 12
 #define SDF_ERROR_ESTIMATE_PRECISION 19
 #define GLYPH_FILL_RULE msdfgen::FILL_NONZERO
 #define LCG_MULTIPLIER 6364136223846793005ull
@@ -62,11 +67,14 @@ INPUT SPECIFICATION
 #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
 R"(
   -varfont <filename.ttf/otf?var0=value0&var1=value1>
-      Specifies an input variable font file and configures its variables.)"
+      Specifies an input variable font file and configures its variables.
+      Multiple comma-separated values (var0=value0,value1,...) add an instance for each combination into the same atlas.)"
 #endif
 R"(
   -charset <filename>
       Specifies the input character set. Refer to the documentation for format of charset specification. Defaults to ASCII.
+  -charsetfromtext <filename>
+      Specifies the input character set as all characters that occur in a UTF-8 encoded text file.
   -glyphset <filename>
       Specifies the set of input glyphs as glyph indices within the font file.
   -chars <charset specification>
@@ -87,14 +95,45 @@ ATLAS CONFIGURATION
       Selects the type of atlas to be generated.
 )"
 #ifndef MSDFGEN_DISABLE_PNG
-R"(  -format <png / bmp / tiff / rgba / fl32 / text / textfloat / bin / binfloat / binfloatbe>)"
+R"(  -format <png / png16 / bmp / tiff / rgba / fl32 / text / textfloat / bin / bin16 / binhalf / binfloat / binfloatbe / ktx2 / dds>)"
 #else
-R"(  -format <bmp / tiff / rgba / fl32 / text / textfloat / bin / binfloat / binfloatbe>)"
+R"(  -format <bmp / tiff / rgba / fl32 / text / textfloat / bin / bin16 / binhalf / binfloat / binfloatbe / ktx2 / dds>)"
 #endif
 R"(
       Selects the format for the atlas image output. Some image formats may be incompatible with embedded output formats.
+      Formats ktx2 and dds hold GPU block-compressed textures (BC4 for single-channel atlases, BC5 for two packed channels, BC7 otherwise).
+      Formats png16 and bin16 store 16-bit unsigned normalized samples, binhalf stores 16-bit half-precision samples.)"
+#ifndef MSDFGEN_DISABLE_PNG
+R"(
+  -pngcompression <0 - 9>
+      Sets the zlib compression level of PNG images. Defaults to 9 (maximum).
+  -pngfilter <none / sub / up / average / paeth / adaptive>
+      Selects the row filter of PNG images. Adaptive (default) picks the best filter for each row.
+  -tiffcompression <0 - 9>
+      Compresses TIFF images with deflate and the floating-point predictor. Defaults to 0 (uncompressed).)"
+#endif
+R"(
+  -blockcompression <bc / eac>
+      Selects the family of GPU block-compressed formats. EAC (R11 / RG11, ktx2 only) is for single-channel or two packed channels.
+  -tiffhalf
+      Stores TIFF images with 16-bit half-precision instead of 32-bit floating-point samples (also held in memory that way).
   -dimensions <width> <height>
       Sets the atlas to have fixed dimensions (width x height).
+  -multipage
+      Glyphs that do not fit into the fixed dimensions overflow into additional pages. Page number is appended to -imageout filename.
+  -channelpacking
+      Distributes glyphs of a single-channel atlas type into the four channels of an RGBA atlas, each with its own layout.
+  -channelpacking2
+      Distributes glyphs into the red and green channels only, which can be stored in two-channel GPU formats (BC5, EAC RG11).
+  -mipmaps <levels>
+      Generates a chain of up to 12 mipmap levels (including the full resolution) from the glyph geometry at halved scales.
+      The chain ends when the shorter atlas side reaches 1 pixel. Glyphs are spaced 2^(levels-1)-1 pixels apart,
+      and atlas dimensions are rounded up to (or, if fixed, must be) a multiple of 2^(levels-1).
+      Stored in a single file with ktx2 or dds, otherwise _mip<level> is appended to -imageout filename for each reduced level.
+  -frequencies <filename>
+      Loads character usage frequencies (lines of <character> <frequency>). Frequently used glyphs are placed first, in a compact region.
+  -frequenciesfromtext <filename>
+      Computes character usage frequencies from a UTF-8 encoded text corpus.
   -pots / -potr / -square / -square2 / -square4
       Picks the minimum atlas dimensions that fit all glyphs and satisfy the selected constraint:
       power of two square / ... rectangle / any square / square with side divisible by 2 / ... 4
@@ -108,6 +147,8 @@ R"(
         Constrains cell dimensions to the given rule (see -pots / ... above).
     -uniformorigin <off / on / horizontal / vertical>
         Sets whether the glyph's origin point should be fixed at the same position in each cell.
+  -shelves
+      Lays out the atlas into rows of uniform height with variable width glyph boxes sharing a common baseline.
   -yorigin <bottom / top>
       Determines whether the Y-axis is oriented upwards (bottom origin, default) or downwards (top origin).
 
@@ -117,11 +158,17 @@ OUTPUT SPECIFICATION - one or more can be specified
   -json <filename.json>
       Writes the atlas's layout data, as well as other metrics into a structured JSON file.
   -csv <filename.csv>
-      Writes the layout data of the glyphs into a simple CSV file.)"
+      Writes the layout data of the glyphs into a simple CSV file.
+  -binlayout <filename.bin>
+      Writes the layout data and metrics into a little-endian binary file, which can be memory-mapped at runtime.
+  -stats <filename.json>
+      Writes the wall-clock and CPU time of each stage, peak memory usage, output file sizes, and atlas occupancy into a JSON file.
+  -glyphprofile <N>
+      Adds the generation time of each glyph to the -stats report as a histogram along with the N slowest glyphs.)"
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
 R"(
   -arfont <filename.arfont>
-      Stores the atlas and its layout data as an Artery Font file. Supported formats: png, bin, binfloat.)"
+      Stores the atlas and its layout data as an Artery Font file. Supported formats: png, tiff, bin, binfloat.)"
 #endif
 R"(
   -shadronpreview <filename.shadron> <sample text>
@@ -257,28 +304,81 @@ static bool strStartsWith(const char *str, const char *prefix) {
     return true;
 }
 
+/// Returns the path of the font file, without the axis specification in case of a variable font
+static std::string fontFilePath(const char *filename, bool isVarFont) {
+    std::string path;
+    while (*filename && !(isVarFont && *filename == '?'))
+        path.push_back(*filename++);
+    return path;
+}
+
+/// Returns the list of axis names of a variable font specification "?name=value&name=value..." without their values
+static std::string varFontAxisNames(const char *axes) {
+    std::string names;
+    bool value = false;
+    for (; *axes; ++axes) {
+        if (*axes == '=')
+            value = true;
+        else if (*axes == '&' || *axes == '?')
+            value = false;
+        if (!value)
+            names.push_back(*axes);
+    }
+    return names;
+}
+
+/// Expands a variable font specification with comma-separated lists of axis values into a specification of each combination
+static void expandVarFontInstances(std::vector<std::string> &instances, const char *filename) {
+    std::string path = fontFilePath(filename, true);
+    std::vector<std::pair<std::string, std::vector<std::string> > > axes;
+    const char *cur = filename+path.size();
+    while (*cur == '?' || *cur == '&') {
+        std::pair<std::string, std::vector<std::string> > axis;
+        while (*++cur && *cur != '=' && *cur != '&')
+            axis.first.push_back(*cur);
+        while (*cur == '=' || *cur == ',') {
+            std::string value;
+            while (*++cur && *cur != ',' && *cur != '&')
+                value.push_back(*cur);
+            axis.second.push_back(value);
+        }
+        if (!axis.second.empty())
+            axes.push_back(axis);
+    }
+    std::vector<size_t> counter(axes.size());
+    do {
+        std::string instance = path;
+        for (size_t i = 0; i < axes.size(); ++i)
+            instance += (i ? "&" : "?")+axes[i].first+"="+axes[i].second[counter[i]];
+        instances.push_back(instance);
+        // Advance to next combination, last axis changes fastest
+        size_t i = axes.size();
+        while (i > 0 && ++counter[i-1] == axes[i-1].second.size())
+            counter[--i] = 0;
+        if (!i)
+            break;
+    } while (true);
+}
+
 #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
-static msdfgen::FontHandle *loadVarFont(msdfgen::FreetypeHandle *library, const char *filename) {
+/// Sets the variation axis coordinates specified as "?name=value&name=value..."
+static void setVarFontAxes(msdfgen::FreetypeHandle *library, msdfgen::FontHandle *font, const char *axes) {
     std::string buffer;
-    while (*filename && *filename != '?')
-        buffer.push_back(*filename++);
-    msdfgen::FontHandle *font = msdfgen::loadFont(library, buffer.c_str());
-    if (font && *filename++ == '?') {
+    if (*axes++ == '?') {
         do {
             buffer.clear();
-            while (*filename && *filename != '=')
-                buffer.push_back(*filename++);
-            if (*filename == '=') {
+            while (*axes && *axes != '=')
+                buffer.push_back(*axes++);
+            if (*axes == '=') {
                 double value = 0;
                 int skip = 0;
-                if (sscanf(++filename, "%lf%n", &value, &skip) == 1) {
+                if (sscanf(++axes, "%lf%n", &value, &skip) == 1) {
                     msdfgen::setFontVariationAxis(library, font, buffer.c_str(), value);
-                    filename += skip;
+                    axes += skip;
                 }
             }
-        } while (*filename++ == '&');
+        } while (*axes++ == '&');
     }
-    return font;
 }
 #endif
 
@@ -289,12 +389,21 @@ enum class Units {
     PIXELS
 };
 
+/// Type of the atlas bitmap's pixel values in memory
+enum class PixelType {
+    BYTE,
+    UNORM16,
+    HALF,
+    FLOAT
+};
+
 struct FontInput {
     const char *fontFilename;
     bool variableFont;
     GlyphIdentifierType glyphIdentifierType;
     const char *charsetFilename;
     const char *charsetString;
+    bool charsetFromText;
     double fontScale;
     const char *fontName;
 };
@@ -303,7 +412,12 @@ struct Configuration {
     ImageType imageType;
     ImageFormat imageFormat;
     YDirection yDirection;
+    /// Row order of the generated atlas bitmap in memory
+    YDirection atlasYDirection;
     int width, height;
+    int pageCount;
+    int packedChannelCount;
+    int mipLevels;
     double emSize;
     msdfgen::Range pxRange;
     double angleThreshold;
@@ -314,6 +428,11 @@ struct Configuration {
         int cols, rows;
         bool fixedOriginX, fixedOriginY;
     } grid;
+    struct {
+        int shelfHeight;
+        int shelves;
+        double originY;
+    } shelf;
     void (*edgeColoring)(msdfgen::Shape &, double, unsigned long long);
     bool expensiveColoring;
     unsigned long long coloringSeed;
@@ -321,27 +440,95 @@ struct Configuration {
     bool preprocessGeometry;
     bool kerning;
     int threadCount;
+    PngEncoderSettings png;
+    TiffEncoderSettings tiff;
+    BlockEncoderSettings block;
     const char *arteryFontFilename;
     const char *imageFilename;
     const char *jsonFilename;
     const char *csvFilename;
+    const char *binaryLayoutFilename;
     const char *shadronPreviewFilename;
     const char *shadronPreviewText;
+    const char *statisticsFilename;
+    /// Number of slowest glyphs listed in the statistics report, zero disables per-glyph profiling
+    int glyphProfileCount;
+    /// Collects timing and output size figures if -stats is specified, otherwise null
+    Statistics *statistics;
 };
 
-template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
-static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
-    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.height);
-    generator.setAttributes(config.generatorAttributes);
-    generator.setThreadCount(config.threadCount);
-    generator.generate(glyphs.data(), glyphs.size());
-    msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>) generator.atlasStorage();
+static std::string filenameWithSuffix(const std::string &filename, const std::string &suffix) {
+    std::string name(filename);
+    size_t extensionPos = name.find_last_of("./\\");
+    if (extensionPos == std::string::npos || name[extensionPos] != '.')
+        extensionPos = name.size();
+    name.insert(extensionPos, suffix);
+    return name;
+}
+
+static std::string pageFilename(const char *filename, int page) {
+    return filenameWithSuffix(filename, "_"+std::to_string(page));
+}
 
+/// Reduces the number of mipmap levels so that the shorter side of the atlas is at least 1 pixel in the last one
+static int clampMipLevels(int mipLevels, int width, int height) {
+    while (mipLevels > 1 && !(std::min(width, height)>>(mipLevels-1)))
+        --mipLevels;
+    return mipLevels;
+}
+
+/// Spacing between glyph boxes, which must keep them apart when expanded to whole pixels in the reduced mipmap levels
+static int mipmapSpacing(int spacing, int mipLevels) {
+    return mipLevels > 1 ? std::max(spacing, (1<<(mipLevels-1))-1) : spacing;
+}
+
+static std::string mipFilename(const std::string &filename, int level) {
+    return filenameWithSuffix(filename, "_mip"+std::to_string(level));
+}
+
+template <typename T, int N>
+static bool saveAtlas(const std::vector<msdfgen::BitmapConstRef<T, N> > &pages, const std::vector<FontGeometry> &fonts, const Configuration &config) {
     bool success = true;
 
     if (config.imageFilename) {
-        if (saveImage(bitmap, config.imageFormat, config.imageFilename, config.yDirection))
-            fputs("Atlas image file saved.\n", stderr);
+        if (config.statistics)
+            config.statistics->beginStage("image");
+        std::vector<char> pageSaved(config.pageCount);
+        // Pages are saved in parallel, remaining threads are left to the image encoder of each page
+        PngEncoderSettings pngSettings = config.png;
+        TiffEncoderSettings tiffSettings = config.tiff;
+        BlockEncoderSettings blockSettings = config.block;
+        pngSettings.threadCount = tiffSettings.threadCount = blockSettings.threadCount = std::max(config.threadCount/config.pageCount, 1);
+        if (config.packedChannelCount > 1)
+            blockSettings.channelCount = config.packedChannelCount;
+        Workload([&pages, &pageSaved, &config, &pngSettings, &tiffSettings, &blockSettings](int i, int threadNo) -> bool {
+            std::string filename = config.pageCount > 1 ? pageFilename(config.imageFilename, i) : std::string(config.imageFilename);
+            if (config.mipLevels > 1 && (config.imageFormat == ImageFormat::KTX2 || config.imageFormat == ImageFormat::DDS)) {
+                std::vector<msdfgen::BitmapConstRef<T, N> > levels(config.mipLevels);
+                for (int level = 0; level < config.mipLevels; ++level)
+                    levels[level] = pages[config.pageCount*level+i];
+                pageSaved[i] = saveImageMipmaps(levels.data(), config.mipLevels, config.imageFormat, filename.c_str(), blockSettings);
+                if (config.statistics && pageSaved[i])
+                    config.statistics->addOutputFile(filename.c_str());
+            } else {
+                bool saved = saveImage(pages[i], config.imageFormat, filename.c_str(), config.yDirection, pngSettings, tiffSettings, blockSettings, config.atlasYDirection);
+                if (config.statistics && saved)
+                    config.statistics->addOutputFile(filename.c_str());
+                // Other formats hold a single image, so reduced mipmap levels are saved as separate files
+                for (int level = 1; level < config.mipLevels; ++level) {
+                    std::string levelFilename = mipFilename(filename, level);
+                    if (saveImage(pages[config.pageCount*level+i], config.imageFormat, levelFilename.c_str(), config.yDirection, pngSettings, tiffSettings, blockSettings, config.atlasYDirection)) {
+                        if (config.statistics)
+                            config.statistics->addOutputFile(levelFilename.c_str());
+                    } else
+                        saved = false;
+                }
+                pageSaved[i] = saved;
+            }
+            return true;
+        }, config.pageCount).finish(config.threadCount);
+        if (std::find(pageSaved.begin(), pageSaved.end(), false) == pageSaved.end())
+            fputs(config.pageCount > 1 ? "Atlas image files saved.\n" : "Atlas image file saved.\n", stderr);
         else {
             success = false;
             fputs("Failed to save the atlas as an image file.\n", stderr);
@@ -350,15 +537,24 @@ static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vecto
 
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
     if (config.arteryFontFilename) {
+        if (config.statistics)
+            config.statistics->beginStage("arfont");
         ArteryFontExportProperties arfontProps;
         arfontProps.fontSize = config.emSize;
         arfontProps.pxRange = config.pxRange;
         arfontProps.imageType = config.imageType;
         arfontProps.imageFormat = config.imageFormat;
         arfontProps.yDirection = config.yDirection;
-        if (exportArteryFont<float>(fonts.data(), fonts.size(), bitmap, config.arteryFontFilename, arfontProps))
+        arfontProps.atlasYDirection = config.atlasYDirection;
+        arfontProps.pngSettings = config.png;
+        arfontProps.pngSettings.threadCount = config.threadCount;
+        arfontProps.tiffSettings = config.tiff;
+        arfontProps.tiffSettings.threadCount = config.threadCount;
+        if (exportArteryFont<float>(fonts.data(), fonts.size(), pages.data(), config.pageCount, config.arteryFontFilename, arfontProps)) {
+            if (config.statistics)
+                config.statistics->addOutputFile(config.arteryFontFilename);
             fputs("Artery Font file generated.\n", stderr);
-        else {
+        } else {
             success = false;
             fputs("Failed to generate Artery Font file.\n", stderr);
         }
@@ -368,10 +564,95 @@ static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vecto
     return success;
 }
 
+template <typename T>
+static bool saveChannelPackedAtlas(const msdfgen::BitmapConstRef<T, 1> &layers, const std::vector<FontGeometry> &fonts, const Configuration &config) {
+    // Interleave each page's layers into the channels of a single image
+    size_t layerSize = (size_t) config.width*config.height;
+    std::vector<T> pixels(4*layerSize*config.pageCount);
+    std::vector<msdfgen::BitmapConstRef<T, 4> > pages(config.pageCount);
+    Workload([&layers, &pixels, &pages, &config, layerSize](int i, int threadNo) -> bool {
+        T *page = pixels.data()+4*layerSize*i;
+        int layerCount = config.packedChannelCount*config.pageCount;
+        for (int channel = 0; channel < config.packedChannelCount; ++channel) {
+            int layerIndex = config.packedChannelCount*i+channel;
+            // In a top-down bitmap, the layers are stacked in reverse order
+            if (config.atlasYDirection == YDirection::TOP_DOWN)
+                layerIndex = layerCount-layerIndex-1;
+            const T *layer = layers.pixels+layerSize*layerIndex;
+            for (size_t j = 0; j < layerSize; ++j)
+                page[4*j+channel] = layer[j];
+        }
+        pages[i] = msdfgen::BitmapConstRef<T, 4>(page, config.width, config.height);
+        return true;
+    }, config.pageCount).finish(config.threadCount);
+    return saveAtlas(pages, fonts, config);
+}
+
+template <typename T, int N>
+static bool saveChannelPackedAtlas(const msdfgen::BitmapConstRef<T, N> &, const std::vector<FontGeometry> &, const Configuration &) {
+    // Only single-channel atlases can be channel-packed
+    return false;
+}
+
+template <typename T, typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlas(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config) {
+    // All pages (and their packed channels) are generated at once, stacked on top of each other in a single bitmap
+    ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > generator(config.width, config.pageCount*config.packedChannelCount*config.height, config.atlasYDirection);
+    generator.setAttributes(config.generatorAttributes);
+    generator.setThreadCount(config.threadCount);
+    generator.setPageHeight(config.height);
+    generator.setPackedChannelCount(config.packedChannelCount);
+    generator.setProfiling(config.statistics && config.glyphProfileCount > 0);
+    generator.generate(glyphs.data(), glyphs.size());
+    if (config.statistics && config.glyphProfileCount > 0)
+        config.statistics->setGlyphProfile(generator.getGlyphProfile().data(), generator.getGlyphProfile().size(), config.glyphProfileCount);
+    msdfgen::BitmapConstRef<T, N> bitmap = (msdfgen::BitmapConstRef<T, N>) generator.atlasStorage();
+    if (config.packedChannelCount > 1)
+        return saveChannelPackedAtlas(bitmap, fonts, config);
+    // Pages of all mipmap levels, the page of a level is at index level*pageCount+page
+    std::vector<msdfgen::BitmapConstRef<T, N> > pages(config.mipLevels*config.pageCount);
+    // In a top-down bitmap, the pages are stacked in reverse order
+    for (int i = 0; i < config.pageCount; ++i)
+        pages[i] = msdfgen::BitmapConstRef<T, N>(bitmap.pixels+(size_t) N*config.width*config.height*(config.atlasYDirection == YDirection::TOP_DOWN ? config.pageCount-i-1 : i), config.width, config.height);
+    // Reduced mipmap levels are generated from the glyph geometry in the same layout rather than downsampled
+    std::vector<msdfgen::Bitmap<T, N> > mipmaps(config.mipLevels-1);
+    for (int level = 1; level < config.mipLevels; ++level) {
+        int width = std::max(config.width>>level, 1), height = std::max(config.height>>level, 1);
+        ImmediateAtlasGenerator<S, N, GEN_FN, BitmapAtlasStorage<T, N> > mipGenerator(width, config.pageCount*height, config.atlasYDirection);
+        GeneratorAttributes attributes = config.generatorAttributes;
+        attributes.mipLevel = level;
+        mipGenerator.setAttributes(attributes);
+        mipGenerator.setThreadCount(config.threadCount);
+        mipGenerator.setPageHeight(height);
+        mipGenerator.generate(glyphs.data(), glyphs.size());
+        mipmaps[level-1] = msdfgen::Bitmap<T, N>((msdfgen::BitmapConstRef<T, N>) mipGenerator.atlasStorage());
+        msdfgen::BitmapConstRef<T, N> mipBitmap = mipmaps[level-1];
+        for (int i = 0; i < config.pageCount; ++i)
+            pages[level*config.pageCount+i] = msdfgen::BitmapConstRef<T, N>(mipBitmap.pixels+(size_t) N*width*height*(config.atlasYDirection == YDirection::TOP_DOWN ? config.pageCount-i-1 : i), width, height);
+    }
+    return saveAtlas(pages, fonts, config);
+}
+
+template <typename S, int N, GeneratorFunction<S, N> GEN_FN>
+static bool makeAtlasOfPixelType(const std::vector<GlyphGeometry> &glyphs, const std::vector<FontGeometry> &fonts, const Configuration &config, PixelType pixelType) {
+    switch (pixelType) {
+        case PixelType::BYTE:
+            return makeAtlas<byte, S, N, GEN_FN>(glyphs, fonts, config);
+        case PixelType::UNORM16:
+            return makeAtlas<unorm16, S, N, GEN_FN>(glyphs, fonts, config);
+        case PixelType::HALF:
+            return makeAtlas<half, S, N, GEN_FN>(glyphs, fonts, config);
+        case PixelType::FLOAT:
+            return makeAtlas<float, S, N, GEN_FN>(glyphs, fonts, config);
+    }
+    return false;
+}
+
 int main(int argc, const char *const *argv) {
     #define ABORT(msg) do { fputs(msg "\n", stderr); return 1; } while (false)
 
     int result = 0;
+    Statistics statistics;
     std::vector<FontInput> fontInputs;
     FontInput fontInput = { };
     Configuration config = { };
@@ -403,12 +684,17 @@ int main(int argc, const char *const *argv) {
     Units innerPaddingUnits = Units::EMS;
     Units outerPaddingUnits = Units::EMS;
     PackingStyle packingStyle = PackingStyle::TIGHT;
+    bool multiPage = false;
+    const char *frequenciesFilename = nullptr;
+    bool frequenciesFromText = false;
     DimensionsConstraint atlasSizeConstraint = DimensionsConstraint::NONE;
     DimensionsConstraint cellSizeConstraint = DimensionsConstraint::NONE;
     config.angleThreshold = DEFAULT_ANGLE_THRESHOLD;
     config.miterLimit = DEFAULT_MITER_LIMIT;
     config.pxAlignOriginX = false, config.pxAlignOriginY = true;
     config.threadCount = 0;
+    config.packedChannelCount = 1;
+    config.mipLevels = 1;
 
     // Parse command line
     int argPos = 1;
@@ -447,6 +733,8 @@ int main(int argc, const char *const *argv) {
             #ifndef MSDFGEN_DISABLE_PNG
                 if (ARG_IS("png"))
                     config.imageFormat = ImageFormat::PNG;
+                else if (ARG_IS("png16"))
+                    config.imageFormat = ImageFormat::PNG16;
                 else
             #endif
             if (ARG_IS("bmp"))
@@ -463,15 +751,23 @@ int main(int argc, const char *const *argv) {
                 config.imageFormat = ImageFormat::TEXT_FLOAT;
             else if (ARG_IS("bin") || ARG_IS("binary"))
                 config.imageFormat = ImageFormat::BINARY;
+            else if (ARG_IS("bin16"))
+                config.imageFormat = ImageFormat::BINARY_UNORM16;
+            else if (ARG_IS("binhalf"))
+                config.imageFormat = ImageFormat::BINARY_HALF;
             else if (ARG_IS("binfloat") || ARG_IS("binfloatle"))
                 config.imageFormat = ImageFormat::BINARY_FLOAT;
             else if (ARG_IS("binfloatbe"))
                 config.imageFormat = ImageFormat::BINARY_FLOAT_BE;
+            else if (ARG_IS("ktx2"))
+                config.imageFormat = ImageFormat::KTX2;
+            else if (ARG_IS("dds"))
+                config.imageFormat = ImageFormat::DDS;
             else {
                 #ifndef MSDFGEN_DISABLE_PNG
-                    ABORT("Invalid image format. Valid formats are: png, bmp, tiff, rgba, fl32, text, textfloat, bin, binfloat, binfloatbe");
+                    ABORT("Invalid image format. Valid formats are: png, png16, bmp, tiff, rgba, fl32, text, textfloat, bin, bin16, binhalf, binfloat, binfloatbe, ktx2, dds");
                 #else
-                    ABORT("Invalid image format. Valid formats are: bmp, tiff, rgba, fl32, text, textfloat, bin, binfloat, binfloatbe");
+                    ABORT("Invalid image format. Valid formats are: bmp, tiff, rgba, fl32, text, textfloat, bin, bin16, binhalf, binfloat, binfloatbe, ktx2, dds");
                 #endif
             }
             imageFormatName = arg;
@@ -493,30 +789,42 @@ int main(int argc, const char *const *argv) {
         ARG_CASE("-charset", 1) {
             fontInput.charsetFilename = argv[argPos++];
             fontInput.charsetString = nullptr;
+            fontInput.charsetFromText = false;
+            fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
+            continue;
+        }
+        ARG_CASE("-charsetfromtext", 1) {
+            fontInput.charsetFilename = argv[argPos++];
+            fontInput.charsetString = nullptr;
+            fontInput.charsetFromText = true;
             fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
             continue;
         }
         ARG_CASE("-glyphset", 1) {
             fontInput.charsetFilename = argv[argPos++];
             fontInput.charsetString = nullptr;
+            fontInput.charsetFromText = false;
             fontInput.glyphIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
             continue;
         }
         ARG_CASE("-chars", 1) {
             fontInput.charsetFilename = nullptr;
             fontInput.charsetString = argv[argPos++];
+            fontInput.charsetFromText = false;
             fontInput.glyphIdentifierType = GlyphIdentifierType::UNICODE_CODEPOINT;
             continue;
         }
         ARG_CASE("-glyphs", 1) {
             fontInput.charsetFilename = nullptr;
             fontInput.charsetString = argv[argPos++];
+            fontInput.charsetFromText = false;
             fontInput.glyphIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
             continue;
         }
         ARG_CASE("-allglyphs", 0) {
             fontInput.charsetFilename = nullptr;
             fontInput.charsetString = nullptr;
+            fontInput.charsetFromText = false;
             fontInput.glyphIdentifierType = GlyphIdentifierType::GLYPH_INDEX;
             continue;
         }
@@ -558,11 +866,74 @@ int main(int argc, const char *const *argv) {
             config.csvFilename = argv[argPos++];
             continue;
         }
+        ARG_CASE("-binlayout", 1) {
+            config.binaryLayoutFilename = argv[argPos++];
+            continue;
+        }
+        ARG_CASE("-stats", 1) {
+            config.statisticsFilename = argv[argPos++];
+            continue;
+        }
+        ARG_CASE("-glyphprofile", 1) {
+            unsigned count;
+            if (!parseUnsigned(count, argv[argPos++]))
+                ABORT("Invalid glyph profile length. Use -glyphprofile <N> with N being a non-negative integer.");
+            config.glyphProfileCount = (int) count;
+            continue;
+        }
         ARG_CASE("-shadronpreview", 2) {
             config.shadronPreviewFilename = argv[argPos++];
             config.shadronPreviewText = argv[argPos++];
             continue;
         }
+    #ifndef MSDFGEN_DISABLE_PNG
+        ARG_CASE("-pngcompression", 1) {
+            unsigned level;
+            if (!(parseUnsigned(level, argv[argPos++]) && level <= 9))
+                ABORT("Invalid PNG compression level. Use -pngcompression <level> with level between 0 (no compression) and 9 (maximum compression).");
+            config.png.compressionLevel = (int) level;
+            continue;
+        }
+        ARG_CASE("-pngfilter", 1) {
+            if (ARG_IS("none"))
+                config.png.filter = PngFilter::NONE;
+            else if (ARG_IS("sub"))
+                config.png.filter = PngFilter::SUB;
+            else if (ARG_IS("up"))
+                config.png.filter = PngFilter::UP;
+            else if (ARG_IS("average"))
+                config.png.filter = PngFilter::AVERAGE;
+            else if (ARG_IS("paeth"))
+                config.png.filter = PngFilter::PAETH;
+            else if (ARG_IS("adaptive"))
+                config.png.filter = PngFilter::ADAPTIVE;
+            else
+                ABORT("Invalid PNG filter. Valid filters are: none, sub, up, average, paeth, adaptive");
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-tiffcompression", 1) {
+            unsigned level;
+            if (!(parseUnsigned(level, argv[argPos++]) && level <= 9))
+                ABORT("Invalid TIFF compression level. Use -tiffcompression <level> with level between 0 (no compression) and 9 (maximum compression).");
+            config.tiff.compressionLevel = (int) level;
+            continue;
+        }
+    #endif
+        ARG_CASE("-blockcompression", 1) {
+            if (ARG_IS("bc"))
+                config.block.eac = false;
+            else if (ARG_IS("eac"))
+                config.block.eac = true;
+            else
+                ABORT("Invalid block compression. Valid options are: bc, eac");
+            ++argPos;
+            continue;
+        }
+        ARG_CASE("-tiffhalf", 0) {
+            config.tiff.halfFloat = true;
+            continue;
+        }
         ARG_CASE("-dimensions", 2) {
             unsigned w, h;
             if (!(parseUnsigned(w, argv[argPos++]) && parseUnsigned(h, argv[argPos++]) && w && h))
@@ -570,6 +941,35 @@ int main(int argc, const char *const *argv) {
             fixedWidth = w, fixedHeight = h;
             continue;
         }
+        ARG_CASE("-multipage", 0) {
+            multiPage = true;
+            continue;
+        }
+        ARG_CASE("-channelpacking", 0) {
+            config.packedChannelCount = 4;
+            continue;
+        }
+        ARG_CASE("-channelpacking2", 0) {
+            config.packedChannelCount = 2;
+            continue;
+        }
+        ARG_CASE("-mipmaps", 1) {
+            unsigned levels;
+            if (!(parseUnsigned(levels, argv[argPos++]) && levels >= 1 && levels <= MAX_MIP_LEVELS))
+                ABORT("Invalid number of mipmap levels. Use -mipmaps <levels> with a number between 1 and 12.");
+            config.mipLevels = (int) levels;
+            continue;
+        }
+        ARG_CASE("-frequencies", 1) {
+            frequenciesFilename = argv[argPos++];
+            frequenciesFromText = false;
+            continue;
+        }
+        ARG_CASE("-frequenciesfromtext", 1) {
+            frequenciesFilename = argv[argPos++];
+            frequenciesFromText = true;
+            continue;
+        }
         ARG_CASE("-pots", 0) {
             atlasSizeConstraint = DimensionsConstraint::POWER_OF_TWO_SQUARE;
             fixedWidth = -1, fixedHeight = -1;
@@ -744,6 +1144,10 @@ int main(int argc, const char *const *argv) {
             packingStyle = PackingStyle::GRID;
             continue;
         }
+        ARG_CASE("-shelves", 0) {
+            packingStyle = PackingStyle::SHELF;
+            continue;
+        }
         ARG_CASE("-uniformcols", 1) {
             packingStyle = PackingStyle::GRID;
             unsigned c;
@@ -935,7 +1339,7 @@ int main(int argc, const char *const *argv) {
     }
     if (!fontInput.fontFilename)
         ABORT("No font specified.");
-    if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename)) {
+    if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.binaryLayoutFilename || config.shadronPreviewFilename)) {
         fputs("No output specified.\n", stderr);
         return 0;
     }
@@ -949,6 +1353,7 @@ int main(int argc, const char *const *argv) {
         if (!(it->charsetFilename || it->charsetString || it->glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX) && (nextFontInput->charsetFilename || nextFontInput->charsetString || nextFontInput->glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX)) {
             it->charsetFilename = nextFontInput->charsetFilename;
             it->charsetString = nextFontInput->charsetString;
+            it->charsetFromText = nextFontInput->charsetFromText;
             it->glyphIdentifierType = nextFontInput->glyphIdentifierType;
         }
         if (it->fontScale < 0 && nextFontInput->fontScale >= 0)
@@ -957,9 +1362,27 @@ int main(int argc, const char *const *argv) {
     }
     if (fontInputs.empty() || memcmp(&fontInputs.back(), &fontInput, sizeof(FontInput)))
         fontInputs.push_back(fontInput);
+#ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
+    // Expand variable font inputs with lists of axis values into separate inputs for each instance
+    std::deque<std::string> varFontInstances;
+    for (size_t i = 0; i < fontInputs.size(); ++i) {
+        if (fontInputs[i].variableFont && strchr(fontInputs[i].fontFilename, ',')) {
+            std::vector<std::string> instances;
+            expandVarFontInstances(instances, fontInputs[i].fontFilename);
+            FontInput instanceInput = fontInputs[i];
+            fontInputs.erase(fontInputs.begin()+i);
+            for (const std::string &instance : instances) {
+                varFontInstances.push_back(instance);
+                instanceInput.fontFilename = varFontInstances.back().c_str();
+                fontInputs.insert(fontInputs.begin()+i++, instanceInput);
+            }
+            --i;
+        }
+    }
+#endif
 
     // Fix up configuration based on related values
-    if (packingStyle == PackingStyle::TIGHT && atlasSizeConstraint == DimensionsConstraint::NONE)
+    if ((packingStyle == PackingStyle::TIGHT || packingStyle == PackingStyle::SHELF) && atlasSizeConstraint == DimensionsConstraint::NONE)
         atlasSizeConstraint = DimensionsConstraint::MULTIPLE_OF_FOUR_SQUARE;
     if (!(config.imageType == ImageType::PSDF || config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF))
         config.miterLimit = 0;
@@ -969,6 +1392,26 @@ int main(int argc, const char *const *argv) {
         fputs("Neither atlas size nor glyph size selected, using default...\n", stderr);
         minEmSize = DEFAULT_SIZE;
     }
+    if (config.packedChannelCount > 1) {
+        if (!(config.imageType == ImageType::HARD_MASK || config.imageType == ImageType::SOFT_MASK || config.imageType == ImageType::SDF || config.imageType == ImageType::PSDF))
+            ABORT("Channel packing is only available for single-channel atlas types (hardmask, softmask, sdf, psdf).");
+        if (packingStyle != PackingStyle::TIGHT)
+            ABORT("Channel packing is only supported by the default tight packing style.");
+    }
+    if (frequenciesFilename && packingStyle == PackingStyle::SHELF)
+        ABORT("Glyph frequencies are not supported by the shelf packing style.");
+    if (config.mipLevels > 1 && config.packedChannelCount > 1)
+        ABORT("Mipmaps are not supported for channel-packed atlases.");
+    if (multiPage) {
+        if (packingStyle != PackingStyle::TIGHT)
+            ABORT("Multi-page atlas is only supported by the default tight packing style.");
+        if (!(fixedWidth > 0 && fixedHeight > 0))
+            ABORT("Multi-page atlas requires fixed atlas dimensions. Use -dimensions <width> <height>.");
+        if (!(minEmSize > 0)) {
+            fputs("Glyph size not selected for multi-page atlas, using default...\n", stderr);
+            minEmSize = DEFAULT_SIZE;
+        }
+    }
     if (config.imageType == ImageType::HARD_MASK || config.imageType == ImageType::SOFT_MASK) {
         rangeUnits = Units::PIXELS;
         rangeValue = 1;
@@ -976,7 +1419,7 @@ int main(int argc, const char *const *argv) {
         rangeUnits = Units::PIXELS;
         rangeValue = DEFAULT_PIXEL_RANGE;
     }
-    if (config.kerning && !(config.arteryFontFilename || config.jsonFilename || config.shadronPreviewFilename))
+    if (config.kerning && !(config.arteryFontFilename || config.jsonFilename || config.binaryLayoutFilename || config.shadronPreviewFilename))
         config.kerning = false;
     if (config.threadCount <= 0)
         config.threadCount = std::max((int) std::thread::hardware_concurrency(), 1);
@@ -1009,6 +1452,8 @@ int main(int argc, const char *const *argv) {
         else if (cmpExtension(config.imageFilename, ".fl32")) imageExtension = ImageFormat::FL32;
         else if (cmpExtension(config.imageFilename, ".txt")) imageExtension = ImageFormat::TEXT;
         else if (cmpExtension(config.imageFilename, ".bin")) imageExtension = ImageFormat::BINARY;
+        else if (cmpExtension(config.imageFilename, ".ktx2")) imageExtension = ImageFormat::KTX2;
+        else if (cmpExtension(config.imageFilename, ".dds")) imageExtension = ImageFormat::DDS;
     }
     if (config.imageFormat == ImageFormat::UNSPECIFIED) {
         #ifndef MSDFGEN_DISABLE_PNG
@@ -1027,12 +1472,21 @@ int main(int argc, const char *const *argv) {
         }
     }
 #ifndef MSDF_ATLAS_NO_ARTERY_FONT
-    if (config.arteryFontFilename && !(config.imageFormat == ImageFormat::PNG || config.imageFormat == ImageFormat::BINARY || config.imageFormat == ImageFormat::BINARY_FLOAT)) {
+    if (config.arteryFontFilename && !(config.imageFormat == ImageFormat::PNG || config.imageFormat == ImageFormat::PNG16 || config.imageFormat == ImageFormat::TIFF || config.imageFormat == ImageFormat::BINARY || config.imageFormat == ImageFormat::BINARY_FLOAT)) {
         config.arteryFontFilename = nullptr;
         result = 1;
         fputs("Error: Unable to create an Artery Font file with the specified image format!\n", stderr);
         // Recheck whether there is anything else to do
-        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.shadronPreviewFilename))
+        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.binaryLayoutFilename || config.shadronPreviewFilename))
+            return result;
+        layoutOnly = !(config.arteryFontFilename || config.imageFilename);
+    }
+    if (config.arteryFontFilename && config.packedChannelCount > 1) {
+        // Artery Font glyphs can only reference whole images, not their channels
+        config.arteryFontFilename = nullptr;
+        result = 1;
+        fputs("Error: Unable to create an Artery Font file with a channel-packed atlas!\n", stderr);
+        if (!(config.arteryFontFilename || config.imageFilename || config.jsonFilename || config.csvFilename || config.binaryLayoutFilename || config.shadronPreviewFilename))
             return result;
         layoutOnly = !(config.arteryFontFilename || config.imageFilename);
     }
@@ -1044,7 +1498,10 @@ int main(int argc, const char *const *argv) {
             case ImageFormat::TEXT: case ImageFormat::TEXT_FLOAT:
                 mismatch = imageExtension != ImageFormat::TEXT;
                 break;
-            case ImageFormat::BINARY: case ImageFormat::BINARY_FLOAT: case ImageFormat::BINARY_FLOAT_BE:
+            case ImageFormat::PNG16:
+                mismatch = imageExtension != ImageFormat::PNG;
+                break;
+            case ImageFormat::BINARY: case ImageFormat::BINARY_UNORM16: case ImageFormat::BINARY_HALF: case ImageFormat::BINARY_FLOAT: case ImageFormat::BINARY_FLOAT_BE:
                 mismatch = imageExtension != ImageFormat::BINARY;
                 break;
             default:
@@ -1054,32 +1511,79 @@ int main(int argc, const char *const *argv) {
             fprintf(stderr, "Warning: Output image file extension does not match the image's actual format (%s)!\n", imageFormatName);
     }
     imageFormatName = nullptr; // No longer consistent with imageFormat
+    if (config.block.eac) {
+        if (config.imageFormat != ImageFormat::KTX2)
+            ABORT("EAC block compression is only available with the ktx2 image format.");
+        if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF || config.packedChannelCount > 2)
+            ABORT("EAC block compression is only available for single-channel atlases or two packed channels (-channelpacking2).");
+    }
     bool floatingPointFormat = (
         config.imageFormat == ImageFormat::TIFF ||
         config.imageFormat == ImageFormat::FL32 ||
         config.imageFormat == ImageFormat::TEXT_FLOAT ||
         config.imageFormat == ImageFormat::BINARY_FLOAT ||
+        config.imageFormat == ImageFormat::BINARY_HALF ||
         config.imageFormat == ImageFormat::BINARY_FLOAT_BE
     );
-    // TODO: In this case (if spacing is -1), the border pixels of each glyph are black, but still computed. For floating-point output, this may play a role.
-    int spacing = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF ? 0 : -1;
+    PixelType pixelType = floatingPointFormat ? PixelType::FLOAT : PixelType::BYTE;
+    if (config.imageFormat == ImageFormat::PNG16 || config.imageFormat == ImageFormat::BINARY_UNORM16)
+        pixelType = PixelType::UNORM16;
+    else if (config.imageFormat == ImageFormat::BINARY_HALF || (config.imageFormat == ImageFormat::TIFF && config.tiff.halfFloat))
+        pixelType = PixelType::HALF;
+    // In this case (if spacing is -1), the border pixels of each glyph are black and shared with neighboring glyphs.
+    int baseSpacing = config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF ? 0 : -1;
+    // Mipmap chain ends when the shorter side of the atlas reaches 1 pixel
+    if (fixedWidth > 0 && fixedHeight > 0)
+        config.mipLevels = clampMipLevels(config.mipLevels, fixedWidth, fixedHeight);
+    int spacing = mipmapSpacing(baseSpacing, config.mipLevels);
+    // Tightly packed boxes are guaranteed to have their border outside of the distance range, so its computation can be skipped.
+    // This only holds if the box covers the whole shape (no negative padding, miters included for perpendicular distance),
+    // and the distance range does not lie entirely outside the shape. For floating-point output, the border would contain distance values beyond the range, so it is kept as is.
+    config.generatorAttributes.skipBoxBorder = (
+        spacing < 0 && packingStyle != PackingStyle::GRID && !floatingPointFormat &&
+        innerPadding.l >= 0 && innerPadding.b >= 0 && innerPadding.r >= 0 && innerPadding.t >= 0 &&
+        outerPadding.l >= 0 && outerPadding.b >= 0 && outerPadding.r >= 0 && outerPadding.t >= 0 &&
+        (config.imageType != ImageType::PSDF || config.miterLimit > 0) &&
+        rangeValue.lower <= 0
+    );
     double uniformOriginX, uniformOriginY;
 
+    if (config.statisticsFilename)
+        config.statistics = &statistics;
+    else if (config.glyphProfileCount > 0)
+        fputs("Warning: Glyph profile is only reported with -stats.\n", stderr);
+
     // Load fonts
+    if (config.statistics)
+        config.statistics->beginStage("load");
+    // Without image output, glyph shapes are not needed, only their corners to compute miter bounds
+    GeometryLoadMode geometryLoadMode = GeometryLoadMode::SHAPE;
+    if (layoutOnly)
+        geometryLoadMode = config.miterLimit > 0 ? GeometryLoadMode::CORNERS : GeometryLoadMode::BOUNDS;
     std::vector<GlyphGeometry> glyphs;
     std::vector<FontGeometry> fonts;
     bool anyCodepointsAvailable = false;
     {
         class FontHolder {
             msdfgen::FreetypeHandle *ft;
-            msdfgen::FontHandle *font;
+            // Handles of the current font, one for each loading thread
+            std::vector<msdfgen::FontHandle *> faces;
             const char *fontFilename;
+            const char *varFontAxes;
+            std::string faceKey;
+            const MappedFile *fontFile;
+            // Font files are only mapped into memory once and shared by all inputs (e.g. variable font instances) that reference them
+            std::map<std::string, MappedFile> fontFiles;
+            void destroyFaces() {
+                for (msdfgen::FontHandle *face : faces)
+                    msdfgen::destroyFont(face);
+                faces.clear();
+            }
         public:
-            FontHolder() : ft(msdfgen::initializeFreetype()), font(nullptr), fontFilename(nullptr) { }
+            FontHolder() : ft(msdfgen::initializeFreetype()), fontFilename(nullptr), varFontAxes(nullptr), fontFile(nullptr) { }
             ~FontHolder() {
                 if (ft) {
-                    if (font)
-                        msdfgen::destroyFont(font);
+                    destroyFaces();
                     msdfgen::deinitializeFreetype(ft);
                 }
             }
@@ -1087,23 +1591,64 @@ int main(int argc, const char *const *argv) {
                 if (ft && fontFilename) {
                     if (this->fontFilename && !strcmp(this->fontFilename, fontFilename))
                         return true;
-                    if (font)
-                        msdfgen::destroyFont(font);
-                    if ((font = (
+                    std::string path = fontFilePath(fontFilename, isVarFont);
+                    const char *axes = isVarFont ? fontFilename+path.size() : nullptr;
+                    std::string key = axes ? path+varFontAxisNames(axes) : path;
+                    #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
+                        // Another instance of the same variable font with the same set of axes only needs to update their coordinates
+                        if (axes && !faces.empty() && key == faceKey) {
+                            for (msdfgen::FontHandle *face : faces)
+                                setVarFontAxes(ft, face, axes);
+                            this->fontFilename = fontFilename;
+                            varFontAxes = axes;
+                            return true;
+                        }
+                    #endif
+                    destroyFaces();
+                    MappedFile &file = fontFiles[path];
+                    if (!file.isOpen())
+                        file.open(path.c_str());
+                    fontFile = file.isOpen() && file.size() <= INT_MAX ? &file : nullptr;
+                    msdfgen::FontHandle *font = fontFile ? msdfgen::loadFontData(ft, fontFile->data(), (int) fontFile->size()) : msdfgen::loadFont(ft, path.c_str());
+                    if (font) {
                         #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
-                            isVarFont ? loadVarFont(ft, fontFilename) :
+                            if (axes)
+                                setVarFontAxes(ft, font, axes);
                         #endif
-                        msdfgen::loadFont(ft, fontFilename)
-                    ))) {
+                        faces.push_back(font);
                         this->fontFilename = fontFilename;
+                        varFontAxes = axes;
+                        faceKey = key;
                         return true;
                     }
                     this->fontFilename = nullptr;
+                    fontFile = nullptr;
                 }
                 return false;
             }
+            /// Opens additional handles of the current memory-mapped font up to count, returns the number of available handles
+            int openFaces(int count) {
+                while ((int) faces.size() < count && fontFile) {
+                    msdfgen::FontHandle *face = msdfgen::loadFontData(ft, fontFile->data(), (int) fontFile->size());
+                    if (!face)
+                        break;
+                    #ifndef MSDFGEN_DISABLE_VARIABLE_FONTS
+                        if (varFontAxes)
+                            setVarFontAxes(ft, face, varFontAxes);
+                    #endif
+                    faces.push_back(face);
+                }
+                return std::min((int) faces.size(), count);
+            }
+            msdfgen::FontHandle *const *getFaces() const {
+                return faces.data();
+            }
             operator msdfgen::FontHandle *() const {
-                return font;
+                return faces.empty() ? nullptr : faces.front();
+            }
+            /// Returns the memory-mapped font file or null if the font was loaded directly from the file system
+            const MappedFile *file() const {
+                return fontFile;
             }
         } font;
 
@@ -1116,7 +1661,10 @@ int main(int argc, const char *const *argv) {
             // Load character set
             Charset charset;
             unsigned allGlyphCount = 0;
-            if (fontInput.charsetFilename) {
+            if (fontInput.charsetFromText) {
+                if (!charset.loadText(fontInput.charsetFilename, config.threadCount))
+                    ABORT("Failed to load text file for character set extraction.");
+            } else if (fontInput.charsetFilename) {
                 if (!charset.load(fontInput.charsetFilename, fontInput.glyphIdentifierType != GlyphIdentifierType::UNICODE_CODEPOINT))
                     ABORT(fontInput.glyphIdentifierType == GlyphIdentifierType::GLYPH_INDEX ? "Failed to load glyph set specification." : "Failed to load character set specification.");
             } else if (fontInput.charsetString) {
@@ -1130,20 +1678,27 @@ int main(int argc, const char *const *argv) {
             // Load glyphs
             FontGeometry fontGeometry(&glyphs);
             int glyphsLoaded = -1;
+            int faceCount = font.openFaces(config.threadCount);
             switch (fontInput.glyphIdentifierType) {
                 case GlyphIdentifierType::GLYPH_INDEX:
                     if (allGlyphCount)
-                        glyphsLoaded = fontGeometry.loadGlyphRange(font, fontInput.fontScale, 0, allGlyphCount, config.preprocessGeometry, config.kerning);
+                        glyphsLoaded = fontGeometry.loadGlyphRange(font.getFaces(), faceCount, fontInput.fontScale, 0, allGlyphCount, config.preprocessGeometry, false, geometryLoadMode);
                     else
-                        glyphsLoaded = fontGeometry.loadGlyphset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
+                        glyphsLoaded = fontGeometry.loadGlyphset(font.getFaces(), faceCount, fontInput.fontScale, charset, config.preprocessGeometry, false, geometryLoadMode);
                     break;
                 case GlyphIdentifierType::UNICODE_CODEPOINT:
-                    glyphsLoaded = fontGeometry.loadCharset(font, fontInput.fontScale, charset, config.preprocessGeometry, config.kerning);
+                    glyphsLoaded = fontGeometry.loadCharset(font.getFaces(), faceCount, fontInput.fontScale, charset, config.preprocessGeometry, false, geometryLoadMode);
                     anyCodepointsAvailable |= glyphsLoaded > 0;
                     break;
             }
             if (glyphsLoaded < 0)
                 ABORT("Failed to load glyphs from font.");
+            // Kerning pairs are read directly from the font's tables if possible rather than probing each pair of glyphs
+            if (config.kerning) {
+                const MappedFile *fontFile = font.file();
+                if (!(fontFile && fontGeometry.loadKerning(fontFile->data(), fontFile->size()) >= 0))
+                    fontGeometry.loadKerning(font);
+            }
             printf("Loaded geometry of %d out of %d glyphs", glyphsLoaded, (int) (allGlyphCount+charset.size()));
             if (fontInputs.size() > 1)
                 printf(" from font \"%s\"", fontInput.fontFilename);
@@ -1183,7 +1738,30 @@ int main(int argc, const char *const *argv) {
     if (glyphs.empty())
         ABORT("No glyphs loaded.");
 
+    // Prioritize frequently used glyphs in the layout
+    std::vector<double> glyphPriorities;
+    if (frequenciesFilename) {
+        std::map<unicode_t, double> frequencies;
+        if (frequenciesFromText) {
+            if (!countCodepointFrequencies(frequencies, frequenciesFilename, config.threadCount))
+                ABORT("Failed to load text file for character frequency analysis.");
+        } else {
+            if (!loadCodepointFrequencies(frequencies, frequenciesFilename))
+                ABORT("Failed to load character frequency file.");
+        }
+        glyphPriorities.resize(glyphs.size());
+        for (size_t i = 0; i < glyphs.size(); ++i) {
+            if (unicode_t codepoint = glyphs[i].getCodepoint()) {
+                std::map<unicode_t, double>::const_iterator it = frequencies.find(codepoint);
+                if (it != frequencies.end())
+                    glyphPriorities[i] = it->second;
+            }
+        }
+    }
+
     // Determine final atlas dimensions, scale and range, pack glyphs
+    if (config.statistics)
+        config.statistics->beginStage("packing");
     {
         msdfgen::Range emRange = 0, pxRange = 0;
         switch (rangeUnits) {
@@ -1214,6 +1792,7 @@ int main(int argc, const char *const *argv) {
         }
         bool fixedDimensions = fixedWidth >= 0 && fixedHeight >= 0;
         bool fixedScale = config.emSize > 0;
+    PACK_GLYPHS:
         switch (packingStyle) {
 
             case PackingStyle::TIGHT: {
@@ -1235,6 +1814,9 @@ int main(int argc, const char *const *argv) {
                 atlasPacker.setOuterUnitPadding(outerEmPadding);
                 atlasPacker.setInnerPixelPadding(innerPxPadding);
                 atlasPacker.setOuterPixelPadding(outerPxPadding);
+                atlasPacker.setMultiPage(multiPage);
+                atlasPacker.setPackedChannelCount(config.packedChannelCount);
+                atlasPacker.setGlyphPriorities(glyphPriorities);
                 if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
                     if (remaining < 0) {
                         ABORT("Failed to pack glyphs into atlas.");
@@ -1243,15 +1825,20 @@ int main(int argc, const char *const *argv) {
                         return 1;
                     }
                 }
+                if (config.statistics)
+                    config.statistics->setPackAttempts(atlasPacker.getPackAttempts());
                 atlasPacker.getDimensions(config.width, config.height);
                 if (!(config.width > 0 && config.height > 0))
                     ABORT("Unable to determine atlas size.");
+                config.pageCount = atlasPacker.getPageCount();
                 config.emSize = atlasPacker.getScale();
                 config.pxRange = atlasPacker.getPixelRange();
                 if (!fixedScale)
                     printf("Glyph size: %.9g pixels/em\n", config.emSize);
                 if (!fixedDimensions)
                     printf("Atlas dimensions: %d x %d\n", config.width, config.height);
+                if (multiPage)
+                    printf("Atlas pages: %d\n", config.pageCount);
                 break;
             }
 
@@ -1281,6 +1868,8 @@ int main(int argc, const char *const *argv) {
                 atlasPacker.setOuterUnitPadding(outerEmPadding);
                 atlasPacker.setInnerPixelPadding(innerPxPadding);
                 atlasPacker.setOuterPixelPadding(outerPxPadding);
+                atlasPacker.setThreadCount(config.threadCount);
+                atlasPacker.setGlyphPriorities(glyphPriorities);
                 if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
                     if (remaining < 0) {
                         ABORT("Failed to pack glyphs into atlas.");
@@ -1299,6 +1888,7 @@ int main(int argc, const char *const *argv) {
                 atlasPacker.getCellDimensions(config.grid.cellWidth, config.grid.cellHeight);
                 config.grid.cols = atlasPacker.getColumns();
                 config.grid.rows = atlasPacker.getRows();
+                config.pageCount = 1;
                 if (!fixedScale)
                     printf("Glyph size: %.9g pixels/em\n", config.emSize);
                 if (config.grid.fixedOriginX || config.grid.fixedOriginY) {
@@ -1325,13 +1915,98 @@ int main(int argc, const char *const *argv) {
                 break;
             }
 
+            case PackingStyle::SHELF: {
+                ShelfAtlasPacker atlasPacker;
+                if (fixedDimensions)
+                    atlasPacker.setDimensions(fixedWidth, fixedHeight);
+                else
+                    atlasPacker.setDimensionsConstraint(atlasSizeConstraint);
+                atlasPacker.setSpacing(spacing);
+                if (fixedScale)
+                    atlasPacker.setScale(config.emSize);
+                else
+                    atlasPacker.setMinimumScale(minEmSize);
+                atlasPacker.setPixelRange(pxRange);
+                atlasPacker.setUnitRange(emRange);
+                atlasPacker.setMiterLimit(config.miterLimit);
+                atlasPacker.setOriginPixelAlignment(config.pxAlignOriginX, config.pxAlignOriginY);
+                atlasPacker.setInnerUnitPadding(innerEmPadding);
+                atlasPacker.setOuterUnitPadding(outerEmPadding);
+                atlasPacker.setInnerPixelPadding(innerPxPadding);
+                atlasPacker.setOuterPixelPadding(outerPxPadding);
+                if (int remaining = atlasPacker.pack(glyphs.data(), glyphs.size())) {
+                    if (remaining < 0) {
+                        ABORT("Failed to pack glyphs into atlas.");
+                    } else {
+                        fprintf(stderr, "Error: Could not fit %d out of %d glyphs into the atlas.\n", remaining, (int) glyphs.size());
+                        return 1;
+                    }
+                }
+                if (config.statistics)
+                    config.statistics->setPackAttempts(atlasPacker.getPackAttempts());
+                atlasPacker.getDimensions(config.width, config.height);
+                if (!(config.width > 0 && config.height > 0))
+                    ABORT("Unable to determine atlas size.");
+                config.emSize = atlasPacker.getScale();
+                config.pxRange = atlasPacker.getPixelRange();
+                config.shelf.shelfHeight = atlasPacker.getShelfHeight();
+                config.shelf.shelves = atlasPacker.getShelfCount();
+                config.shelf.originY = atlasPacker.getOriginY();
+                config.pageCount = 1;
+                if (!fixedScale)
+                    printf("Glyph size: %.9g pixels/em\n", config.emSize);
+                printf("Shelf height: %d\n", config.shelf.shelfHeight);
+                printf("Atlas dimensions: %d x %d (%d shelves)\n", config.width, config.height, config.shelf.shelves);
+                break;
+            }
+
+        }
+        if (config.mipLevels > 1) {
+            int mipLevels = clampMipLevels(config.mipLevels, config.width, config.height);
+            if (mipLevels < config.mipLevels) {
+                // The glyphs were spaced apart for levels that the atlas cannot hold, so they are packed again with the spacing of the remaining ones
+                config.mipLevels = mipLevels;
+                spacing = mipmapSpacing(baseSpacing, config.mipLevels);
+                printf("Mipmap levels reduced to %d, repacking glyphs\n", config.mipLevels);
+                goto PACK_GLYPHS;
+            }
+            // Each level must be exactly half the previous one, otherwise the glyph boxes would not line up with its pixels
+            int mipMask = (1<<(config.mipLevels-1))-1;
+            if ((config.width|config.height)&mipMask) {
+                if (fixedDimensions) {
+                    fprintf(stderr, "Error: Atlas dimensions must be divisible by %d for %d mipmap levels.\n", mipMask+1, config.mipLevels);
+                    return 1;
+                }
+                config.width = (config.width+mipMask)&~mipMask;
+                config.height = (config.height+mipMask)&~mipMask;
+                printf("Atlas dimensions extended to %d x %d for mipmaps\n", config.width, config.height);
+            }
         }
     }
+    if (config.statistics) {
+        Statistics::AtlasMetrics atlasMetrics = { };
+        atlasMetrics.width = config.width, atlasMetrics.height = config.height;
+        atlasMetrics.pages = config.pageCount;
+        atlasMetrics.packedChannels = config.packedChannelCount;
+        for (const GlyphGeometry &glyph : glyphs) {
+            int w = 0, h = 0;
+            glyph.getBoxSize(w, h);
+            atlasMetrics.glyphArea += (long long) w*h;
+        }
+        config.statistics->setAtlasMetrics(atlasMetrics);
+    }
 
     // Generate atlas bitmap
     if (!layoutOnly) {
 
+        // All pages and packed channels are stacked in a single bitmap, whose sample count must be representable as int
+        int channelCount = config.imageType == ImageType::MSDF ? 3 : config.imageType == ImageType::MTSDF ? 4 : 1;
+        if ((long long) channelCount*config.width*config.height*config.pageCount*config.packedChannelCount > INT_MAX)
+            ABORT("Atlas too large, reduce its dimensions or number of pages.");
+
         // Edge coloring
+        if (config.statistics)
+            config.statistics->beginStage("coloring");
         if (config.imageType == ImageType::MSDF || config.imageType == ImageType::MTSDF) {
             if (config.expensiveColoring) {
                 Workload([&glyphs, &config](int i, int threadNo) -> bool {
@@ -1348,38 +2023,30 @@ int main(int argc, const char *const *argv) {
             }
         }
 
+        // Raw formats with top-down output are generated top-down in the first place, so that they can be written without reordering rows
+        config.atlasYDirection = YDirection::BOTTOM_UP;
+        if (config.yDirection == YDirection::TOP_DOWN && isRowOrderAgnosticFormat(config.imageFormat))
+            config.atlasYDirection = YDirection::TOP_DOWN;
+
+        if (config.statistics)
+            config.statistics->beginStage("generation");
         bool success = false;
         switch (config.imageType) {
             case ImageType::HARD_MASK:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 1, scanlineGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 1, scanlineGenerator>(glyphs, fonts, config);
+                success = makeAtlasOfPixelType<float, 1, scanlineGenerator>(glyphs, fonts, config, pixelType);
                 break;
             case ImageType::SOFT_MASK:
             case ImageType::SDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 1, sdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 1, sdfGenerator>(glyphs, fonts, config);
+                success = makeAtlasOfPixelType<float, 1, sdfGenerator>(glyphs, fonts, config, pixelType);
                 break;
             case ImageType::PSDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 1, psdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 1, psdfGenerator>(glyphs, fonts, config);
+                success = makeAtlasOfPixelType<float, 1, psdfGenerator>(glyphs, fonts, config, pixelType);
                 break;
             case ImageType::MSDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 3, msdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 3, msdfGenerator>(glyphs, fonts, config);
+                success = makeAtlasOfPixelType<float, 3, msdfGenerator>(glyphs, fonts, config, pixelType);
                 break;
             case ImageType::MTSDF:
-                if (floatingPointFormat)
-                    success = makeAtlas<float, float, 4, mtsdfGenerator>(glyphs, fonts, config);
-                else
-                    success = makeAtlas<byte, float, 4, mtsdfGenerator>(glyphs, fonts, config);
+                success = makeAtlasOfPixelType<float, 4, mtsdfGenerator>(glyphs, fonts, config, pixelType);
                 break;
         }
         if (!success)
@@ -1387,20 +2054,28 @@ int main(int argc, const char *const *argv) {
     }
 
     if (config.csvFilename) {
-        if (exportCSV(fonts.data(), fonts.size(), config.width, config.height, config.yDirection, config.csvFilename))
+        if (config.statistics)
+            config.statistics->beginStage("csv");
+        if (exportCSV(fonts.data(), fonts.size(), config.height, config.yDirection, config.csvFilename, multiPage, config.packedChannelCount, config.threadCount)) {
+            if (config.statistics)
+                config.statistics->addOutputFile(config.csvFilename);
             fputs("Glyph layout written into CSV file.\n", stderr);
-        else {
+        } else {
             result = 1;
             fputs("Failed to write CSV output file.\n", stderr);
         }
     }
 
-    if (config.jsonFilename) {
+    if (config.jsonFilename || config.binaryLayoutFilename) {
         JsonAtlasMetrics jsonMetrics = { };
         JsonAtlasMetrics::GridMetrics gridMetrics = { };
+        JsonAtlasMetrics::ShelfMetrics shelfMetrics = { };
         jsonMetrics.distanceRange = config.pxRange;
         jsonMetrics.size = config.emSize;
         jsonMetrics.width = config.width, jsonMetrics.height = config.height;
+        jsonMetrics.pages = config.pageCount;
+        jsonMetrics.multiPage = multiPage;
+        jsonMetrics.packedChannels = config.packedChannelCount;
         jsonMetrics.yDirection = config.yDirection;
         if (packingStyle == PackingStyle::GRID) {
             gridMetrics.cellWidth = config.grid.cellWidth, gridMetrics.cellHeight = config.grid.cellHeight;
@@ -1412,22 +2087,54 @@ int main(int argc, const char *const *argv) {
             gridMetrics.spacing = spacing;
             jsonMetrics.grid = &gridMetrics;
         }
-        if (exportJSON(fonts.data(), fonts.size(), config.imageType, jsonMetrics, config.jsonFilename, config.kerning))
-            fputs("Glyph layout and metadata written into JSON file.\n", stderr);
-        else {
-            result = 1;
-            fputs("Failed to write JSON output file.\n", stderr);
+        if (packingStyle == PackingStyle::SHELF) {
+            shelfMetrics.shelfHeight = config.shelf.shelfHeight;
+            shelfMetrics.shelves = config.shelf.shelves;
+            shelfMetrics.originY = config.shelf.originY;
+            shelfMetrics.spacing = spacing;
+            jsonMetrics.shelves = &shelfMetrics;
+        }
+        if (config.jsonFilename) {
+            if (config.statistics)
+                config.statistics->beginStage("json");
+            if (exportJSON(fonts.data(), fonts.size(), config.imageType, jsonMetrics, config.jsonFilename, config.kerning, config.threadCount)) {
+                if (config.statistics)
+                    config.statistics->addOutputFile(config.jsonFilename);
+                fputs("Glyph layout and metadata written into JSON file.\n", stderr);
+            } else {
+                result = 1;
+                fputs("Failed to write JSON output file.\n", stderr);
+            }
+        }
+        if (config.binaryLayoutFilename) {
+            if (config.statistics)
+                config.statistics->beginStage("binaryLayout");
+            if (exportBinaryLayout(fonts.data(), fonts.size(), config.imageType, jsonMetrics, config.binaryLayoutFilename, config.kerning)) {
+                if (config.statistics)
+                    config.statistics->addOutputFile(config.binaryLayoutFilename);
+                fputs("Glyph layout and metadata written into binary layout file.\n", stderr);
+            } else {
+                result = 1;
+                fputs("Failed to write binary layout file.\n", stderr);
+            }
         }
     }
 
     if (config.shadronPreviewFilename && config.shadronPreviewText) {
-        if (anyCodepointsAvailable) {
+        if (config.statistics)
+            config.statistics->beginStage("shadronPreview");
+        if (config.pageCount > 1 || config.packedChannelCount > 1) {
+            result = 1;
+            fputs("Shadron preview not supported for multi-page or channel-packed atlas.\n", stderr);
+        } else if (anyCodepointsAvailable) {
             std::vector<unicode_t> previewText;
             utf8Decode(previewText, config.shadronPreviewText);
             previewText.push_back(0);
-            if (generateShadronPreview(fonts.data(), fonts.size(), config.imageType, config.width, config.height, config.pxRange, previewText.data(), config.imageFilename, floatingPointFormat, config.shadronPreviewFilename))
+            if (generateShadronPreview(fonts.data(), fonts.size(), config.imageType, config.width, config.height, config.pxRange, previewText.data(), config.imageFilename, floatingPointFormat, config.shadronPreviewFilename)) {
+                if (config.statistics)
+                    config.statistics->addOutputFile(config.shadronPreviewFilename);
                 fputs("Shadron preview script generated.\n", stderr);
-            else {
+            } else {
                 result = 1;
                 fputs("Failed to generate Shadron preview file.\n", stderr);
             }
@@ -1437,6 +2144,17 @@ int main(int argc, const char *const *argv) {
         }
     }
 
+    if (config.statistics) {
+        config.statistics->endStage();
+        config.statistics->setThreadCount(config.threadCount);
+        if (config.statistics->exportJSON(config.statisticsFilename))
+            fputs("Statistics written into JSON file.\n", stderr);
+        else {
+            result = 1;
+            fputs("Failed to write statistics file.\n", stderr);
+        }
+    }
+
     return result;
 }
 
@@ -13,28 +13,41 @@
 
 #include "types.h"
 #include "utf8.h"
+#include "text-decoding.h"
 #include "Rectangle.h"
 #include "Padding.h"
 #include "Charset.h"
+#include "codepoint-frequencies.h"
 #include "GlyphBox.h"
+#include "GlyphProfile.h"
 #include "GlyphGeometry.h"
+#include "MappedFile.h"
 #include "FontGeometry.h"
+#include "font-kerning.h"
 #include "RectanglePacker.h"
+#include "ShelfPacker.h"
 #include "rectangle-packing.h"
 #include "Workload.h"
 #include "size-selectors.h"
+#include "pixel-conversion.h"
 #include "bitmap-blit.h"
 #include "AtlasStorage.h"
 #include "BitmapAtlasStorage.h"
 #include "TightAtlasPacker.h"
 #include "GridAtlasPacker.h"
+#include "ShelfAtlasPacker.h"
 #include "AtlasGenerator.h"
 #include "ImmediateAtlasGenerator.h"
 #include "DynamicAtlas.h"
 #include "glyph-generators.h"
+#include "number-format.h"
+#include "BufferedFileWriter.h"
+#include "block-compression.h"
 #include "image-encode.h"
 #include "image-save.h"
 #include "artery-font-export.h"
 #include "csv-export.h"
 #include "json-export.h"
+#include "binary-export.h"
 #include "shadron-preview-generator.h"
+#include "Statistics.h"
@@ -0,0 +1,363 @@
+
+#include "number-format.h"
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+
+#define DOUBLE_MANTISSA_BITS 52
+#define DOUBLE_EXPONENT_BITS 11
+#define DOUBLE_EXPONENT_BIAS 1023
+#define DOUBLE_POW5_INV_BITCOUNT 125
+#define DOUBLE_POW5_BITCOUNT 125
+#define DOUBLE_POW5_INV_TABLE_SIZE 342
+#define DOUBLE_POW5_TABLE_SIZE 326
+
+namespace msdf_atlas {
+
+char *formatHexByte(char *output, byte value) {
+    static const char HEX_DIGITS[] = "0123456789ABCDEF";
+    *output++ = HEX_DIGITS[value>>4];
+    *output++ = HEX_DIGITS[value&0x0f];
+    return output;
+}
+
+char *formatFloatG(char *output, float value) {
+    // Powers of ten are exact in double precision, and so is the product with a float (24 + 21 significant bits for 10^9)
+    static const double POWERS_OF_TEN[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+    double absValue = std::fabs((double) value);
+    if (absValue == 0) {
+        if (std::signbit(value))
+            *output++ = '-';
+        *output++ = '0';
+        return output;
+    }
+    // %g uses fixed notation with 6 significant digits for decimal exponents -4 to 5, other values are left to printf
+    if (absValue >= 1e-4 && absValue < 1e6) {
+        int shift = 0;
+        while (absValue*POWERS_OF_TEN[shift] < 1e5)
+            ++shift;
+        // Rounded in the current rounding mode (half to even by default) like printf
+        unsigned digits = (unsigned) std::nearbyint(absValue*POWERS_OF_TEN[shift]);
+        if (digits == 1000000u)
+            digits = 100000u, --shift;
+        if (shift >= 0) {
+            char digitChars[6];
+            for (int i = 5; i >= 0; --i, digits /= 10)
+                digitChars[i] = char('0'+digits%10);
+            int significant = 6;
+            while (significant > 6-shift && digitChars[significant-1] == '0')
+                --significant;
+            if (value < 0)
+                *output++ = '-';
+            if (shift >= 6) {
+                *output++ = '0';
+                *output++ = '.';
+                for (int i = 6; i < shift; ++i)
+                    *output++ = '0';
+            }
+            for (int i = 0; i < significant; ++i) {
+                if (shift < 6 && i == 6-shift)
+                    *output++ = '.';
+                *output++ = digitChars[i];
+            }
+            return output;
+        }
+    }
+    char buffer[MSDF_ATLAS_FLOAT_G_MAX_LENGTH+1];
+    int length = snprintf(buffer, sizeof(buffer), "%g", value);
+    for (int i = 0; i < length; ++i)
+        *output++ = buffer[i];
+    return output;
+}
+
+char *formatUnsigned(char *output, unsigned value) {
+    char digits[10];
+    int length = 0;
+    do {
+        digits[length++] = char('0'+value%10);
+        value /= 10;
+    } while (value);
+    while (length)
+        *output++ = digits[--length];
+    return output;
+}
+
+char *formatInt(char *output, int value) {
+    if (value < 0) {
+        *output++ = '-';
+        return formatUnsigned(output, 0u-(unsigned) value);
+    }
+    return formatUnsigned(output, (unsigned) value);
+}
+
+// Shortest round-trip conversion of doubles follows the Ryu algorithm (Ulf Adams, 2018)
+
+namespace {
+
+/// 128-bit approximations of 5^i and 2^k/5^i (low word first), computed on first use instead of being stored as literal tables
+struct Pow5Tables {
+    uint64_t split[DOUBLE_POW5_TABLE_SIZE][2];
+    uint64_t invSplit[DOUBLE_POW5_INV_TABLE_SIZE][2];
+    Pow5Tables();
+};
+
+}
+
+/// Returns the number of bits of 5^e (1 for e = 0)
+static int pow5bits(int e) {
+    return int(((uint32_t) e*1217359u)>>19)+1;
+}
+
+static int log10Pow2(int e) {
+    return int(((uint32_t) e*78913u)>>18);
+}
+
+static int log10Pow5(int e) {
+    return int(((uint32_t) e*732923u)>>20);
+}
+
+/// Extracts the 128 bits of a little-endian big integer (32-bit words) starting at bit position shift, shift may be negative
+static void extractBits128(uint64_t *dst, const std::vector<uint32_t> &number, int shift) {
+    dst[0] = 0, dst[1] = 0;
+    for (int i = 0; i < 128; ++i) {
+        int bit = shift+i;
+        if (bit >= 0 && bit < 32*(int) number.size() && number[bit>>5]>>(bit&31)&1)
+            dst[i>>6] |= uint64_t(1)<<(i&63);
+    }
+}
+
+Pow5Tables::Pow5Tables() {
+    // split[i] = 5^i scaled to exactly DOUBLE_POW5_BITCOUNT bits
+    std::vector<uint32_t> power(1, 1);
+    for (int i = 0; i < DOUBLE_POW5_TABLE_SIZE; ++i) {
+        extractBits128(split[i], power, pow5bits(i)-DOUBLE_POW5_BITCOUNT);
+        uint64_t carry = 0;
+        for (uint32_t &word : power) {
+            carry += uint64_t(word)*5;
+            word = uint32_t(carry);
+            carry >>= 32;
+        }
+        if (carry)
+            power.push_back(uint32_t(carry));
+    }
+    // invSplit[i] = floor(2^(pow5bits(i)-1+DOUBLE_POW5_INV_BITCOUNT) / 5^i) + 1, derived from floor(2^K / 5^i) by successive division by 5
+    const int K = 32*32;
+    std::vector<uint32_t> quotient(K/32+1, 0);
+    quotient.back() = 1;
+    for (int i = 0; i < DOUBLE_POW5_INV_TABLE_SIZE; ++i) {
+        extractBits128(invSplit[i], quotient, K-(pow5bits(i)-1+DOUBLE_POW5_INV_BITCOUNT));
+        if (!++invSplit[i][0])
+            ++invSplit[i][1];
+        uint64_t remainder = 0;
+        for (int j = (int) quotient.size()-1; j >= 0; --j) {
+            uint64_t cur = remainder<<32|quotient[j];
+            quotient[j] = uint32_t(cur/5);
+            remainder = cur%5;
+        }
+    }
+}
+
+/// Computes (m * mul) >> j, where mul is a 128-bit number and 64 < j < 128
+static uint64_t mulShift64(uint64_t m, const uint64_t *mul, int j) {
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 b0 = (unsigned __int128) m*mul[0];
+    unsigned __int128 b2 = (unsigned __int128) m*mul[1];
+    return uint64_t(((b0>>64)+b2)>>(j-64));
+#else
+    struct Product {
+        uint64_t lo, hi;
+        Product(uint64_t a, uint64_t b) {
+            uint64_t aLo = uint32_t(a), aHi = a>>32, bLo = uint32_t(b), bHi = b>>32;
+            uint64_t ll = aLo*bLo, lh = aLo*bHi, hl = aHi*bLo, hh = aHi*bHi;
+            uint64_t mid = (ll>>32)+uint32_t(lh)+uint32_t(hl);
+            lo = (mid<<32)|uint32_t(ll);
+            hi = hh+(lh>>32)+(hl>>32)+(mid>>32);
+        }
+    };
+    Product b0(m, mul[0]), b2(m, mul[1]);
+    uint64_t lo = b0.hi+b2.lo;
+    uint64_t hi = b2.hi+(lo < b0.hi);
+    int shift = j-64;
+    return shift ? lo>>shift|hi<<(64-shift) : lo;
+#endif
+}
+
+static int pow5Factor(uint64_t value) {
+    int count = 0;
+    while (value%5 == 0)
+        value /= 5, ++count;
+    return count;
+}
+
+static bool multipleOfPowerOf5(uint64_t value, int p) {
+    return pow5Factor(value) >= p;
+}
+
+static bool multipleOfPowerOf2(uint64_t value, int p) {
+    return !(value&((uint64_t(1)<<p)-1));
+}
+
+/// Finds the shortest decimal significand and exponent of a positive finite double
+static void shortestDecimal(uint64_t &output, int &exponent, uint64_t ieeeMantissa, int ieeeExponent) {
+    static const Pow5Tables tables;
+    int e2;
+    uint64_t m2;
+    if (ieeeExponent == 0) {
+        e2 = 1-DOUBLE_EXPONENT_BIAS-DOUBLE_MANTISSA_BITS-2;
+        m2 = ieeeMantissa;
+    } else {
+        e2 = ieeeExponent-DOUBLE_EXPONENT_BIAS-DOUBLE_MANTISSA_BITS-2;
+        m2 = uint64_t(1)<<DOUBLE_MANTISSA_BITS|ieeeMantissa;
+    }
+    bool acceptBounds = !(m2&1);
+    // Halfway points to the neighboring values are mv+2 and mv-1-mmShift (scaled by 4)
+    uint64_t mv = 4*m2;
+    uint64_t mmShift = ieeeMantissa != 0 || ieeeExponent <= 1;
+    uint64_t vr, vp, vm;
+    int e10;
+    bool vmIsTrailingZeros = false, vrIsTrailingZeros = false;
+    if (e2 >= 0) {
+        int q = log10Pow2(e2)-(e2 > 3);
+        e10 = q;
+        int k = DOUBLE_POW5_INV_BITCOUNT+pow5bits(q)-1;
+        int i = -e2+q+k;
+        vr = mulShift64(4*m2, tables.invSplit[q], i);
+        vp = mulShift64(4*m2+2, tables.invSplit[q], i);
+        vm = mulShift64(4*m2-1-mmShift, tables.invSplit[q], i);
+        if (q <= 21) {
+            if (mv%5 == 0)
+                vrIsTrailingZeros = multipleOfPowerOf5(mv, q);
+            else if (acceptBounds)
+                vmIsTrailingZeros = multipleOfPowerOf5(mv-1-mmShift, q);
+            else
+                vp -= multipleOfPowerOf5(mv+2, q);
+        }
+    } else {
+        int q = log10Pow5(-e2)-(-e2 > 1);
+        e10 = q+e2;
+        int i = -e2-q;
+        int k = pow5bits(i)-DOUBLE_POW5_BITCOUNT;
+        int j = q-k;
+        vr = mulShift64(4*m2, tables.split[i], j);
+        vp = mulShift64(4*m2+2, tables.split[i], j);
+        vm = mulShift64(4*m2-1-mmShift, tables.split[i], j);
+        if (q <= 1) {
+            vrIsTrailingZeros = true;
+            if (acceptBounds)
+                vmIsTrailingZeros = mmShift == 1;
+            else
+                --vp;
+        } else if (q < 63)
+            vrIsTrailingZeros = multipleOfPowerOf2(mv, q);
+    }
+    // Remove digits while the interval (vm, vp) still contains a shorter representation
+    int removed = 0;
+    int lastRemovedDigit = 0;
+    if (vmIsTrailingZeros || vrIsTrailingZeros) {
+        while (vp/10 > vm/10) {
+            vmIsTrailingZeros &= vm%10 == 0;
+            vrIsTrailingZeros &= lastRemovedDigit == 0;
+            lastRemovedDigit = int(vr%10);
+            vr /= 10, vp /= 10, vm /= 10;
+            ++removed;
+        }
+        if (vmIsTrailingZeros) {
+            while (vm%10 == 0) {
+                vrIsTrailingZeros &= lastRemovedDigit == 0;
+                lastRemovedDigit = int(vr%10);
+                vr /= 10, vp /= 10, vm /= 10;
+                ++removed;
+            }
+        }
+        // Exact halfway cases round to even
+        if (vrIsTrailingZeros && lastRemovedDigit == 5 && vr%2 == 0)
+            lastRemovedDigit = 4;
+        output = vr+((vr == vm && (!acceptBounds || !vmIsTrailingZeros)) || lastRemovedDigit >= 5);
+    } else {
+        bool roundUp = false;
+        while (vp/10 > vm/10) {
+            roundUp = vr%10 >= 5;
+            vr /= 10, vp /= 10, vm /= 10;
+            ++removed;
+        }
+        output = vr+(vr == vm || roundUp);
+    }
+    exponent = e10+removed;
+}
+
+char *formatDouble(char *output, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bool sign = (bits>>(DOUBLE_MANTISSA_BITS+DOUBLE_EXPONENT_BITS)) != 0;
+    uint64_t ieeeMantissa = bits&((uint64_t(1)<<DOUBLE_MANTISSA_BITS)-1);
+    int ieeeExponent = int(bits>>DOUBLE_MANTISSA_BITS&((1u<<DOUBLE_EXPONENT_BITS)-1));
+    if (ieeeExponent == (1<<DOUBLE_EXPONENT_BITS)-1) {
+        // Infinity and NaN have no JSON representation and are written as printf would
+        char buffer[MSDF_ATLAS_DOUBLE_MAX_LENGTH];
+        int length = snprintf(buffer, sizeof(buffer), "%g", value);
+        for (int i = 0; i < length; ++i)
+            *output++ = buffer[i];
+        return output;
+    }
+    if (sign)
+        *output++ = '-';
+    if (!ieeeExponent && !ieeeMantissa) {
+        *output++ = '0';
+        return output;
+    }
+    uint64_t significand;
+    int exponent;
+    shortestDecimal(significand, exponent, ieeeMantissa, ieeeExponent);
+    char digits[20];
+    int length = 0;
+    for (; significand; significand /= 10)
+        digits[length++] = char('0'+significand%10);
+    // Position of the decimal point relative to the first digit
+    int point = length+exponent;
+    if (point > 0 && point <= 21) {
+        for (int i = 0; i < point; ++i)
+            *output++ = i < length ? digits[length-i-1] : '0';
+        if (point < length) {
+            *output++ = '.';
+            for (int i = point; i < length; ++i)
+                *output++ = digits[length-i-1];
+        }
+    } else if (point <= 0 && point > -6) {
+        *output++ = '0';
+        *output++ = '.';
+        for (int i = point; i < 0; ++i)
+            *output++ = '0';
+        for (int i = 0; i < length; ++i)
+            *output++ = digits[length-i-1];
+    } else {
+        *output++ = digits[length-1];
+        if (length > 1) {
+            *output++ = '.';
+            for (int i = 1; i < length; ++i)
+                *output++ = digits[length-i-1];
+        }
+        *output++ = 'e';
+        output = formatInt(output, point-1);
+    }
+    return output;
+}
+
+void appendInt(std::string &str, int value) {
+    char buffer[MSDF_ATLAS_INT_MAX_LENGTH];
+    str.append(buffer, formatInt(buffer, value));
+}
+
+void appendUnsigned(std::string &str, unsigned value) {
+    char buffer[MSDF_ATLAS_INT_MAX_LENGTH];
+    str.append(buffer, formatUnsigned(buffer, value));
+}
+
+void appendDouble(std::string &str, double value) {
+    char buffer[MSDF_ATLAS_DOUBLE_MAX_LENGTH];
+    str.append(buffer, formatDouble(buffer, value));
+}
+
+}
@@ -0,0 +1,34 @@
+
+#pragma once
+
+#include <string>
+#include "types.h"
+
+#define MSDF_ATLAS_HEX_BYTE_MAX_LENGTH 2
+#define MSDF_ATLAS_FLOAT_G_MAX_LENGTH 16
+#define MSDF_ATLAS_INT_MAX_LENGTH 11
+#define MSDF_ATLAS_DOUBLE_MAX_LENGTH 32
+
+namespace msdf_atlas {
+
+// Fast number to text conversions, each writes the representation to the output buffer without a null terminator and returns a pointer past its end
+
+/// Writes the byte as two uppercase hexadecimal digits (same as printf's %02X)
+char *formatHexByte(char *output, byte value);
+/// Writes the value identically to printf's %g (at most MSDF_ATLAS_FLOAT_G_MAX_LENGTH characters)
+char *formatFloatG(char *output, float value);
+/// Writes the integer in decimal notation
+char *formatInt(char *output, int value);
+/// Writes the unsigned integer in decimal notation
+char *formatUnsigned(char *output, unsigned value);
+/// Writes the shortest decimal representation that parses back to exactly the same value (JSON compatible for finite values)
+char *formatDouble(char *output, double value);
+
+/// Appends the integer in decimal notation to the string
+void appendInt(std::string &str, int value);
+/// Appends the unsigned integer in decimal notation to the string
+void appendUnsigned(std::string &str, unsigned value);
+/// Appends the shortest round-trip decimal representation of the value to the string
+void appendDouble(std::string &str, double value);
+
+}
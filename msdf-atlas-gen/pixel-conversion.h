@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include <cstring>
+#include "types.h"
+
+namespace msdf_atlas {
+
+/// Converts a floating-point pixel value in the [0, 1] range to a 16-bit unsigned normalized value
+inline unorm16 pixelFloatToUnorm16(float x) {
+    float v = 65536.f*x;
+    return unorm16(v >= 0.f && v <= 65535.f ? v : float(v > 0.f)*65535.f);
+}
+
+/// Converts a float to a half-precision float, rounding to nearest even
+inline half pixelFloatToHalf(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = bits>>16&0x8000u;
+    uint32_t absBits = bits&0x7fffffffu;
+    half result;
+    if (absBits >= 0x7f800000u) // infinity or NaN
+        result.bits = uint16_t(sign|0x7c00u|(absBits > 0x7f800000u ? 0x0200u : 0u));
+    else if (absBits >= 0x47800000u) // overflow
+        result.bits = uint16_t(sign|0x7c00u);
+    else if (absBits < 0x38800000u) { // subnormal
+        int exponent = int(absBits>>23);
+        if (exponent < 102)
+            result.bits = uint16_t(sign);
+        else {
+            uint32_t mantissa = (absBits&0x007fffffu)|0x00800000u;
+            int shift = 126-exponent;
+            uint32_t halfBits = mantissa>>shift;
+            uint32_t remainder = mantissa&((1u<<shift)-1);
+            if (remainder > 1u<<(shift-1) || (remainder == 1u<<(shift-1) && (halfBits&1)))
+                ++halfBits;
+            result.bits = uint16_t(sign|halfBits);
+        }
+    } else {
+        uint32_t halfBits = (absBits-0x38000000u)>>13;
+        uint32_t remainder = absBits&0x1fffu;
+        if (remainder > 0x1000u || (remainder == 0x1000u && (halfBits&1)))
+            ++halfBits;
+        result.bits = uint16_t(sign|halfBits);
+    }
+    return result;
+}
+
+}
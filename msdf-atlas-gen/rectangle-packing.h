@@ -7,12 +7,22 @@
 namespace msdf_atlas {
 
 /// Packs the rectangle array into an atlas with fixed dimensions, returns how many didn't fit (0 on success)
+/// If ordered, rectangles are packed in tiers by their order in the array, so that the first ones end up clustered around the origin
 template <typename RectangleType>
-int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing = 0);
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing = 0, bool ordered = false);
 
 /// Packs the rectangle array into an atlas of unknown size, returns the minimum required dimensions constrained by SizeSelector
 template <class SizeSelector, typename RectangleType>
-std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing = 0);
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing = 0, bool ordered = false);
+
+/// Packs the rectangle array into consecutive layers with fixed dimensions, outputs each rectangle's layer into layers, uses at most layerLimit layers if positive, returns how many didn't fit (0 on success)
+/// If ordered, the first rectangles in the array are packed into the lowest layers
+template <typename RectangleType>
+int packRectanglesLayered(RectangleType *rectangles, int *layers, int count, int width, int height, int spacing = 0, int layerLimit = 0, bool ordered = false);
+
+/// Packs the rectangle array into at most layerLimit layers of unknown size, returns the minimum required dimensions constrained by SizeSelector
+template <class SizeSelector, typename RectangleType>
+std::pair<int, int> packRectanglesLayered(RectangleType *rectangles, int *layers, int count, int layerLimit, int spacing = 0, bool ordered = false);
 
 }
 
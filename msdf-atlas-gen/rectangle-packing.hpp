@@ -2,6 +2,7 @@
 #include "rectangle-packing.h"
 
 #include <vector>
+#include <algorithm>
 #include "RectanglePacker.h"
 
 namespace msdf_atlas {
@@ -17,14 +18,28 @@ static void copyRectanglePlacement(OrientedRectangle &dst, const OrientedRectang
     dst.rotated = src.rotated;
 }
 
+#define ORDERED_PACKING_FIRST_TIER_SIZE 32
+
+/// Packs rectangles into packer, if ordered, in consecutive tiers of doubling size so that earlier rectangles get the first pick of free space
+template <typename RectangleType>
+static int packTiers(RectanglePacker &packer, RectangleType *rectangles, int count, bool ordered) {
+    if (!ordered)
+        return packer.pack(rectangles, count);
+    int remaining = 0;
+    for (int start = 0, tierSize = ORDERED_PACKING_FIRST_TIER_SIZE; start < count; start += tierSize, tierSize *= 2)
+        remaining += packer.pack(rectangles+start, std::min(tierSize, count-start));
+    return remaining;
+}
+
 template <typename RectangleType>
-int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing) {
+int packRectangles(RectangleType *rectangles, int count, int width, int height, int spacing, bool ordered) {
     if (spacing)
         for (int i = 0; i < count; ++i) {
             rectangles[i].w += spacing;
             rectangles[i].h += spacing;
         }
-    int result = RectanglePacker(width+spacing, height+spacing).pack(rectangles, count);
+    RectanglePacker packer(width+spacing, height+spacing);
+    int result = packTiers(packer, rectangles, count, ordered);
     if (spacing)
         for (int i = 0; i < count; ++i) {
             rectangles[i].w -= spacing;
@@ -34,7 +49,7 @@ int packRectangles(RectangleType *rectangles, int count, int width, int height,
 }
 
 template <class SizeSelector, typename RectangleType>
-std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing) {
+std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spacing, bool ordered) {
     std::vector<RectangleType> rectanglesCopy(count);
     int totalArea = 0;
     for (int i = 0; i < count; ++i) {
@@ -46,7 +61,8 @@ std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spa
     SizeSelector sizeSelector(totalArea);
     int width, height;
     while (sizeSelector(width, height)) {
-        if (!RectanglePacker(width+spacing, height+spacing).pack(rectanglesCopy.data(), count)) {
+        RectanglePacker packer(width+spacing, height+spacing);
+        if (!packTiers(packer, rectanglesCopy.data(), count, ordered)) {
             dimensions.first = width;
             dimensions.second = height;
             for (int i = 0; i < count; ++i)
@@ -58,4 +74,62 @@ std::pair<int, int> packRectangles(RectangleType *rectangles, int count, int spa
     return dimensions;
 }
 
+template <typename RectangleType>
+int packRectanglesLayered(RectangleType *rectangles, int *layers, int count, int width, int height, int spacing, int layerLimit, bool ordered) {
+    std::vector<int> remaining(count);
+    for (int i = 0; i < count; ++i) {
+        remaining[i] = i;
+        layers[i] = -1;
+    }
+    std::vector<RectangleType> layerRectangles;
+    for (int layer = 0; !remaining.empty() && (layerLimit <= 0 || layer < layerLimit); ++layer) {
+        layerRectangles.resize(remaining.size());
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            layerRectangles[i] = rectangles[remaining[i]];
+            layerRectangles[i].x = -1;
+            layerRectangles[i].w += spacing;
+            layerRectangles[i].h += spacing;
+        }
+        // Rectangles that don't fit are left unplaced and carried over to the next layer
+        RectanglePacker packer(width+spacing, height+spacing);
+        if (packTiers(packer, layerRectangles.data(), int(layerRectangles.size()), ordered) == int(remaining.size()))
+            break;
+        size_t remainingCount = 0;
+        for (size_t i = 0; i < remaining.size(); ++i) {
+            if (layerRectangles[i].x >= 0) {
+                copyRectanglePlacement(rectangles[remaining[i]], layerRectangles[i]);
+                layers[remaining[i]] = layer;
+            } else
+                remaining[remainingCount++] = remaining[i];
+        }
+        remaining.resize(remainingCount);
+    }
+    return (int) remaining.size();
+}
+
+template <class SizeSelector, typename RectangleType>
+std::pair<int, int> packRectanglesLayered(RectangleType *rectangles, int *layers, int count, int layerLimit, int spacing, bool ordered) {
+    std::vector<RectangleType> rectanglesCopy(rectangles, rectangles+count);
+    std::vector<int> layersCopy(count);
+    int totalArea = 0;
+    for (int i = 0; i < count; ++i)
+        totalArea += rectangles[i].w*rectangles[i].h;
+    std::pair<int, int> dimensions;
+    SizeSelector sizeSelector(totalArea/std::max(layerLimit, 1));
+    int width, height;
+    while (sizeSelector(width, height)) {
+        if (!packRectanglesLayered(rectanglesCopy.data(), layersCopy.data(), count, width, height, spacing, layerLimit, ordered)) {
+            dimensions.first = width;
+            dimensions.second = height;
+            for (int i = 0; i < count; ++i) {
+                copyRectanglePlacement(rectangles[i], rectanglesCopy[i]);
+                layers[i] = layersCopy[i];
+            }
+            --sizeSelector;
+        } else
+            ++sizeSelector;
+    }
+    return dimensions;
+}
+
 }
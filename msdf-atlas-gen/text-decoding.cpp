@@ -0,0 +1,50 @@
+
+#include "text-decoding.h"
+
+#include <cstdio>
+#include <algorithm>
+#include "utf8.h"
+#include "Workload.h"
+
+#define TEXT_CHUNK_SIZE 0x100000
+
+namespace msdf_atlas {
+
+static void skipByteOrderMark(const char *&utf8, size_t &length) {
+    if (length >= 3 && utf8[0] == '\xef' && utf8[1] == '\xbb' && utf8[2] == '\xbf')
+        utf8 += 3, length -= 3;
+}
+
+static int textChunkCount(size_t length) {
+    return (int) ((length+TEXT_CHUNK_SIZE-1)/TEXT_CHUNK_SIZE);
+}
+
+int textChunkThreadCount(size_t length, int threadCount) {
+    return std::max(std::min(threadCount, textChunkCount(length)), 1);
+}
+
+void decodeTextChunks(const char *utf8, size_t length, int threadCount, const std::function<void(const char *, size_t, int)> &decodeChunk) {
+    skipByteOrderMark(utf8, length);
+    int chunks = textChunkCount(length);
+    Workload([utf8, length, &decodeChunk](int chunk, int threadNo) -> bool {
+        size_t start = utf8SequenceStart(utf8, length, (size_t) chunk*TEXT_CHUNK_SIZE);
+        size_t end = utf8SequenceStart(utf8, length, std::min((size_t) (chunk+1)*TEXT_CHUNK_SIZE, length));
+        if (start < end)
+            decodeChunk(utf8+start, end-start, threadNo);
+        return true;
+    }, chunks).finish(std::max(std::min(threadCount, chunks), 1));
+}
+
+bool mapTextFile(MappedFile &file, const char *filename) {
+    if (file.open(filename))
+        return true;
+    // Empty files cannot be mapped
+    if (FILE *f = fopen(filename, "rb")) {
+        bool empty = fgetc(f) < 0;
+        fclose(f);
+        return empty;
+    }
+    return false;
+}
+
+}
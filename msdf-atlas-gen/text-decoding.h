@@ -0,0 +1,21 @@
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include "MappedFile.h"
+
+#define UNICODE_CODEPOINT_COUNT 0x110000
+
+namespace msdf_atlas {
+
+// Parallel decoding of large UTF-8 texts (e.g. text corpora), which are split into chunks at sequence boundaries
+
+/// Returns the maximum number of threads decodeTextChunks will use for a text of given length, at least one
+int textChunkThreadCount(size_t length, int threadCount);
+/// Calls decodeChunk(utf8, length, threadNo) for each chunk of the text on up to textChunkThreadCount threads, a leading byte order mark is skipped
+void decodeTextChunks(const char *utf8, size_t length, int threadCount, const std::function<void(const char *, size_t, int)> &decodeChunk);
+/// Maps a text file into memory, returns false on failure. An empty file cannot be mapped, but is read successfully (file remains closed with zero size).
+bool mapTextFile(MappedFile &file, const char *filename);
+
+}
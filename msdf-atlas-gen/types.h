@@ -7,6 +7,13 @@ namespace msdf_atlas {
 
 typedef unsigned char byte;
 typedef uint32_t unicode_t;
+/// 16-bit unsigned normalized pixel value (65535 represents 1)
+typedef uint16_t unorm16;
+
+/// 16-bit IEEE 754 half-precision floating-point pixel value, stored as its bit pattern
+struct half {
+    uint16_t bits;
+};
 
 /// Type of atlas image contents
 enum class ImageType {
@@ -36,7 +43,12 @@ enum class ImageFormat {
     TEXT_FLOAT,
     BINARY,
     BINARY_FLOAT,
-    BINARY_FLOAT_BE
+    BINARY_FLOAT_BE,
+    KTX2,
+    DDS,
+    PNG16,
+    BINARY_UNORM16,
+    BINARY_HALF
 };
 
 /// Glyph identification
@@ -45,6 +57,16 @@ enum class GlyphIdentifierType {
     UNICODE_CODEPOINT
 };
 
+/// Extent of glyph geometry retained when loading glyphs
+enum class GeometryLoadMode {
+    /// Full shape, required to generate the glyph's bitmap
+    SHAPE,
+    /// Bounds and convex corners of the shape, which suffice for layout with miters
+    CORNERS,
+    /// Bounds only, which suffice for layout without miters
+    BOUNDS
+};
+
 /// Direction of the Y-axis
 enum class YDirection {
     BOTTOM_UP,
@@ -54,7 +76,8 @@ enum class YDirection {
 /// The method of computing the layout of the atlas
 enum class PackingStyle {
     TIGHT,
-    GRID
+    GRID,
+    SHELF
 };
 
 /// Constraints for the atlas's dimensions - see size selectors for more info
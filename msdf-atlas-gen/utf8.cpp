@@ -1,6 +1,8 @@
 
 #include "utf8.h"
 
+#include <cstring>
+
 namespace msdf_atlas {
 
 void utf8Decode(std::vector<unicode_t> &codepoints, const char *utf8String) {
@@ -35,4 +37,58 @@ void utf8Decode(std::vector<unicode_t> &codepoints, const char *utf8String) {
     }
 }
 
+/// Decodes a UTF-8 buffer of given length and calls visit for each valid codepoint, malformed sequences are skipped
+template <class Visitor>
+static void utf8DecodeBuffer(const char *utf8, size_t length, Visitor visit) {
+    const unsigned char *cur = reinterpret_cast<const unsigned char *>(utf8), *end = cur+length;
+    while (cur < end) {
+        // Runs of ASCII characters are validated eight bytes at a time
+        while (end-cur >= 8) {
+            uint64_t word;
+            memcpy(&word, cur, sizeof(word));
+            if (word&0x8080808080808080ull)
+                break;
+            for (int i = 0; i < 8; ++i, ++cur)
+                visit(unicode_t(*cur));
+        }
+        if (cur >= end)
+            break;
+        unicode_t cp = *cur++;
+        int rBytes;
+        if (cp < 0x80)
+            rBytes = 0;
+        else if ((cp&0xe0) == 0xc0)
+            cp &= 0x1f, rBytes = 1;
+        else if ((cp&0xf0) == 0xe0)
+            cp &= 0x0f, rBytes = 2;
+        else if ((cp&0xf8) == 0xf0)
+            cp &= 0x07, rBytes = 3;
+        else
+            continue; // stray continuation byte or invalid leading byte
+        for (; rBytes && cur < end && (*cur&0xc0) == 0x80; --rBytes, ++cur)
+            cp = cp<<6|(*cur&0x3f);
+        if (!rBytes && cp < 0x110000)
+            visit(cp);
+    }
+}
+
+size_t utf8SequenceStart(const char *utf8, size_t length, size_t pos) {
+    for (int i = 0; i < 3 && pos < length && (utf8[pos]&0xc0) == 0x80; ++i)
+        ++pos;
+    return pos;
+}
+
+void utf8MarkCodepoints(uint64_t *codepointBits, const char *utf8, size_t length) {
+    utf8DecodeBuffer(utf8, length, [codepointBits](unicode_t cp) {
+        codepointBits[cp>>6] |= (uint64_t) 1<<(cp&0x3f);
+    });
+}
+
+void utf8CountCodepoints(uint32_t *codepointCounts, const char *utf8, size_t length) {
+    utf8DecodeBuffer(utf8, length, [codepointCounts](unicode_t cp) {
+        if (codepointCounts[cp] != UINT32_MAX)
+            ++codepointCounts[cp];
+    });
+}
+
 }
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 #include "types.h"
 
@@ -8,5 +10,11 @@ namespace msdf_atlas {
 
 /// Decodes the UTF-8 string into an array of Unicode codepoints
 void utf8Decode(std::vector<unicode_t> &codepoints, const char *utf8String);
+/// Decodes a UTF-8 buffer of given length and sets the bit of each encountered codepoint in a bit set of 0x110000 bits, malformed sequences are skipped
+void utf8MarkCodepoints(uint64_t *codepointBits, const char *utf8, size_t length);
+/// Decodes a UTF-8 buffer of given length and increments the (saturating) counter of each encountered codepoint in an array of 0x110000 counters
+void utf8CountCodepoints(uint32_t *codepointCounts, const char *utf8, size_t length);
+/// Returns the first position at or after pos (skipping at most 3 continuation bytes) where a UTF-8 sequence may start, useful for splitting a buffer into chunks
+size_t utf8SequenceStart(const char *utf8, size_t length, size_t pos);
 
 }